@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cmath>
+
+#include "BeamGeometry.h"
+
+using namespace std;
+
+void BeamArrays::Append(const BeamPlanes& planes, size_t vertices,
+    const float rgb[3]) {
+    geometry.insert(geometry.end(), planes.geometry.begin(),
+        planes.geometry.begin() + 3 * vertices);
+    tex.insert(tex.end(), planes.tex.begin(),
+        planes.tex.begin() + 2 * vertices);
+    for (size_t j = 0; j < vertices; ++j) {
+        color.insert(color.end(), rgb, rgb + 3);
+    }
+}
+
+void BeamArrays::Clear() {
+    geometry.clear();
+    tex.clear();
+    color.clear();
+}
+
+size_t GetBeamTupleSize(size_t ids) {
+    // WARNING: android NDK log2 implementation is wrong
+    // (probably for C++0x only)
+    return ceil(log(ids + 1) / log(2) / 3);
+}
+
+void GetBeamColor(size_t num, size_t tuple_size, float color[3]) {
+    unsigned first_tuple = (1 << tuple_size) - 1;
+    unsigned second_tuple = (1 << (tuple_size * 2)) - 1 - first_tuple;
+    unsigned third_tuple = (1 << (tuple_size * 3)) - 1 - first_tuple
+            - second_tuple;
+    unsigned color_r = (num + 1) & first_tuple;
+    unsigned color_g = ((num + 1) & second_tuple) >> tuple_size;
+    unsigned color_b = ((num + 1) & third_tuple) >> (2 * tuple_size);
+    color[0] = 1.f * color_r / first_tuple;
+    color[1] = 1.f * color_g / first_tuple;
+    color[2] = 1.f * color_b / first_tuple;
+}
+
+size_t GetBeamPlanes(const PositionSnapshot& snapshot, size_t num,
+    size_t max_planes) {
+    // The planes follow the altitude range of the snapshot, the beams
+    // of earlier snapshots keep theirs
+    double min_alt = snapshot.min_alt;
+    double max_alt = snapshot.max_alt;
+    double alt_diff = max_alt - min_alt;
+    if (alt_diff < 0.001) {
+        alt_diff = 0.001;
+    }
+    double alt = snapshot.position[num].altitude;
+
+    size_t planes = 1 + BEAM_MAX_PLANES * (alt - min_alt) / alt_diff;
+    return min(planes, max_planes);
+}
+
+void BuildBeams(const PositionSnapshot& snapshot, const BeamPlanes& planes,
+    size_t tuple_size, vector<Beam>& beams, BeamArrays& arrays) {
+    size_t number = snapshot.position.size();
+    size_t max_planes = planes.GetMaxPlanes();
+    beams.resize(number);
+    size_t vertices = 0;
+    for (size_t i = 0; i < number; ++i) {
+        size_t beam_planes = GetBeamPlanes(snapshot, i, max_planes);
+        beams[i] = Beam {vertices, beam_planes, beam_planes};
+        vertices += beam_planes * PTS_PER_BEAM;
+    }
+
+    arrays.Clear();
+    arrays.geometry.reserve(3 * vertices);
+    arrays.tex.reserve(2 * vertices);
+    arrays.color.reserve(3 * vertices);
+    for (size_t i = 0; i < number; ++i) {
+        float color[3];
+        GetBeamColor(i, tuple_size, color);
+        arrays.Append(planes, beams[i].planes * PTS_PER_BEAM, color);
+    }
+}
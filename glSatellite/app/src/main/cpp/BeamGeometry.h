@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "SatelliteMgr.h"
+
+// Vertices of one beam plane, drawn as a triangle strip
+const size_t PTS_PER_BEAM = 4;
+// Planes of the highest beam above the first one
+const float BEAM_MAX_PLANES = 300;
+
+// Vertex range of one satellite's beam in the beam buffers
+struct Beam {
+    size_t first;
+    // Planes the range has room for, and the ones drawn
+    size_t capacity, planes;
+};
+
+/*
+ * Planes of the highest beam, every beam uses the first ones. The beams
+ * only differ in the number of planes, so they are made once.
+ */
+struct BeamPlanes {
+    // 3 coordinates and 2 texture coordinates per vertex
+    std::vector<float> geometry, tex;
+
+    size_t GetMaxPlanes() const {
+        return tex.size() / (2 * PTS_PER_BEAM);
+    }
+};
+
+// Vertex data of beam ranges, in the layout of the beam buffers
+struct BeamArrays {
+    std::vector<float> geometry, tex, color;
+
+    size_t GetVertices() const {
+        return geometry.size() / 3;
+    }
+
+    // Appends the first vertices of the planes in one color
+    void Append(const BeamPlanes& planes, size_t vertices,
+        const float rgb[3]);
+    void Clear();
+};
+
+// Bits per color channel of the beam colors that tell apart ids satellites
+size_t GetBeamTupleSize(size_t ids);
+// Color of the beam in the FBO, which identifies the satellite
+void GetBeamColor(size_t num, size_t tuple_size, float color[3]);
+// Planes of the satellite's beam, following the altitude range of the
+// snapshot
+size_t GetBeamPlanes(const PositionSnapshot& snapshot, size_t num,
+    size_t max_planes);
+// Packs the beams of all satellites of the snapshot into new ranges and
+// their vertices, in colors of the given tuple size
+void BuildBeams(const PositionSnapshot& snapshot, const BeamPlanes& planes,
+    size_t tuple_size, std::vector<Beam>& beams, BeamArrays& arrays);
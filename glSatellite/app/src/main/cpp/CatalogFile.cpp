@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CatalogFile.h"
+
+using namespace std;
+
+static const char MAGIC[8] = {'G', 'L', 'S', 'A', 'T', 'C', 'A', 'T'};
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+static size_t Align(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+static uint64_t Checksum(const char *data, size_t size) {
+    // FNV-1a over 64-bit words with the high half folded back, so every
+    // bit reaches the whole hash. The sections are whole words.
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+size_t CatalogFile::Layout(const Header &header, size_t offset[MAX_SECTIONS]) {
+    offset[SAT_SECTION] = Align(sizeof(Header));
+    offset[ENTRY_SECTION] = Align(
+        offset[SAT_SECTION] + header.number * sizeof(Satellite));
+    offset[NEAR_EARTH_SECTION] = Align(
+        offset[ENTRY_SECTION] + header.number * sizeof(Entry));
+    offset[DEEP_SPACE_SECTION] = Align(
+        offset[NEAR_EARTH_SECTION]
+                + header.near_earth_number * sizeof(NearEarthPropagator));
+    return Align(
+        offset[DEEP_SPACE_SECTION]
+                + header.deep_space_number * sizeof(DeepSpaceTerms));
+}
+
+bool CatalogFile::Open(const char *path) {
+    Close();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header)) {
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid without the descriptor
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    map_ = map;
+    size_ = st.st_size;
+    if (!Map()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void CatalogFile::Close() {
+    if (map_) {
+        munmap(map_, size_);
+    }
+    map_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    sat_ = nullptr;
+    entry_ = nullptr;
+    near_earth_ = nullptr;
+    deep_space_ = nullptr;
+}
+
+bool CatalogFile::Map() {
+    const char *data = static_cast<const char*>(map_);
+    const Header *header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+            || header->version != VERSION
+            || header->byte_order != BYTE_ORDER_MARK
+            || header->sat_size != sizeof(Satellite)
+            || header->entry_size != sizeof(Entry)
+            || header->near_earth_size != sizeof(NearEarthPropagator)
+            || header->deep_space_size != sizeof(DeepSpaceTerms)) {
+        return false;
+    }
+
+    // The counts are checked before the layout so it cannot overflow
+    size_t offset[MAX_SECTIONS];
+    if (header->number > size_ / sizeof(Satellite)
+            || header->near_earth_number > header->number
+            || header->deep_space_number > header->number
+            || Layout(*header, offset) != size_
+            || Checksum(data + sizeof(Header), size_ - sizeof(Header))
+                    != header->checksum) {
+        return false;
+    }
+
+    const Entry *entry = reinterpret_cast<const Entry*>(
+        data + offset[ENTRY_SECTION]);
+    for (size_t i = 0; i < header->number; ++i) {
+        uint64_t number = entry[i].regime < DEEP_SPACE ?
+                header->near_earth_number : header->deep_space_number;
+        if (entry[i].regime >= MAX_REGIMES || entry[i].index >= number) {
+            return false;
+        }
+    }
+
+    header_ = header;
+    sat_ = reinterpret_cast<const Satellite*>(data + offset[SAT_SECTION]);
+    entry_ = entry;
+    near_earth_ = reinterpret_cast<const NearEarthPropagator*>(
+        data + offset[NEAR_EARTH_SECTION]);
+    deep_space_ = reinterpret_cast<const DeepSpaceTerms*>(
+        data + offset[DEEP_SPACE_SECTION]);
+    return true;
+}
+
+SatelliteCalc CatalogFile::GetCalc(size_t index) const {
+    const Entry &entry = entry_[index];
+    if (entry.regime < DEEP_SPACE) {
+        return SatelliteCalc(near_earth_[entry.index]);
+    }
+    return SatelliteCalc(deep_space_[entry.index]);
+}
+
+bool CatalogFile::Write(const char *path, const vector<Satellite>& sat,
+    const vector<SatelliteCalc>& calc) {
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.sat_size = sizeof(Satellite);
+    header.entry_size = sizeof(Entry);
+    header.near_earth_size = sizeof(NearEarthPropagator);
+    header.deep_space_size = sizeof(DeepSpaceTerms);
+    header.number = sat.size();
+    for (const SatelliteCalc &sat_calc : calc) {
+        if (sat_calc.IsDeepSpace()) {
+            ++header.deep_space_number;
+        } else {
+            ++header.near_earth_number;
+        }
+    }
+
+    // The file is put together in memory, the gaps stay zero
+    size_t offset[MAX_SECTIONS];
+    vector<char> data(Layout(header, offset));
+    memcpy(&data[offset[SAT_SECTION]], sat.data(),
+        sat.size() * sizeof(Satellite));
+    Entry *entry = reinterpret_cast<Entry*>(&data[offset[ENTRY_SECTION]]);
+    uint32_t near_earth = 0, deep_space = 0;
+    for (size_t i = 0; i < calc.size(); ++i) {
+        entry[i].regime = calc[i].GetRegime();
+        if (calc[i].IsDeepSpace()) {
+            entry[i].index = deep_space++;
+            const DeepSpaceTerms &terms = *calc[i].deep_space_;
+            memcpy(&data[offset[DEEP_SPACE_SECTION]
+                    + entry[i].index * sizeof(DeepSpaceTerms)], &terms,
+                sizeof(DeepSpaceTerms));
+        } else {
+            entry[i].index = near_earth++;
+            memcpy(&data[offset[NEAR_EARTH_SECTION]
+                    + entry[i].index * sizeof(NearEarthPropagator)],
+                calc[i].near_earth_.get(), sizeof(NearEarthPropagator));
+        }
+    }
+    header.checksum = Checksum(&data[sizeof(Header)],
+        data.size() - sizeof(Header));
+    memcpy(&data[0], &header, sizeof(Header));
+
+    string temp = string(path) + ".tmp";
+    FILE *file = fopen(temp.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temp.c_str(), path) != 0) {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Satellite.h"
+#include "SatelliteCalc.h"
+
+/*
+ * Binary catalog of parsed element sets and their initialized propagators,
+ * mapped into memory by Open() and used without any parsing or SGP4/SDP4
+ * initialization. After the header come the 8-byte aligned sections
+ *
+ *   Satellite[number]
+ *   Entry[number]                  regime and index in its section
+ *   NearEarthPropagator[near_earth_number]
+ *   DeepSpaceTerms[deep_space_number]
+ *
+ * The records are stored as they are in memory, so a file is only valid
+ * for the build that wrote it: the version, the byte order and the record
+ * sizes are checked, and a checksum covers everything after the header.
+ */
+class CatalogFile {
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        // Detects files of a different byte order
+        uint32_t byte_order;
+        uint32_t sat_size, near_earth_size, deep_space_size, entry_size;
+        uint64_t number, near_earth_number, deep_space_number;
+        // Of everything after the header
+        uint64_t checksum;
+    };
+
+    struct Entry {
+        uint32_t regime;
+        uint32_t index;
+    };
+
+    enum SECTIONS {
+        SAT_SECTION,
+        ENTRY_SECTION,
+        NEAR_EARTH_SECTION,
+        DEEP_SPACE_SECTION,
+        MAX_SECTIONS
+    };
+
+    void *map_ = nullptr;
+    size_t size_ = 0;
+    const Header *header_ = nullptr;
+    const Satellite *sat_ = nullptr;
+    const Entry *entry_ = nullptr;
+    const NearEarthPropagator *near_earth_ = nullptr;
+    const DeepSpaceTerms *deep_space_ = nullptr;
+
+    // Offsets of the sections in the file, returns the file size
+    static size_t Layout(const Header &header, size_t offset[MAX_SECTIONS]);
+    // Points the sections into the mapping, false if the file is invalid
+    bool Map();
+public:
+    // Incremented with every change of the layout or of the records
+    static const uint32_t VERSION = 1;
+
+    CatalogFile() {
+    }
+
+    ~CatalogFile() {
+        Close();
+    }
+
+    CatalogFile(const CatalogFile&) = delete;
+    CatalogFile& operator=(const CatalogFile&) = delete;
+
+    // Maps the file, false if it is missing or invalid
+    bool Open(const char *path);
+    void Close();
+
+    size_t GetNumber() const {
+        return header_ ? header_->number : 0;
+    }
+
+    const Satellite& GetSatellite(size_t index) const {
+        return sat_[index];
+    }
+
+    // Propagator of the satellite, copied from the mapping
+    SatelliteCalc GetCalc(size_t index) const;
+
+    // Writes the catalog through a temporary file, so an interrupted write
+    // never leaves a partial file at path. False on I/O errors.
+    static bool Write(const char *path, const std::vector<Satellite>& sat,
+        const std::vector<SatelliteCalc>& calc);
+};
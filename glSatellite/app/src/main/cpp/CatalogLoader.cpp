@@ -0,0 +1,111 @@
+#include "CatalogLoader.h"
+
+using namespace std;
+
+void CatalogLoader::Load(Open open, string save_path) {
+    Post(unique_ptr<Request>(new Request {move(open), move(save_path), false,
+        vector<Satellite>(), vector<SatelliteCalc>(), 0}));
+}
+
+void CatalogLoader::Refresh(Open open, vector<Satellite> base,
+    vector<SatelliteCalc> calc, size_t generation, string save_path) {
+    Post(unique_ptr<Request>(new Request {move(open), move(save_path), true,
+        move(base), move(calc), generation}));
+}
+
+void CatalogLoader::Post(unique_ptr<Request> request) {
+    lock_guard<mutex> lock(mutex_);
+    request_ = move(request);
+    if (!worker_.joinable()) {
+        stop_ = false;
+        worker_ = thread(&CatalogLoader::Run, this);
+    }
+    cv_.notify_one();
+}
+
+void CatalogLoader::Dispose(unique_ptr<SatelliteMgr> mgr) {
+    lock_guard<mutex> lock(mutex_);
+    if (!worker_.joinable()) {
+        // No worker after Stop(), the manager is destroyed here
+        return;
+    }
+    disposed_.push_back(move(mgr));
+    cv_.notify_one();
+}
+
+void CatalogLoader::Stop() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+        request_.reset();
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void CatalogLoader::Run() {
+    unique_lock<mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] {
+            return stop_ || request_ || !disposed_.empty();
+        });
+        vector<unique_ptr<SatelliteMgr>> disposed;
+        disposed.swap(disposed_);
+        unique_ptr<Request> request = move(request_);
+        bool stop = stop_;
+        lock.unlock();
+
+        disposed.clear();
+        if (stop) {
+            return;
+        }
+        unique_ptr<LoadedCatalog> catalog;
+        if (request) {
+            catalog = Load(*request);
+        }
+        lock.lock();
+        // Dropped if Stop() was called in the meantime
+        if (catalog && !stop_) {
+            lock.unlock();
+            ready_(move(catalog));
+            lock.lock();
+        }
+    }
+}
+
+unique_ptr<LoadedCatalog> CatalogLoader::Load(Request& request) const {
+    unique_ptr<IFileReader> reader = request.open();
+    if (!reader || !reader->is_open()) {
+        return nullptr;
+    }
+    // Initialized on this thread, the pool belongs to the propagation
+    // of the rendered catalog
+    unique_ptr<LoadedCatalog> catalog(new LoadedCatalog);
+    catalog->mgr.reset(new SatelliteMgr);
+    SatelliteMgr &mgr = *catalog->mgr;
+    mgr.SetClock(clock_);
+    if (request.refresh) {
+        mgr.Init(move(request.base), move(request.calc));
+        mgr.Refresh(*reader, catalog->changed);
+        catalog->refreshed = true;
+        catalog->generation = request.generation;
+    } else {
+        mgr.Init(*reader);
+    }
+    if (!request.save_path.empty()) {
+        catalog->saved = mgr.Save(request.save_path.c_str());
+    }
+
+    // The beams follow the altitude range of the first update
+    mgr.UpdateAll();
+    if (request.refresh) {
+        return catalog;
+    }
+    catalog->tuple_size = GetBeamTupleSize(mgr.GetNumber());
+    ProfileZone zone(profiler_, ZONE_LOADER_GEOMETRY);
+    BuildBeams(mgr.AcquireSnapshot(), planes_, catalog->tuple_size,
+        catalog->beams, catalog->arrays);
+    return catalog;
+}
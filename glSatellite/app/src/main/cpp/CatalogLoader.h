@@ -0,0 +1,123 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BeamGeometry.h"
+#include "IFileReader.h"
+#include "SatelliteMgr.h"
+
+// Catalog loaded by CatalogLoader, ready to replace the rendered one
+struct LoadedCatalog {
+    // Propagators initialized and positions of one update published,
+    // the producer thread is not started
+    std::unique_ptr<SatelliteMgr> mgr;
+    // Beams of all satellites packed, with their vertices
+    std::vector<Beam> beams;
+    BeamArrays arrays;
+    size_t tuple_size = 0;
+    // False if the catalog could not be written to the save path
+    bool saved = true;
+    // Made by CatalogLoader::Refresh(): the generation of the catalog it
+    // was refreshed from and the changed indices, see
+    // SatelliteMgr::Refresh(). The beams are not built.
+    bool refreshed = false;
+    size_t generation = 0;
+    std::vector<size_t> changed;
+};
+
+/*
+ * Loads catalogs on a worker thread, so the render thread only swaps them
+ * in and uploads the beams. Reading, parsing, validation, propagator
+ * initialization, the first update and the beam vertices all run on the
+ * worker, which hands the result to the ready function. A request that
+ * has not started yet is replaced by a newer one. A refresh keeps the
+ * indices of the satellites of the catalog it updates, so only the
+ * changed beams need to be built again.
+ *
+ * The worker also destroys the managers of replaced catalogs, which may
+ * own a lot of memory.
+ */
+class CatalogLoader {
+public:
+    // Opens the catalog, called on the worker thread
+    typedef std::function<std::unique_ptr<IFileReader>()> Open;
+    // Takes the loaded catalog, called on the worker thread
+    typedef std::function<void(std::unique_ptr<LoadedCatalog>)> Ready;
+
+private:
+    struct Request {
+        Open open;
+        std::string save_path;
+        // Refresh() of these element sets and their propagators
+        bool refresh;
+        std::vector<Satellite> base;
+        std::vector<SatelliteCalc> calc;
+        size_t generation;
+    };
+
+    Ready ready_;
+    BeamPlanes planes_;
+    SimulationClock *clock_ = nullptr;
+    FrameProfiler *profiler_ = nullptr;
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    // Next request, guarded by mutex_ like the managers to destroy
+    std::unique_ptr<Request> request_;
+    std::vector<std::unique_ptr<SatelliteMgr>> disposed_;
+
+    void Run();
+    std::unique_ptr<LoadedCatalog> Load(Request& request) const;
+    // Replaces the waiting request, starts the worker if needed
+    void Post(std::unique_ptr<Request> request);
+public:
+    explicit CatalogLoader(Ready ready) :
+            ready_(std::move(ready)) {
+    }
+
+    ~CatalogLoader() {
+        Stop();
+    }
+
+    // Planes of the beams, before the first Load()
+    void SetBeamPlanes(const BeamPlanes& planes) {
+        planes_ = planes;
+    }
+
+    // Time of the first update, nullptr uses the wall clock.
+    // Before the first Load().
+    void SetClock(SimulationClock *clock) {
+        clock_ = clock;
+    }
+
+    // Times the beams of every catalog in ZONE_LOADER_GEOMETRY, nullptr
+    // does not. Before the first Load().
+    void SetProfiler(FrameProfiler *profiler) {
+        profiler_ = profiler;
+    }
+
+    // Loads the catalog of the reader, plain, gzip compressed or OMM
+    // text, and writes it for SatelliteMgr::Load() to save_path unless
+    // it is empty. Nothing is handed over if the reader is not open.
+    void Load(Open open, std::string save_path = std::string());
+    // Same, but the catalog of the base element sets and their
+    // initialized propagators, see SatelliteMgr::CopyCatalog(), is updated
+    // to the one of the reader like SatelliteMgr::Refresh() does: only
+    // the changed and new element sets are initialized. The generation
+    // identifies the base for the ready function.
+    void Refresh(Open open, std::vector<Satellite> base,
+        std::vector<SatelliteCalc> calc, size_t generation,
+        std::string save_path = std::string());
+    // Destroys the manager on the worker thread, it must be stopped
+    void Dispose(std::unique_ptr<SatelliteMgr> mgr);
+    // Drops a waiting request and waits for the running one
+    void Stop();
+};
@@ -3,6 +3,7 @@
 #include "Engine.h"
 #include "DebugUtils.h"
 #include "FileReaderFactory.h"
+#include "JniUiBackend.h"
 
 using namespace ndk_helper;
 
@@ -12,11 +13,23 @@ Engine::Engine() {
 
 Engine::~Engine() = default;
 
+// Last loaded catalog in the internal data directory
+static const char CATALOG_CACHE[] = "/catalog.bin";
+
+std::string Engine::GetCatalogCachePath() const {
+    const char *dir = app_->activity->internalDataPath;
+    return dir ? std::string(dir) + CATALOG_CACHE : std::string();
+}
+
 void Engine::LoadResources() {
     renderer_.Init();
-    renderer_.Bind(&tap_camera_);
-    auto reader = FileReaderFactory::Get(APP, "iridium.txt");
-    renderer_.InitSatelliteMgr(*reader);
+    renderer_.Bind(&tap_camera_, &pool_);
+    // The cache skips parsing and propagator initialization
+    std::string cache = GetCatalogCachePath();
+    if (cache.empty() || !renderer_.LoadSatelliteMgr(cache.c_str())) {
+        renderer_.StreamSatelliteMgr(
+            FileReaderFactory::Get(APP, "iridium.txt"));
+    }
 }
 
 void Engine::UnloadResources() {
@@ -58,19 +71,29 @@ void Engine::InitDisplay() {
  * Just the current frame in the display.
  */
 void Engine::DrawFrame() {
+    FrameProfiler &profiler = renderer_.GetProfiler();
+    ProfileZone frame(&profiler, ZONE_FRAME);
     float fFPS;
     if (monitor_.Update(fFPS)) {
-        UpdateFPS(fFPS);
+        ui_->UpdateFPS(fFPS);
     }
-    renderer_.Update(ndk_helper::PerfMonitor::GetCurrentTime());
+    renderer_.Update();
 
     renderer_.Render();
 
     // Swap
-    if (EGL_SUCCESS != gl_context_->Swap()) {
+    EGLint swapped;
+    {
+        ProfileZone zone(&profiler, ZONE_SWAP);
+        swapped = gl_context_->Swap();
+    }
+    if (EGL_SUCCESS != swapped) {
         UnloadResources();
         LoadResources();
     }
+
+    // One hand-off of the UI changes per frame
+    ui_->Flush();
 }
 
 void Engine::UpdateZoom(const Vec2& v1, const Vec2& v2) {
@@ -158,15 +181,16 @@ int32_t Engine::HandleInput(android_app *app, AInputEvent *event) {
 }
 
 void Engine::InitWindow() {
-    ShowUI();
+    ui_->ShowUI();
 
     try {
         InitDisplay();
         DrawFrame();
     } catch (const RuntimeError &err) {
         no_error_ = false;
-        ShowError(err.what());
+        ui_->UpdateLabel(err.what());
     }
+    ui_->Flush();
 }
 
 /**
@@ -182,10 +206,12 @@ void Engine::HandleCmd(android_app *app, int32_t cmd) {
     } else if (cmd == APP_CMD_TERM_WINDOW) {
         // The window is being hidden or closed, clean it up.
         engine->TermDisplay();
+        engine->renderer_.StopUpdates();
         engine->has_focus_ = false;
     } else if (cmd == APP_CMD_GAINED_FOCUS) {
         engine->ResumeSensors();
         //Start animation
+        engine->renderer_.StartUpdates();
         engine->has_focus_ = true;
     } else if (cmd == APP_CMD_LOST_FOCUS) {
         engine->SuspendSensors();
@@ -194,6 +220,7 @@ void Engine::HandleCmd(android_app *app, int32_t cmd) {
         if (engine->no_error_) {
             engine->DrawFrame();
         }
+        engine->renderer_.StopUpdates();
     } else if (cmd == APP_CMD_LOW_MEMORY) {
         //Free up GL resources
         engine->TrimMemory();
@@ -213,20 +240,10 @@ ASensorManager* AcquireASensorManagerInstance(android_app* app) {
     PF_GETINSTANCEFORPACKAGE getInstanceForPackageFunc = (PF_GETINSTANCEFORPACKAGE)
             dlsym(androidHandle, "ASensorManager_getInstanceForPackage");
     if (getInstanceForPackageFunc) {
-        JNIEnv* env = nullptr;
-        app->activity->vm->AttachCurrentThread(&env, nullptr);
-
-        jclass android_content_Context = env->GetObjectClass(app->activity->clazz);
-        jmethodID midGetPackageName = env->GetMethodID(android_content_Context,
-                                                       "getPackageName",
-                                                       "()Ljava/lang/String;");
-        jstring packageName= (jstring)env->CallObjectMethod(app->activity->clazz,
-                                                            midGetPackageName);
-
-        const char *nativePackageName = env->GetStringUTFChars(packageName, 0);
-        ASensorManager* mgr = getInstanceForPackageFunc(nativePackageName);
-        env->ReleaseStringUTFChars(packageName, nativePackageName);
-        app->activity->vm->DetachCurrentThread();
+        // The package name JNIHelper::Init() read, without another
+        // attach to the VM
+        ASensorManager* mgr = getInstanceForPackageFunc(
+            JNIHelper::GetInstance()->GetAppName());
         if (mgr) {
             dlclose(androidHandle);
             return mgr;
@@ -289,6 +306,9 @@ void Engine::SuspendSensors() {
 //-------------------------------------------------------------------------
 void Engine::SetState(android_app *state) {
     app_ = state;
+    // Attached until TermUI(), the end of android_main()
+    ui_.reset(new UiBridge(std::unique_ptr<IUiBackend>(
+        new JniUiBackend(state->activity))));
     doubletap_detector_.SetConfiguration(app_->config);
     drag_detector_.SetConfiguration(app_->config);
     pinch_detector_.SetConfiguration(app_->config);
@@ -308,78 +328,52 @@ void Engine::TrimMemory() {
     gl_context_->Invalidate();
 }
 
-/*
-    JNI helpers
-*/
-void Engine::ShowUI() {
-    JNIEnv *jni;
-    app_->activity->vm->AttachCurrentThread(&jni, nullptr);
-
-    //Default class retrieval
-    auto clazz = jni->GetObjectClass(app_->activity->clazz);
-    auto methodID = jni->GetMethodID(clazz, "showUI", "()V");
-    jni->CallVoidMethod(app_->activity->clazz, methodID);
-
-    app_->activity->vm->DetachCurrentThread();
-}
-
-void Engine::ShowError(const char *error) {
-    JNIEnv *jni;
-    app_->activity->vm->AttachCurrentThread(&jni, nullptr);
-
-    //Default class retrieval
-    auto clazz = jni->GetObjectClass(app_->activity->clazz);
-    auto methodID = jni->GetMethodID(clazz, "updateLabel",
-        "(Ljava/lang/String;)V");
-    jstring label = jni->NewStringUTF(error);
-    jni->CallVoidMethod(app_->activity->clazz, methodID, label);
-
-    app_->activity->vm->DetachCurrentThread();
-}
-
-void Engine::UpdateFPS(float fFPS) {
-    JNIEnv *jni;
-    app_->activity->vm->AttachCurrentThread(&jni, nullptr);
-
-    //Default class retrieval
-    auto clazz = jni->GetObjectClass(app_->activity->clazz);
-    auto methodID = jni->GetMethodID(clazz, "updateFPS", "(F)V");
-    jni->CallVoidMethod(app_->activity->clazz, methodID, fFPS);
-
-    app_->activity->vm->DetachCurrentThread();
-}
-
-void Engine::UseTle(char *path) {
+void Engine::UseTle(const std::string& path) {
     if (g_developer_mode) {
-        LOGI("New TLE file: %s", path);
+        LOGI("New TLE file: %s", path.c_str());
     }
-    auto reader = FileReaderFactory::Get(APP, path);
-    renderer_.InitSatelliteMgr(*reader);
-    free(path);
+    // Read and refreshed on the loader thread, the frames go on with
+    // the old catalog until CATALOG_READY
+    std::string cache = GetCatalogCachePath();
+    renderer_.RefreshSatelliteMgr([path] {
+        return FileReaderFactory::Get(APP, path.c_str());
+    }, cache.empty() ? nullptr : cache.c_str());
 }
 
-void Engine::ShowBeam(size_t num) {
-    JNIEnv *jni;
-    app_->activity->vm->AttachCurrentThread(&jni, nullptr);
-
-    //Default class retrieval
-    auto clazz = jni->GetObjectClass(app_->activity->clazz);
-    auto methodID = jni->GetMethodID(clazz, "showBeam",
-        "(Ljava/lang/String;IFFF)V");
+void Engine::ShowBeam(size_t num, int catnum) {
+    // The catalog may have been replaced since the tap
+    if (!renderer_.FindSatellite(catnum, num)) {
+        return;
+    }
     Satellite &sat = renderer_.GetSatellite(num);
-    jstring j_name = jni->NewStringUTF(sat.GetName().c_str());
-    jni->CallVoidMethod(app_->activity->clazz, methodID, j_name,
-        sat.GetCatNum(), sat.GetLatitude(), sat.GetLongitude(),
-        sat.GetAltitude());
+    const SatellitePosition &position = renderer_.GetPosition(num);
+    ui_->ShowBeam(sat.GetName(), sat.GetCatNum(), position.latitude,
+        position.longitude, position.altitude);
+}
 
-    app_->activity->vm->DetachCurrentThread();
+void Engine::DumpProfile() {
+    // One line per zone, logcat truncates long messages
+    std::string table = renderer_.GetProfiler().Dump();
+    size_t begin = 0, end;
+    while ((end = table.find('\n', begin)) != std::string::npos) {
+        LOGI("%s", table.substr(begin, end - begin).c_str());
+        begin = end + 1;
+    }
 }
 
 void Engine::HandleMessage(Message msg) {
     auto cmd = msg.cmd;
     if (cmd == USE_TLE) {
-        UseTle(reinterpret_cast<char*>(msg.payload));
+        UseTle(msg.path);
     } else if (cmd == SHOW_BEAM) {
-        ShowBeam(reinterpret_cast<size_t>(msg.payload));
+        ShowBeam(msg.index, msg.catnum);
+    } else if (cmd == CATALOG_READY) {
+        renderer_.SwapSatelliteMgr(std::move(msg.catalog));
+    } else if (cmd == DUMP_PROFILE) {
+        DumpProfile();
+    }
+    // Otherwise the next frame hands it over
+    if (!IsReady()) {
+        ui_->Flush();
     }
 }
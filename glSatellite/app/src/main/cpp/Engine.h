@@ -1,12 +1,17 @@
 #pragma once
 
+#include <string>
+
 #include "GlobeRenderer.h"
 #include "MessageQueue.h"
+#include "UiBridge.h"
 #include "ndk_helper/gestureDetector.h"
 #include "ndk_helper/tapCamera.h"
 #include "ndk_helper/NDKHelper.h"
 
 class Engine {
+    // Destroyed after the renderer which uses it
+    ThreadPool pool_;
     GlobeRenderer renderer_;
 
     ndk_helper::GLContext *gl_context_;
@@ -23,6 +28,8 @@ class Engine {
     ndk_helper::TapDetector tap_detector_;
 
     ndk_helper::PerfMonitor monitor_;
+    // Render thread side of the UI, made by SetState()
+    std::unique_ptr<UiBridge> ui_;
     ndk_helper::TapCamera tap_camera_;
 
     android_app *app_ = nullptr;
@@ -31,11 +38,14 @@ class Engine {
     const ASensor *accelerometer_sensor_ = nullptr;
     ASensorEventQueue *sensor_event_queue_ = nullptr;
 
-    void UpdateFPS(float fFPS);
-    void ShowUI();
-    void ShowError(const char *error);
-    void UseTle(char *path);
-    void ShowBeam(size_t num);
+    void UseTle(const std::string& path);
+    // Empty if the app has no internal data directory
+    std::string GetCatalogCachePath() const;
+    // Index and catalog number of the picked satellite, nothing is shown
+    // if the catalog no longer has it
+    void ShowBeam(size_t num, int catnum);
+    // Logs the statistics of the profiler zones
+    void DumpProfile();
     void TransformPosition(ndk_helper::Vec2 &vec);
 
 public:
@@ -49,6 +59,10 @@ public:
     void TermDisplay() {
         gl_context_->Suspend();
     }
+    // Applies the last UI changes and detaches the bridge thread
+    void TermUI() {
+        ui_.reset();
+    }
     bool IsReady() {
         return has_focus_ && no_error_;
     }
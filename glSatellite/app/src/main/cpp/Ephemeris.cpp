@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <climits>
+
+#include "Ephemeris.h"
+#include "SatelliteConst.h"
+
+using namespace std;
+
+// Knot spacing limits in minutes
+const double MIN_STEP = 0.1;
+const double MAX_STEP = 10;
+// Margin for the perturbations and the radial motion
+// not covered by the circular orbit estimate of x''''
+const double STEP_SAFETY = 4;
+// Margin for the velocity difference away from epoch
+const double VELOCITY_SAFETY = 3;
+// Time step of the numerical derivative in minutes
+const double DERIVATIVE_STEP = 0.01;
+
+void EphemerisCache::Init(vector<SatelliteCalc>& calc) {
+    segment_.clear();
+    Extend(calc);
+}
+
+void EphemerisCache::Extend(vector<SatelliteCalc>& calc) {
+    size_t begin = segment_.size();
+    segment_.resize(calc.size());
+    for (size_t i = begin; i < calc.size(); ++i) {
+        segment_[i].index = LONG_MIN;
+        segment_[i].step = Step(calc[i]);
+    }
+}
+
+void EphemerisCache::Reset(size_t num, SatelliteCalc& calc) {
+    segment_[num].index = LONG_MIN;
+    segment_[num].step = Step(calc);
+}
+
+void EphemerisCache::Remove(size_t num) {
+    segment_[num] = segment_.back();
+    segment_.pop_back();
+}
+
+double EphemerisCache::Step(SatelliteCalc& calc) const {
+    // Semi major axis in earth radii from the mean motion in rad/min
+    double n = calc.GetElements().tle_xno;
+    double e = calc.GetElements().tle_eo;
+    double a = pow(XKE / n, TOTHRD);
+
+    // The fourth derivative of a circular motion with radius r and
+    // angular rate w is r * w^4, use the values at perigee
+    double rp = a * (1 - e);
+    double wp = n * sqrt(1 + e) / pow(1 - e, 1.5);
+    double x4 = STEP_SAFETY * rp * pow(wp, 4);
+
+    // The velocities of SGP4/SDP4 are not the exact derivatives of the
+    // positions (up to ~1 m/s), a difference dv at the knots adds up to
+    // step * dv / 4 to the interpolation error
+    vector_t pos, vel, before, after, unused;
+    calc.Propagate(0, pos, vel);
+    calc.Propagate(-DERIVATIVE_STEP, before, unused);
+    calc.Propagate(DERIVATIVE_STEP, after, unused);
+    vector_t diff = {
+        (after.x - before.x) / (2 * DERIVATIVE_STEP) - vel.x,
+        (after.y - before.y) / (2 * DERIVATIVE_STEP) - vel.y,
+        (after.z - before.z) / (2 * DERIVATIVE_STEP) - vel.z};
+    diff.Magnitude();
+    double dv = VELOCITY_SAFETY * diff.w;
+
+    // Half of the maximum error for each part
+    double max_error = max_error_ / XKMPER;
+    double step = pow(192 * max_error / x4, 0.25);
+    if (dv > 0) {
+        step = min(step, 2 * max_error / dv);
+    }
+    return min(max(step, MIN_STEP), MAX_STEP);
+}
+
+void EphemerisCache::Fit(Segment& segment) {
+    double h = segment.step;
+    const vector_t &p0 = segment.pos[0], &p1 = segment.pos[1];
+    const vector_t &v0 = segment.vel[0], &v1 = segment.vel[1];
+    const double p[2][3] = {{p0.x, p0.y, p0.z}, {p1.x, p1.y, p1.z}};
+    const double v[2][3] = {{v0.x, v0.y, v0.z}, {v1.x, v1.y, v1.z}};
+
+    for (int axis = 0; axis < 3; ++axis) {
+        double *c = segment.coef[axis];
+        double dp = p[1][axis] - p[0][axis];
+        c[0] = p[0][axis];
+        c[1] = h * v[0][axis];
+        c[2] = 3 * dp - h * (2 * v[0][axis] + v[1][axis]);
+        c[3] = -2 * dp + h * (v[0][axis] + v[1][axis]);
+    }
+}
+
+void EphemerisCache::Get(size_t num, SatelliteCalc& calc, double tsince,
+    vector_t &pos, vector_t &vel) {
+    Segment &segment = segment_[num];
+    double h = segment.step;
+    long index = floor(tsince / h);
+
+    if (index != segment.index) {
+        if (index == segment.index + 1) {
+            segment.pos[0] = segment.pos[1];
+            segment.vel[0] = segment.vel[1];
+            calc.Propagate((index + 1) * h, segment.pos[1], segment.vel[1]);
+        } else if (index == segment.index - 1) {
+            segment.pos[1] = segment.pos[0];
+            segment.vel[1] = segment.vel[0];
+            calc.Propagate(index * h, segment.pos[0], segment.vel[0]);
+        } else {
+            calc.Propagate(index * h, segment.pos[0], segment.vel[0]);
+            calc.Propagate((index + 1) * h, segment.pos[1], segment.vel[1]);
+        }
+        segment.index = index;
+        Fit(segment);
+    }
+
+    double s = tsince / h - index;
+    const double (*c)[4] = segment.coef;
+    pos.x = c[0][0] + s * (c[0][1] + s * (c[0][2] + s * c[0][3]));
+    pos.y = c[1][0] + s * (c[1][1] + s * (c[1][2] + s * c[1][3]));
+    pos.z = c[2][0] + s * (c[2][1] + s * (c[2][2] + s * c[2][3]));
+    vel.x = (c[0][1] + s * (2 * c[0][2] + s * 3 * c[0][3])) / h;
+    vel.y = (c[1][1] + s * (2 * c[1][2] + s * 3 * c[1][3])) / h;
+    vel.z = (c[2][1] + s * (2 * c[2][2] + s * 3 * c[2][3])) / h;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include "SatelliteCalc.h"
+
+/*
+ * Cache of the propagated orbits. Every satellite is propagated only at
+ * knots spaced evenly in time since its epoch, the state between two
+ * knots comes from the cubic Hermite polynomial through the positions and
+ * velocities at the knots. Segments are replaced lazily when the time
+ * leaves them, moving to a neighbouring segment reuses the shared knot.
+ *
+ * The knot spacing is chosen per satellite from the error bound of the
+ * cubic Hermite interpolation, h^4 / 384 * max|x''''|, with x'''' taken
+ * at perigee, and from the velocities of SGP4/SDP4, which are not the
+ * exact derivatives of the positions. At the default error of 10 m this
+ * gives about 1.5 minutes for LEO, from the bound above, and about 2
+ * minutes for GEO, from the velocities.
+ */
+class EphemerisCache {
+    struct Segment {
+        // Start of the segment in knot steps since epoch
+        long index;
+        // Knot spacing in minutes
+        double step;
+        // Propagated states at the knots
+        vector_t pos[2], vel[2];
+        // Polynomial of each axis in s = tsince / step - index:
+        // c[0] + s * (c[1] + s * (c[2] + s * c[3]))
+        double coef[3][4];
+    };
+
+    std::vector<Segment> segment_;
+    double max_error_;
+
+    double Step(SatelliteCalc& calc) const;
+    void Fit(Segment& segment);
+public:
+    // Default maximum position error in km
+    static constexpr double DEFAULT_MAX_ERROR = 0.01;
+
+    explicit EphemerisCache(double max_error = DEFAULT_MAX_ERROR) :
+            max_error_(max_error) {
+    }
+
+    // Maximum position error in km, takes effect with the next Init()
+    void SetMaxError(double max_error) {
+        max_error_ = max_error;
+    }
+
+    double GetMaxError() const {
+        return max_error_;
+    }
+
+    // Drops all segments and sets the knot spacing of each satellite
+    void Init(std::vector<SatelliteCalc>& calc);
+    // Sets the knot spacing of the satellites appended to calc since
+    // the last Init() or Extend(), the others keep their segments
+    void Extend(std::vector<SatelliteCalc>& calc);
+    // Drops the segments of satellite num after new elements
+    void Reset(size_t num, SatelliteCalc& calc);
+    // Moves the segments of the last satellite to num, like the
+    // removal of SatelliteMgr::Refresh()
+    void Remove(size_t num);
+
+    // Same as SatelliteCalc::Propagate() within the maximum error.
+    // Different satellites can be evaluated on different threads.
+    void Get(size_t num, SatelliteCalc& calc, double tsince, vector_t &pos,
+        vector_t &vel);
+
+    double GetStep(size_t num) const {
+        return segment_[num].step;
+    }
+};
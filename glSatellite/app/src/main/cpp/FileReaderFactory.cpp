@@ -1,7 +1,8 @@
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <android/asset_manager.h>
 
 #include "ndk_helper/NDKHelper.h"
 #include "DebugUtils.h"
@@ -10,55 +11,117 @@
 using namespace std;
 using namespace ndk_helper;
 
-class SysFileReader: public IFileReader {
-    ifstream fd_;
+// File on disk mapped read-only into memory
+class MappedFile {
+    void *map_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
 public:
-    explicit SysFileReader(const string& path) :
-                fd_(path) {
+    MappedFile() {
     }
 
-    bool is_open() override {
-        return fd_.is_open();
+    ~MappedFile() {
+        if (map_) {
+            munmap(map_, size_);
+        }
     }
 
-    bool eof() override {
-        return fd_.eof();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file cannot be read, an empty file has an empty view
+    bool Open(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            // mmap() of nothing fails, the view stays empty
+            void *map = st.st_size > 0 ? mmap(nullptr, st.st_size, PROT_READ,
+                MAP_PRIVATE, fd, 0) : nullptr;
+            if (map != MAP_FAILED) {
+                map_ = map;
+                size_ = st.st_size;
+                open_ = true;
+            }
+        }
+        // The mapping stays valid without the descriptor
+        close(fd);
+        return open_;
     }
 
-    std::string getline() override {
-        std::string str;
-        std::getline(fd_, str);
-        return str;
+    bool is_open() const {
+        return open_;
+    }
+
+    StringView view() const {
+        return StringView(static_cast<const char*>(map_), size_);
     }
 };
 
+class SysFileReader: public IFileReader {
+    MappedFile file_;
+public:
+    explicit SysFileReader(const string& path) {
+        file_.Open(path);
+    }
+
+    bool is_open() override {
+        return file_.is_open();
+    }
+
+    StringView view() override {
+        return file_.view();
+    }
+};
+
+/*
+ * Same lookup as JNIHelper::ReadFile(): the file in the external files
+ * directory, otherwise the asset of the APK. The asset buffer comes from
+ * AAsset_getBuffer(), which maps uncompressed assets.
+ */
 class AppFileReader: public IFileReader {
-    stringstream stream_;
+    MappedFile file_;
+    AAsset *asset_ = nullptr;
+    StringView view_;
 public:
     explicit AppFileReader(const string& path) {
-        std::vector < uint8_t > data;
-        if (!JNIHelper::GetInstance()->ReadFile(path.c_str(), &data)) {
-            if (g_developer_mode) {
-                LOGI("Can not open a file: %s", path.c_str());
+        ANativeActivity *activity = JNIHelper::GetInstance()->GetActivity();
+        if (!activity) {
+            return;
+        }
+        if (activity->externalDataPath) {
+            string external = string(activity->externalDataPath)
+                    + (path[0] == '/' ? "" : "/") + path;
+            if (file_.Open(external)) {
+                view_ = file_.view();
+                return;
             }
-        } else {
-            std::string str(data.begin(), data.end());
-            stream_ = stringstream(str);
+        }
+        asset_ = AAssetManager_open(activity->assetManager, path.c_str(),
+            AASSET_MODE_BUFFER);
+        const void *data = asset_ ? AAsset_getBuffer(asset_) : nullptr;
+        if (data) {
+            view_ = StringView(static_cast<const char*>(data),
+                AAsset_getLength(asset_));
+        } else if (g_developer_mode) {
+            LOGI("Can not open a file: %s", path.c_str());
         }
     }
 
-    bool is_open() override {
-        return !eof();
+    ~AppFileReader() {
+        if (asset_) {
+            AAsset_close(asset_);
+        }
     }
 
-    bool eof() override {
-        return stream_.eof();
+    bool is_open() override {
+        return file_.is_open() || view_.data;
     }
 
-    std::string getline() override {
-        std::string str;
-        std::getline(stream_, str);
-        return str;
+    StringView view() override {
+        return view_;
     }
 };
 
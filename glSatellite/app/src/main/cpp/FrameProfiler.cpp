@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "FrameProfiler.h"
+
+using namespace std;
+
+static const char *ZONE_NAMES[MAX_PROFILER_ZONES] = {
+    "frame",
+    "propagation",
+    "beam geometry",
+    "loader geometry",
+    "picking FBO",
+    "background",
+    "globe",
+    "beams",
+    "glReadPixels",
+    "swap",
+};
+
+const size_t FrameProfiler::SAMPLES;
+
+// Nearest rank of the fraction p of the sorted samples
+static double Percentile(const vector<uint32_t>& sorted, double p) {
+    size_t rank = (size_t)ceil(p * sorted.size());
+    return sorted[max(rank, (size_t)1) - 1] * 1E-6;
+}
+
+FrameProfiler::FrameProfiler() {
+    for (Zone &zone : zone_) {
+        zone.count.store(0, memory_order_relaxed);
+        for (atomic<uint32_t> &sample : zone.sample) {
+            sample.store(0, memory_order_relaxed);
+        }
+    }
+}
+
+const char *FrameProfiler::GetName(PROFILER_ZONES zone) {
+    return ZONE_NAMES[zone];
+}
+
+void FrameProfiler::Record(PROFILER_ZONES zone,
+    chrono::nanoseconds duration) {
+    Zone &z = zone_[zone];
+    uint64_t ns = max<int64_t>(duration.count(), 0);
+    uint64_t slot = z.count.fetch_add(1, memory_order_relaxed);
+    z.sample[slot & (SAMPLES - 1)].store(
+        (uint32_t)min<uint64_t>(ns, UINT32_MAX), memory_order_relaxed);
+}
+
+ZoneStats FrameProfiler::GetStats(PROFILER_ZONES zone) const {
+    const Zone &z = zone_[zone];
+    ZoneStats stats;
+    stats.count = z.count.load(memory_order_relaxed);
+    stats.samples = (size_t)min<uint64_t>(stats.count, SAMPLES);
+    if (stats.samples == 0) {
+        return stats;
+    }
+    // The slots written last, a slot claimed but not stored yet still
+    // has its sample of the last round
+    vector<uint32_t> sorted(stats.samples);
+    for (size_t i = 0; i < stats.samples; ++i) {
+        sorted[i] = z.sample[i].load(memory_order_relaxed);
+    }
+    sort(sorted.begin(), sorted.end());
+    double sum = 0;
+    for (uint32_t ns : sorted) {
+        sum += ns;
+    }
+    stats.min = sorted.front() * 1E-6;
+    stats.avg = sum / stats.samples * 1E-6;
+    stats.p50 = Percentile(sorted, 0.5);
+    stats.p95 = Percentile(sorted, 0.95);
+    stats.p99 = Percentile(sorted, 0.99);
+    stats.max = sorted.back() * 1E-6;
+    return stats;
+}
+
+string FrameProfiler::Dump() const {
+    char line[128];
+    snprintf(line, sizeof(line), "%-16s %8s %8s %8s %8s %8s %8s %8s\n",
+        "zone (ms)", "count", "min", "avg", "p50", "p95", "p99", "max");
+    string table = line;
+    for (size_t k = 0; k < MAX_PROFILER_ZONES; ++k) {
+        PROFILER_ZONES zone = (PROFILER_ZONES)k;
+        ZoneStats stats = GetStats(zone);
+        if (stats.samples == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line),
+            "%-16s %8llu %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+            GetName(zone), (unsigned long long)stats.count, stats.min,
+            stats.avg, stats.p50, stats.p95, stats.p99, stats.max);
+        table += line;
+    }
+    return table;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Timed stages of a frame, and of the threads that feed it
+enum PROFILER_ZONES {
+    // Render thread, DrawFrame() as a whole
+    ZONE_FRAME,
+    // Producer thread, SatelliteMgr::UpdateAll()
+    ZONE_UPDATE_ALL,
+    // Render thread, beams made and uploaded
+    ZONE_BEAM_GEOMETRY,
+    // Loader thread, beams of a new catalog made
+    ZONE_LOADER_GEOMETRY,
+    // GL passes on the render thread
+    ZONE_PICKING,
+    ZONE_BACKGROUND,
+    ZONE_GLOBE,
+    ZONE_BEAMS,
+    ZONE_READ_PIXELS,
+    ZONE_SWAP,
+    MAX_PROFILER_ZONES
+};
+
+// Durations of the samples of a zone in ms, all 0 without samples
+struct ZoneStats {
+    // Samples recorded since the start, of which the last ones count
+    uint64_t count = 0;
+    size_t samples = 0;
+    double min = 0;
+    double avg = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+/*
+ * Durations of the zones above, measured with the monotonic clock. Every
+ * zone keeps its last SAMPLES durations in a ring that any number of
+ * threads write without locking: a writer claims a slot with a fetch_add
+ * on the count and stores the duration. The statistics are taken from a
+ * copy of the ring, which may miss the samples written meanwhile.
+ *
+ * The GL zones measure the time the render thread spends in the calls.
+ * The driver queues most of the work, so the time of the GPU shows up in
+ * the calls that wait for it: glReadPixels() and the swap.
+ */
+class FrameProfiler {
+public:
+    // Power of two, so the slot of a sample is a mask of its count
+    static const size_t SAMPLES = 1024;
+
+private:
+    struct Zone {
+        std::atomic<uint64_t> count;
+        // In ns, saturated at about 4 s
+        std::atomic<uint32_t> sample[SAMPLES];
+    };
+
+    Zone zone_[MAX_PROFILER_ZONES];
+
+public:
+    FrameProfiler();
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    static const char *GetName(PROFILER_ZONES zone);
+
+    // Any thread
+    void Record(PROFILER_ZONES zone, std::chrono::nanoseconds duration);
+    ZoneStats GetStats(PROFILER_ZONES zone) const;
+    // Table of the statistics of the zones with samples, one per line
+    std::string Dump() const;
+};
+
+/*
+ * Records the time from its construction to its destruction in a zone.
+ * Nothing is measured without a profiler.
+ */
+class ProfileZone {
+    FrameProfiler *profiler_;
+    PROFILER_ZONES zone_;
+    std::chrono::steady_clock::time_point start_;
+public:
+    ProfileZone(FrameProfiler *profiler, PROFILER_ZONES zone) :
+            profiler_(profiler),
+            zone_(zone) {
+        if (profiler_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ProfileZone() {
+        if (profiler_) {
+            profiler_->Record(zone_, std::chrono::steady_clock::now()
+                - start_);
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
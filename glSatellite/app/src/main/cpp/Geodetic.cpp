@@ -0,0 +1,61 @@
+#include "Geodetic.h"
+#include "SatelliteConst.h"
+#include "Simd.h"
+
+using simd::Atan;
+
+static inline double Sqrt(double x) {
+    return sqrt(x);
+}
+
+static inline double Atan(double x) {
+    return atan(x);
+}
+
+template<class T>
+static inline void Vermeille(T x, T y, T z, T &lat, T &alt) {
+    const double E2 = FF * (2 - FF);
+    const double E4 = E2 * E2;
+
+    T rxy2 = x * x + y * y;
+    T p = rxy2 * (1 / (XKMPER * XKMPER));
+    T q = z * z * ((1 - E2) / (XKMPER * XKMPER));
+    T r = (p + q - E4) * (1.0 / 6);
+    T s = E4 * p * q / (4.0 * r * r * r);
+
+    // t + 1 / t with t = cbrt(1 + s + sqrt(s * (2 + s))) is the root
+    // of w^3 - 3w = 2 + 2s next to 2, s is below 1E-2 outside the core
+    T w = 2.0 + s * (2.0 / 9);
+    for (int i = 0; i < 2; ++i) {
+        w = w - (w * w * w - 3.0 * w - 2.0 - 2.0 * s) / (3.0 * w * w - 3.0);
+    }
+
+    T u = r * (1.0 + w);
+    T v = Sqrt(u * u + E4 * q);
+    T e = E2 * (u + v - q) / (2.0 * v);
+    T k = Sqrt(u + v + e * e) - e;
+    T d = k * Sqrt(rxy2) / (k + E2);
+    T dz = Sqrt(d * d + z * z);
+
+    lat = 2.0 * Atan(z / (d + dz));
+    alt = (k + E2 - 1.0) / k * dz;
+}
+
+void GeodeticLatAlt(double x, double y, double z, double &lat, double &alt) {
+    Vermeille(x, y, z, lat, alt);
+}
+
+void GeodeticLatAlt(size_t n, const double *x, const double *y,
+    const double *z, double *lat, double *alt) {
+    size_t i = 0;
+    for (; i + vdouble::WIDTH <= n; i += vdouble::WIDTH) {
+        vdouble vlat, valt;
+        Vermeille(vdouble::Load(x + i), vdouble::Load(y + i),
+            vdouble::Load(z + i), vlat, valt);
+        vlat.Store(lat + i);
+        valt.Store(alt + i);
+    }
+    for (; i < n; ++i) {
+        Vermeille(x[i], y[i], z[i], lat[i], alt[i]);
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Geodetic latitude and altitude of positions in earth centered
+ * coordinates, on the ellipsoid used by SGP4/SDP4 (XKMPER, FF).
+ * Closed-form solution of H. Vermeille, "Computing geodetic coordinates
+ * from geocentric coordinates", Journal of Geodesy 78 (2004), without
+ * the data dependent iteration of the Astronomical Almanac method.
+ * The cube root of the solution is replaced by two Newton steps on the
+ * equivalent cubic, exact for points farther than a few hundred km from
+ * the center of the earth.
+ *
+ * Agrees with the iterative method within 0.01 mm from the surface
+ * to beyond GEO. Positions in km, latitude in radians [-Pi/2, Pi/2],
+ * altitude in km.
+ */
+void GeodeticLatAlt(double x, double y, double z, double &lat, double &alt);
+
+// Same for arrays of n positions, vectorized with Simd.h
+void GeodeticLatAlt(size_t n, const double *x, const double *y,
+    const double *z, double *lat, double *alt);
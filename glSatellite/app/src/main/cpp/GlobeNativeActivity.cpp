@@ -6,7 +6,6 @@ const char *HELPER_CLASS_NAME = "ca/raido/helper/NDKHelper";
 
 Engine g_engine;
 android_poll_source g_poll_src;
-int g_msgread;
 bool g_developer_mode = false;
 
 /* JNI helpers:
@@ -14,20 +13,24 @@ bool g_developer_mode = false;
    - additional NDK helpers
 */
 void HandleMessageWrapper([[maybe_unused]] android_app* app, [[maybe_unused]] android_poll_source* source) {
-    Message msg = ReadMessageQueue(g_msgread);
-    g_engine.HandleMessage(msg);
+    ReadMessageQueue([](Message msg) {
+        g_engine.HandleMessage(std::move(msg));
+    });
 }
 
 extern "C" JNIEXPORT void JNICALL
 Java_ca_raido_glSatelliteDemo_GlobeNativeActivity_useTle(
         JNIEnv *env, [[maybe_unused]] jobject thiz, jstring javaString) {
     const char *nativeString = env->GetStringUTFChars(javaString, nullptr);
-    size_t len = strlen(nativeString);
-    char *path = reinterpret_cast<char*>(calloc(len + 1, 1));
-    strncpy(path, nativeString, len);
+    std::string path(nativeString);
     env->ReleaseStringUTFChars(javaString, nativeString);
-    Message msg = {USE_TLE, path};
-    PostMessage(msg);
+    PostMessage(Message::UseTle(std::move(path)));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_ca_raido_glSatelliteDemo_GlobeNativeActivity_dumpProfile(
+        [[maybe_unused]] JNIEnv *env, [[maybe_unused]] jobject thiz) {
+    PostMessage(Message::DumpProfile());
 }
 
 jclass RetrieveClass(JNIEnv *jni, ANativeActivity* activity,
@@ -78,7 +81,7 @@ void android_main(android_app *state) {
     InitMessageQueue(state->looper);
     g_poll_src.app = state;
     g_poll_src.process = HandleMessageWrapper;
-    g_msgread = AddMessageQueue(&g_poll_src);
+    AddMessageQueue(&g_poll_src);
 
 #ifdef USE_NDK_PROFILER
     monstartup("libGlobeNativeActivity.so");
@@ -109,6 +112,7 @@ void android_main(android_app *state) {
             // Check if we are exiting.
             if (state->destroyRequested != 0) {
                 g_engine.TermDisplay();
+                g_engine.TermUI();
                 return;
             }
         }
@@ -7,7 +7,6 @@ using namespace ndk_helper;
 using namespace std;
 
 const int PTS_PER_STAR = 4;
-const int PTS_PER_BEAM = 4;
 const float CAM_NEAR = 5.f;
 const float CAM_FAR = 10000.f;
 const float CAM_X = 0.f;
@@ -17,7 +16,6 @@ const float STAR_BLINK_FREQ = 0.02f;
 const float GLOBE_RADIUS = 35;
 const float MAX_STAR_D = 3.f;
 const float BEAM_WIDTH = 1.0f;
-const float BEAM_MAX_PLANES = 300;
 const float BEAM_PLANE_DIFF = 0.1f;
 const float INITIAL_LONGITUDE = 90;
 const float INITIAL_LATITUDE = 90;
@@ -28,17 +26,35 @@ const float CAM_STOP_MAX = 500;
 #define DEBUG_FBO false
 
 GlobeRenderer::GlobeRenderer() :
+            beam_vertices_(0),
+            beam_capacity_(0),
+            beam_tuple_size_(0),
+            streaming_(false),
+            generation_(0),
+            updates_enabled_(true),
+            mgr_(new SatelliteMgr),
+            pool_(nullptr),
+            loader_([](unique_ptr<LoadedCatalog> catalog) {
+                PostMessage(Message::CatalogReady(move(catalog)));
+            }),
             zoom_in_enabled_(true),
             zoom_out_enabled_(true),
             read_requested_(false) {
     for (size_t i = 0; i < MAX_BUFFERS; ++i) {
         buffer_[i] = 0;
     }
+    MakeBeamPlanes();
+    loader_.SetBeamPlanes(beam_planes_);
+    loader_.SetClock(&clock_);
+    loader_.SetProfiler(&profiler_);
 
     for (size_t i = 0; i < MAX_SHADERS; ++i) {
         SHADER_PARAMS *params = &shader_params_[i];
         params->program_ = 0;
     }
+
+    mgr_->SetClock(&clock_);
+    mgr_->SetProfiler(&profiler_);
 }
 
 Vec3 GlobeRenderer::Coord2Vec3(float latitude, float longitude) {
@@ -162,104 +178,167 @@ void GlobeRenderer::MakePoints(float radius, int number) {
         GL_STATIC_DRAW);
 }
 
-void GlobeRenderer::MakeBeams() {
-    num_beams_ = mgr_.GetNumber();
-    if (num_beams_ == 0) {
-        return;
-    }
-
-    // Calculate geometry first
-    size_t overall_planes = 0;
-    planes_per_beam_.reset(new size_t[num_beams_]);
-
-    // Update all positions
-    mgr_.UpdateAll();
-    double min_alt = mgr_.GetMinAltitude();
-    double max_alt = mgr_.GetMaxAltitude();
-    double alt_diff = max_alt - min_alt;
-    if (alt_diff < 0.001) {
-        alt_diff = 0.001;
-    }
-
-    for (size_t i = 0; i < num_beams_; ++i) {
-        Satellite &sat = mgr_.GetSatellite(i);
-        double alt = sat.GetAltitude();
-
-        int planes = 1 + BEAM_MAX_PLANES * (alt - min_alt) / alt_diff;
-        planes_per_beam_[i] = planes;
-        overall_planes += planes;
-    }
-
-    auto num_geometry = 3 * overall_planes * PTS_PER_BEAM;
-    auto num_colors = 3 * overall_planes * PTS_PER_BEAM;
-    auto num_uv = 2 * overall_planes * PTS_PER_BEAM;
-    unique_ptr<float[]> geometry_data(new float[num_geometry]);
-    unique_ptr<float[]> tex_data(new float[num_uv]);
-    auto index = 0, ti = 0;
+void GlobeRenderer::MakeBeamPlanes() {
     const size_t STEP_NUM = 4;
     int geo_manip_x[STEP_NUM] = {1, 1, -1, -1};
     int geo_manip_y[STEP_NUM] = {1, -1, 1, -1};
     int tex_manip_u[STEP_NUM] = {1, 1, 0, 0};
     int tex_manip_v[STEP_NUM] = {1, 0, 1, 0};
 
-    for (size_t i = 0; i < num_beams_; ++i) {
-        float latitude = INITIAL_LATITUDE;
-        float longitude = INITIAL_LONGITUDE;
+    float latitude = INITIAL_LATITUDE;
+    float longitude = INITIAL_LONGITUDE;
+    auto width = BEAM_WIDTH;
+    size_t max_planes = 1 + BEAM_MAX_PLANES;
+    beam_planes_.geometry.clear();
+    beam_planes_.tex.clear();
+    for (size_t j = 0; j < max_planes; ++j) {
+        for (size_t step = 0; step < STEP_NUM; ++step) {
+            float x, y, z;
+            Vec3 coord = Coord2Vec3(latitude + width * geo_manip_y[step],
+                longitude + width * geo_manip_x[step]);
+            coord *= (GLOBE_RADIUS + 0.5 + BEAM_PLANE_DIFF * j);
+            coord.Value(x, y, z);
+
+            beam_planes_.geometry.push_back(x);
+            beam_planes_.geometry.push_back(y);
+            beam_planes_.geometry.push_back(z);
 
-        auto width = BEAM_WIDTH;
-        float x, y, z;
+            beam_planes_.tex.push_back(tex_manip_u[step]);
+            beam_planes_.tex.push_back(tex_manip_v[step]);
+        }
+    }
+}
 
-        for (size_t j = 0; j < planes_per_beam_[i]; ++j) {
-            for (size_t step = 0; step < STEP_NUM; ++step) {
-                Vec3 coord = Coord2Vec3(latitude + width * geo_manip_y[step],
-                    longitude + width * geo_manip_x[step]);
-                coord *= (GLOBE_RADIUS + 0.5 + BEAM_PLANE_DIFF * j);
-                coord.Value(x, y, z);
+void GlobeRenderer::MakeBeams() {
+    // Update all positions, the producer thread is not running yet
+    mgr_->UpdateAll();
+    ClearBeams(mgr_->GetNumber());
+    AddBeams(mgr_->AcquireSnapshot());
+}
 
-                geometry_data[index++] = x;
-                geometry_data[index++] = y;
-                geometry_data[index++] = z;
+void GlobeRenderer::ClearBeams(size_t ids) {
+    beams_.clear();
+    beam_vertices_ = 0;
+    beam_tuple_size_ = GetBeamTupleSize(ids);
+}
 
-                tex_data[ti++] = tex_manip_u[step];
-                tex_data[ti++] = tex_manip_v[step];
-            }
+size_t GlobeRenderer::GetBeamPlanes(const PositionSnapshot& snapshot,
+    size_t num) const {
+    return ::GetBeamPlanes(snapshot, num, beam_planes_.GetMaxPlanes());
+}
+
+void GlobeRenderer::GetBeamColor(size_t num, float color[3]) const {
+    ::GetBeamColor(num, beam_tuple_size_, color);
+}
+
+void GlobeRenderer::ReserveBeams() {
+    beam_capacity_ = 2 * beam_vertices_;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_[BEAMS]);
+    glBufferData(GL_ARRAY_BUFFER, 3 * beam_capacity_ * sizeof(float),
+        nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_[BEAMS_TEX]);
+    glBufferData(GL_ARRAY_BUFFER, 2 * beam_capacity_ * sizeof(float),
+        nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_[BEAMS_COLOR]);
+    glBufferData(GL_ARRAY_BUFFER, 3 * beam_capacity_ * sizeof(float),
+        nullptr, GL_DYNAMIC_DRAW);
+}
+
+void GlobeRenderer::UploadBeams(vector<size_t> beams) {
+    // The buffers double when they are full, so every vertex is uploaded
+    // a constant number of times on average. New buffers get all beams,
+    // without the ranges left behind.
+    if (beam_vertices_ > beam_capacity_) {
+        beam_vertices_ = 0;
+        beams.resize(beams_.size());
+        for (size_t i = 0; i < beams_.size(); ++i) {
+            beams_[i].first = beam_vertices_;
+            beams_[i].capacity = beams_[i].planes;
+            beam_vertices_ += beams_[i].planes * PTS_PER_BEAM;
+            beams[i] = i;
+        }
+        ReserveBeams();
+    }
+
+    // Adjacent ranges are written together. A range gets all planes it
+    // has room for, so its beam can grow up to them without a write.
+    BeamArrays arrays;
+    size_t first_vertex = 0;
+    for (size_t k = 0; k < beams.size(); ++k) {
+        const Beam &beam = beams_[beams[k]];
+        if (arrays.geometry.empty()) {
+            first_vertex = beam.first;
         }
+        size_t vertices = beam.capacity * PTS_PER_BEAM;
+        float color[3];
+        GetBeamColor(beams[k], color);
+        arrays.Append(beam_planes_, vertices, color);
+        if (k + 1 < beams.size()
+                && beams_[beams[k + 1]].first == beam.first + vertices) {
+            continue;
+        }
+        WriteBeams(first_vertex, arrays);
+        arrays.Clear();
     }
+}
 
+void GlobeRenderer::WriteBeams(size_t first_vertex, const BeamArrays& arrays) {
     glBindBuffer(GL_ARRAY_BUFFER, buffer_[BEAMS]);
-    glBufferData(GL_ARRAY_BUFFER, num_geometry * sizeof(float),
-        geometry_data.get(), GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 3 * first_vertex * sizeof(float),
+        arrays.geometry.size() * sizeof(float), arrays.geometry.data());
 
     glBindBuffer(GL_ARRAY_BUFFER, buffer_[BEAMS_TEX]);
-    glBufferData(GL_ARRAY_BUFFER, num_uv * sizeof(float), tex_data.get(),
-        GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 2 * first_vertex * sizeof(float),
+        arrays.tex.size() * sizeof(float), arrays.tex.data());
 
-    color_data_.reset(new float[num_colors]);
-    index = 0;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_[BEAMS_COLOR]);
+    glBufferSubData(GL_ARRAY_BUFFER, 3 * first_vertex * sizeof(float),
+        arrays.color.size() * sizeof(float), arrays.color.data());
+}
 
-    // WARNING: android NDK log2 implementation is wrong
-    // (probably for C++0x only)
-    size_t tuple_size = ceil(log(num_beams_ + 1) / log(2) / 3);
-    for (size_t i = 0; i < num_beams_; ++i) {
-        int plane_num = planes_per_beam_[i] * PTS_PER_BEAM;
-        unsigned first_tuple = (1 << tuple_size) - 1;
-        unsigned color_r = (i + 1) & first_tuple;
-        unsigned second_tuple = (1 << (tuple_size * 2)) - 1 - first_tuple;
-        unsigned color_g = ((i + 1) & second_tuple) >> tuple_size;
-        unsigned third_tuple = (1 << (tuple_size * 3)) - 1 - first_tuple
-                - second_tuple;
-        unsigned color_b = ((i + 1) & third_tuple) >> (2 * tuple_size);
-        for (size_t j = 0; j < plane_num; ++j) {
-            color_data_[index + j * 3] = 1.f * color_r / first_tuple;
-            color_data_[index + 1 + j * 3] = 1.f * color_g / first_tuple;
-            color_data_[index + 2 + j * 3] = 1.f * color_b / first_tuple;
-        }
-        index += plane_num * 3;
+void GlobeRenderer::AddBeams(const PositionSnapshot& snapshot) {
+    // Appended to the used part, the streaming load makes all beams
+    // again with the final altitude range
+    vector<size_t> added;
+    for (size_t i = beams_.size(); i < snapshot.position.size(); ++i) {
+        size_t planes = GetBeamPlanes(snapshot, i);
+        beams_.push_back(Beam {beam_vertices_, planes, planes});
+        beam_vertices_ += planes * PTS_PER_BEAM;
+        added.push_back(i);
+    }
+    if (!added.empty()) {
+        UploadBeams(move(added));
+    }
+}
+
+void GlobeRenderer::UpdateBeams(const PositionSnapshot& snapshot,
+    const vector<size_t>& changed) {
+    size_t number = snapshot.position.size();
+    if (number >= 1u << (3 * beam_tuple_size_)) {
+        // More satellites than the colors tell apart
+        ClearBeams(number);
+        AddBeams(snapshot);
+        return;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, buffer_[BEAMS_COLOR]);
-    glBufferData(GL_ARRAY_BUFFER, num_colors * sizeof(float), color_data_.get(),
-        GL_STATIC_DRAW);
+    // The color stays with the index, so a beam keeps its range while
+    // its planes fit and only moves to a new range at the end otherwise
+    vector<size_t> moved;
+    for (size_t i : changed) {
+        Beam &beam = beams_[i];
+        beam.planes = GetBeamPlanes(snapshot, i);
+        if (beam.planes > beam.capacity) {
+            beam.first = beam_vertices_;
+            beam.capacity = beam.planes;
+            beam_vertices_ += beam.planes * PTS_PER_BEAM;
+            moved.push_back(i);
+        }
+    }
+    beams_.resize(min(beams_.size(), number));
+    if (!moved.empty()) {
+        UploadBeams(move(moved));
+    }
+    AddBeams(snapshot);
 }
 
 void GlobeRenderer::InitFBO() {
@@ -324,6 +403,7 @@ void GlobeRenderer::Init() {
     star_texture_ = JNIHelper::GetInstance()->LoadTexture("star.png");
 
     glGenBuffers(MAX_BUFFERS, buffer_);
+    beam_capacity_ = 0;
     MakeSphere(30, 30);
     MakePoints(CAM_Z, 500);
     InitFBO();
@@ -346,6 +426,7 @@ void GlobeRenderer::UpdateViewport() {
 }
 
 void GlobeRenderer::Unload() {
+    mgr_->Stop();
     glDeleteBuffers(MAX_BUFFERS, buffer_);
 
     for (size_t i = 0; i < MAX_SHADERS; ++i) {
@@ -358,7 +439,8 @@ void GlobeRenderer::Unload() {
 
 }
 
-void GlobeRenderer::Update(double fTime) {
+void GlobeRenderer::Update() {
+    clock_.Tick();
     camera_->Update();
     Mat4 mat_tranform = camera_->GetTransformMatrix();
     float cam_z = mat_tranform.Ptr()[14];
@@ -471,7 +553,8 @@ void GlobeRenderer::RenderBackground() {
     glDeleteBuffers(1, &vbo);
 }
 
-void GlobeRenderer::RenderBeams(bool fbo = false) {
+void GlobeRenderer::RenderBeams(const PositionSnapshot &snapshot,
+    bool fbo = false) {
     SHADER_PARAMS bg_shader_param_ = shader_params_[fbo ? FBO : BACKGROUND];
     glUseProgram(bg_shader_param_.program_);
 
@@ -496,14 +579,12 @@ void GlobeRenderer::RenderBeams(bool fbo = false) {
     glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(ATTRIB_NORMAL);
 
-    int index = 0;
     Vec3 vec_from = Coord2Vec3(INITIAL_LATITUDE, INITIAL_LONGITUDE).Normalize();
-    // Update all positions
-    mgr_.UpdateAll();
-    for (size_t i = 0; i < num_beams_; ++i) {
-        Satellite &sat = mgr_.GetSatellite(i);
-        auto latitude = 90 - sat.GetLatitude();
-        auto longitude = sat.GetLongitude() - 90;
+    size_t num_beams = min(beams_.size(), snapshot.position.size());
+    for (size_t i = 0; i < num_beams; ++i) {
+        const SatellitePosition &position = snapshot.position[i];
+        auto latitude = 90 - position.latitude;
+        auto longitude = position.longitude - 90;
         Vec3 vec_to = Coord2Vec3(latitude, longitude).Normalize();
         Mat4 rotate_matrix;
 
@@ -517,9 +598,9 @@ void GlobeRenderer::RenderBeams(bool fbo = false) {
         glUniformMatrix4fv(bg_shader_param_.matrix_projection_, 1, GL_FALSE,
             mat_vp.Ptr());
 
-        int plane_num = planes_per_beam_[i] * PTS_PER_BEAM;
-        glDrawArrays(GL_TRIANGLE_STRIP, index, plane_num);
-        index += plane_num;
+        const Beam &beam = beams_[i];
+        glDrawArrays(GL_TRIANGLE_STRIP, beam.first,
+            beam.planes * PTS_PER_BEAM);
     }
 }
 
@@ -530,44 +611,73 @@ void GlobeRenderer::BindAndClear(bool fbo = false) {
 }
 
 void GlobeRenderer::Render() {
+    // Checked before the snapshot is taken: once the streaming load is
+    // done, the snapshot has the whole catalog
+    bool loaded = streaming_ && !mgr_->IsLoading();
+    // Latest positions from the producer thread, both passes share them
+    const PositionSnapshot &snapshot = mgr_->AcquireSnapshot();
+    if (loaded) {
+        // Final altitude range and number of colors
+        streaming_ = false;
+        ClearBeams(snapshot.position.size());
+    }
+    {
+        ProfileZone zone(&profiler_, ZONE_BEAM_GEOMETRY);
+        AddBeams(snapshot);
+    }
+
     // Render FBO
-    BindAndClear(true);
-    RenderBeams(true);
+    {
+        ProfileZone zone(&profiler_, ZONE_PICKING);
+        BindAndClear(true);
+        RenderBeams(snapshot, true);
+    }
 
     // Render scene
-    BindAndClear();
 #if DEBUG_FBO
-    RenderBeams(true);
+    BindAndClear();
+    RenderBeams(snapshot, true);
 #else
-    RenderBackground();
-    RenderGlobe();
-
-    glEnable (GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE);
-    RenderBeams();
-    glDisable(GL_BLEND);
+    {
+        ProfileZone zone(&profiler_, ZONE_BACKGROUND);
+        BindAndClear();
+        RenderBackground();
+    }
+    {
+        ProfileZone zone(&profiler_, ZONE_GLOBE);
+        RenderGlobe();
+    }
+    {
+        ProfileZone zone(&profiler_, ZONE_BEAMS);
+        glEnable (GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        RenderBeams(snapshot);
+        glDisable(GL_BLEND);
+    }
 #endif
 
     if (read_requested_) {
-        glBindFramebuffer(GL_FRAMEBUFFER, fb_);
         float x, y;
         read_coord_.Value(x, y);
         uint8_t data[4] = {};
-        glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &data);
-        size_t index = 0;
-        for (long i = 0; i < num_beams_; ++i) {
-            size_t plane_num = planes_per_beam_[i] * PTS_PER_BEAM;
+        {
+            // Waits for the picking pass
+            ProfileZone zone(&profiler_, ZONE_READ_PIXELS);
+            glBindFramebuffer(GL_FRAMEBUFFER, fb_);
+            glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &data);
+        }
+        for (size_t i = 0; i < beams_.size(); ++i) {
+            float color[3];
+            GetBeamColor(i, color);
             bool found = true;
             for (size_t j = 0; j < 3; ++j) {
-                found = found
-                        && fabs(255 * color_data_[index + j] - data[j]) <= 1;
+                found = found && fabs(255 * color[j] - data[j]) <= 1;
             }
             if (found) {
-                Message msg = {SHOW_BEAM, reinterpret_cast<void*>(i)};
-                PostMessage(msg);
+                PostMessage(Message::ShowBeam(i,
+                    mgr_->GetSatellite(i).GetCatNum()));
                 break;
             }
-            index += plane_num * 3;
         }
         read_requested_ = false;
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -626,9 +736,126 @@ void GlobeRenderer::LoadShaders(SHADER_PARAMS *params, const char *strVsh,
     params->program_ = program;
 }
 
-void GlobeRenderer::InitSatelliteMgr(IFileReader& reader) {
-    mgr_.Init(reader);
+void GlobeRenderer::InitSatelliteMgr(IFileReader& reader,
+    const char *cache_path) {
+    streaming_ = false;
+    mgr_->Init(reader);
+    if (cache_path && !mgr_->Save(cache_path)) {
+        LOGI("Cannot write %s", cache_path);
+    }
+    MakeBeams();
+    ++generation_;
+    if (updates_enabled_) {
+        mgr_->Start();
+    }
+}
+
+bool GlobeRenderer::LoadSatelliteMgr(const char *path) {
+    if (!mgr_->Load(path)) {
+        return false;
+    }
+    streaming_ = false;
     MakeBeams();
+    ++generation_;
+    if (updates_enabled_) {
+        mgr_->Start();
+    }
+    return true;
+}
+
+void GlobeRenderer::StreamSatelliteMgr(unique_ptr<IFileReader> reader,
+    const char *cache_path) {
+    mgr_->Stream(move(reader), cache_path ? cache_path : "");
+    // Empty catalog, or the batches parsed in the meantime
+    mgr_->UpdateAll();
+    ClearBeams(mgr_->GetMaxNumber());
+    AddBeams(mgr_->AcquireSnapshot());
+    streaming_ = true;
+    ++generation_;
+    if (updates_enabled_) {
+        mgr_->Start();
+    }
+}
+
+void GlobeRenderer::RefreshSatelliteMgr(CatalogLoader::Open open,
+    const char *cache_path) {
+    if (streaming_ || mgr_->GetNumber() == 0) {
+        QueueSatelliteMgr(move(open), cache_path);
+        return;
+    }
+    // The propagators are copied between two updates, so the loader
+    // thread only initializes the changed element sets
+    vector<Satellite> base;
+    vector<SatelliteCalc> calc;
+    mgr_->Stop();
+    mgr_->CopyCatalog(base, calc);
+    if (updates_enabled_) {
+        mgr_->Start();
+    }
+    loader_.Refresh(move(open), move(base), move(calc), generation_,
+        cache_path ? cache_path : "");
+}
+
+void GlobeRenderer::QueueSatelliteMgr(CatalogLoader::Open open,
+    const char *cache_path) {
+    loader_.Load(move(open), cache_path ? cache_path : "");
+}
+
+void GlobeRenderer::SwapSatelliteMgr(unique_ptr<LoadedCatalog> catalog) {
+    if (!catalog->saved) {
+        LOGI("Cannot write the catalog cache");
+    }
+    // The pool runs one loop at a time, so the old producer thread
+    // stops before the new one starts. Its memory is freed by the
+    // loader thread.
+    mgr_->Stop();
+    loader_.Dispose(move(mgr_));
+    mgr_ = move(catalog->mgr);
+    mgr_->SetClock(&clock_);
+    mgr_->SetThreadPool(pool_);
+    mgr_->SetProfiler(&profiler_);
+    streaming_ = false;
+
+    ProfileZone zone(&profiler_, ZONE_BEAM_GEOMETRY);
+    if (catalog->refreshed) {
+        // The loader thread published the first update
+        const PositionSnapshot &snapshot = mgr_->AcquireSnapshot();
+        if (catalog->generation == generation_) {
+            UpdateBeams(snapshot, catalog->changed);
+        } else {
+            // Refreshed from a catalog replaced in the meantime
+            ClearBeams(snapshot.position.size());
+            AddBeams(snapshot);
+        }
+    } else {
+        // Only uploads, the loader thread built the vertices
+        beams_ = move(catalog->beams);
+        beam_tuple_size_ = catalog->tuple_size;
+        beam_vertices_ = catalog->arrays.GetVertices();
+        ReserveBeams();
+        WriteBeams(0, catalog->arrays);
+    }
+    ++generation_;
+    // Not while the app has no focus
+    if (updates_enabled_) {
+        mgr_->Start();
+    }
+}
+
+bool GlobeRenderer::FindSatellite(int catnum, size_t &num) {
+    // Satellites beyond the snapshot may still be loading
+    size_t number = mgr_->GetSnapshot().position.size();
+    if (num < number && mgr_->GetSatellite(num).GetCatNum() == catnum) {
+        return true;
+    }
+    // Moved or removed by another catalog since it was picked
+    for (size_t i = 0; i < number; ++i) {
+        if (mgr_->GetSatellite(i).GetCatNum() == catnum) {
+            num = i;
+            return true;
+        }
+    }
+    return false;
 }
 
 void GlobeRenderer::RequestRead(const Vec2& v) {
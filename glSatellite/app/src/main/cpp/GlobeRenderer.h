@@ -2,6 +2,8 @@
 
 #include "ndk_helper/NDKHelper.h"
 #include "SatelliteMgr.h"
+#include "CatalogLoader.h"
+#include "FrameProfiler.h"
 #include "IFileReader.h"
 #include "ndk_helper/tapCamera.h"
 
@@ -35,15 +37,37 @@ struct SHADER_PARAMS {
 };
 
 class GlobeRenderer {
-    size_t num_indices_, num_points_, num_beams_;
+    size_t num_indices_, num_points_;
+    // Used part of the beam buffers and the vertices they have room for,
+    // the used part includes the ranges left behind by moved beams
+    size_t beam_vertices_, beam_capacity_;
+    // Bits per color channel of the beam colors, which tell apart the
+    // satellites until the next ClearBeams()
+    size_t beam_tuple_size_;
+    // Beams are added while a streaming load runs
+    bool streaming_;
+    // Counts the rendered catalogs, a refresh of the loader only keeps
+    // the beams of the catalog it was made from
+    size_t generation_;
+    // Between StartUpdates() and StopUpdates(), the producer thread of a
+    // new catalog only starts then
+    bool updates_enabled_;
     GLuint buffer_[MAX_BUFFERS];
     GLuint texture_;
     GLuint star_texture_;
-    std::unique_ptr<size_t[]> planes_per_beam_;
-    SatelliteMgr mgr_;
+    BeamPlanes beam_planes_;
+    // Same order as the satellites
+    std::vector<Beam> beams_;
+    // Destroyed after the manager and the loader which read them
+    SimulationClock clock_;
+    FrameProfiler profiler_;
+    // Replaced by the catalogs of the loader
+    std::unique_ptr<SatelliteMgr> mgr_;
+    ThreadPool* pool_;
+    // Destroyed first, it may still hand over a catalog
+    CatalogLoader loader_;
     bool zoom_in_enabled_, zoom_out_enabled_, read_requested_;
     ndk_helper::Vec2 read_coord_;
-    std::unique_ptr<float[]> color_data_;
     GLuint fb_;
 
     SHADER_PARAMS shader_params_[MAX_SHADERS];
@@ -59,13 +83,31 @@ class GlobeRenderer {
 
     void MakeSphere(int lats, int longs);
     void MakePoints(float radius, int number);
+    void MakeBeamPlanes();
     void MakeBeams();
+    // Drops the beams, the next ones get colors for ids satellites
+    void ClearBeams(size_t ids);
+    size_t GetBeamPlanes(const PositionSnapshot& snapshot, size_t num) const;
+    // Color of the beam in the FBO, which identifies the satellite
+    void GetBeamColor(size_t num, float color[3]) const;
+    // New beam buffers with room for twice the used part
+    void ReserveBeams();
+    // Writes the vertices of adjacent ranges from the first vertex on
+    void WriteBeams(size_t first_vertex, const BeamArrays& arrays);
+    // Writes the ranges of the beams, in ascending order of their ranges.
+    // If the buffers are full, new ones get all beams packed.
+    void UploadBeams(std::vector<size_t> beams);
+    // Adds the beams of the snapshot's satellites that have none yet
+    void AddBeams(const PositionSnapshot& snapshot);
+    // Same after SatelliteMgr::Refresh(), the changed beams are put again
+    void UpdateBeams(const PositionSnapshot& snapshot,
+        const std::vector<size_t>& changed);
     void InitFBO();
     void BindAndClear(bool fbo);
 
     void RenderGlobe();
     void RenderBackground();
-    void RenderBeams(bool fbo);
+    void RenderBeams(const PositionSnapshot& snapshot, bool fbo);
 
 public:
     GlobeRenderer();
@@ -74,14 +116,41 @@ public:
         Unload();
     }
 
-    void Bind(ndk_helper::TapCamera* camera) {
+    void Bind(ndk_helper::TapCamera* camera, ThreadPool* pool) {
         camera_ = camera;
+        pool_ = pool;
+        mgr_->SetThreadPool(pool);
     }
 
-    void InitSatelliteMgr(IFileReader& reader);
+    // Loads the TLE catalog, and writes it to cache_path for
+    // LoadSatelliteMgr() unless it is nullptr
+    void InitSatelliteMgr(IFileReader& reader,
+        const char *cache_path = nullptr);
+    // Same from a catalog file, false if it is missing or invalid
+    bool LoadSatelliteMgr(const char *path);
+    // Same as InitSatelliteMgr(), but the catalog is parsed on a loader
+    // thread from the view of the reader, which it keeps until the next
+    // load, and the beams are added batch by batch as it arrives
+    void StreamSatelliteMgr(std::unique_ptr<IFileReader> reader,
+        const char *cache_path = nullptr);
+    // Same as QueueSatelliteMgr(), but the loader thread updates a copy
+    // of the rendered catalog, see SatelliteMgr::Refresh(), so only the
+    // beams that changed are written. Queues a whole catalog if none is
+    // loaded or a streaming load runs.
+    void RefreshSatelliteMgr(CatalogLoader::Open open,
+        const char *cache_path = nullptr);
+    // Loads the catalog on the loader thread without blocking, which
+    // posts CATALOG_READY with it for SwapSatelliteMgr(). The rendered
+    // catalog is kept until then, and if the reader is not open.
+    void QueueSatelliteMgr(CatalogLoader::Open open,
+        const char *cache_path = nullptr);
+    // Replaces the catalog by a loaded one and uploads its beams, or
+    // writes the changed ones of a refresh
+    void SwapSatelliteMgr(std::unique_ptr<LoadedCatalog> catalog);
     void Init();
     void Render();
-    void Update(double dTime);
+    // Advances the simulation clock and the camera
+    void Update();
     void Unload();
     void UpdateViewport();
     void RequestRead(const ndk_helper::Vec2& v);
@@ -92,7 +161,31 @@ public:
         return zoom_out_enabled_;
     }
     Satellite &GetSatellite(size_t num) {
-        return mgr_.GetSatellite(num);
+        return mgr_->GetSatellite(num);
+    }
+    // Sets num to the index of the satellite in the last rendered frame,
+    // the given one if it still has the catalog number. False if the
+    // frame has no such satellite.
+    bool FindSatellite(int catnum, size_t &num);
+    // Position in the last rendered frame
+    const SatellitePosition &GetPosition(size_t num) {
+        return mgr_->GetSnapshot().position[num];
+    }
+    SimulationClock &GetClock() {
+        return clock_;
+    }
+    // Times the passes of Render(), the propagation and the beams
+    FrameProfiler &GetProfiler() {
+        return profiler_;
+    }
+    // Propagation runs in the background between these calls
+    void StartUpdates() {
+        updates_enabled_ = true;
+        mgr_->Start();
+    }
+    void StopUpdates() {
+        updates_enabled_ = false;
+        mgr_->Stop();
     }
 };
 
@@ -1,10 +1,44 @@
 #pragma once
 
+#include <cstring>
+#include <string>
+
+#include "StringView.h"
+
+/*
+ * Read-only file contents as one contiguous view, mapped or owned by the
+ * reader so the parsers read the storage without copies. getline() reads
+ * the lines of the view like std::getline() for the callers that want
+ * strings.
+ */
 class IFileReader {
+    // Start of the next line of getline()
+    size_t pos_ = 0;
+    bool eof_ = false;
 public:
     virtual bool is_open() = 0;
-    virtual bool eof() = 0;
-    virtual std::string getline() = 0;
+    // Whole contents, valid as long as the reader. Empty if it is not open.
+    virtual StringView view() = 0;
     virtual ~IFileReader() {
     }
+
+    // True after getline() reached the end of the view
+    bool eof() const {
+        return eof_;
+    }
+
+    std::string getline() {
+        StringView text = view();
+        const char *begin = text.data + pos_;
+        size_t rest = text.size - pos_;
+        const char *end = rest ?
+                static_cast<const char*>(memchr(begin, '\n', rest)) : nullptr;
+        if (!end) {
+            pos_ = text.size;
+            eof_ = true;
+            return std::string(begin, rest);
+        }
+        pos_ += end - begin + 1;
+        return std::string(begin, end - begin);
+    }
 };
@@ -0,0 +1,65 @@
+#include "JniUiBackend.h"
+#include "JNIHelper.h"
+
+/* Method of the class, nullptr without a pending NoSuchMethodError. */
+static jmethodID GetMethod(JNIEnv *env, jclass clazz, const char *name,
+    const char *signature) {
+    jmethodID method = env->GetMethodID(clazz, name, signature);
+    if (!method) {
+        LOGE("Cannot find the method %s of the activity", name);
+        env->ExceptionClear();
+    }
+    return method;
+}
+
+bool JniUiBackend::Attach() {
+    if (activity_->vm->AttachCurrentThread(&env_, nullptr) != JNI_OK) {
+        LOGE("Cannot attach the UI bridge thread");
+        env_ = nullptr;
+        return false;
+    }
+
+    // The thread stays attached until Detach(), also if a method is
+    // missing
+    jclass clazz = env_->GetObjectClass(activity_->clazz);
+    show_ui_ = GetMethod(env_, clazz, "showUI", "()V");
+    update_fps_ = GetMethod(env_, clazz, "updateFPS", "(F)V");
+    update_label_ = GetMethod(env_, clazz, "updateLabel",
+        "(Ljava/lang/String;)V");
+    show_beam_ = GetMethod(env_, clazz, "showBeam",
+        "(Ljava/lang/String;IFFF)V");
+    env_->DeleteLocalRef(clazz);
+    return show_ui_ && update_fps_ && update_label_ && show_beam_;
+}
+
+void JniUiBackend::Detach() {
+    // Also after a failed Attach(), if the thread was attached
+    if (env_) {
+        activity_->vm->DetachCurrentThread();
+        env_ = nullptr;
+    }
+}
+
+void JniUiBackend::ShowUI() {
+    env_->CallVoidMethod(activity_->clazz, show_ui_);
+}
+
+void JniUiBackend::UpdateFPS(float fps) {
+    env_->CallVoidMethod(activity_->clazz, update_fps_, fps);
+}
+
+void JniUiBackend::UpdateLabel(const char *label) {
+    // The thread stays attached, so local references are not freed
+    // by a return to Java
+    jstring j_label = env_->NewStringUTF(label);
+    env_->CallVoidMethod(activity_->clazz, update_label_, j_label);
+    env_->DeleteLocalRef(j_label);
+}
+
+void JniUiBackend::ShowBeam(const char *name, int catnum, float latitude,
+    float longitude, float altitude) {
+    jstring j_name = env_->NewStringUTF(name);
+    env_->CallVoidMethod(activity_->clazz, show_beam_, j_name, catnum,
+        latitude, longitude, altitude);
+    env_->DeleteLocalRef(j_name);
+}
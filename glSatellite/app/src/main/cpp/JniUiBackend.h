@@ -0,0 +1,33 @@
+#pragma once
+
+#include <android_native_app_glue.h>
+#include <jni.h>
+
+#include "UiBridge.h"
+
+/*
+ * UI of GlobeNativeActivity through JNI. The bridge thread is attached
+ * once and the method IDs are resolved once, the activity object is the
+ * global reference of the native activity.
+ */
+class JniUiBackend: public IUiBackend {
+    ANativeActivity *activity_;
+    JNIEnv *env_ = nullptr;
+    jmethodID show_ui_ = nullptr;
+    jmethodID update_fps_ = nullptr;
+    jmethodID update_label_ = nullptr;
+    jmethodID show_beam_ = nullptr;
+public:
+    explicit JniUiBackend(ANativeActivity *activity) :
+            activity_(activity) {
+    }
+
+    bool Attach() override;
+    void Detach() override;
+
+    void ShowUI() override;
+    void UpdateFPS(float fps) override;
+    void UpdateLabel(const char *label) override;
+    void ShowBeam(const char *name, int catnum, float latitude,
+        float longitude, float altitude) override;
+};
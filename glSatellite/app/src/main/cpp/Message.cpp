@@ -0,0 +1,53 @@
+#include "CatalogLoader.h"
+#include "Message.h"
+
+using namespace std;
+
+// Commands of which only the latest message of a batch is handled: a
+// newer selection replaces an older one, only the last tap is shown and
+// one dump has the same statistics as several. A loaded catalog is not
+// dropped, its manager would be destroyed on the looper thread, and a
+// refresh applies to the catalog before it.
+static const bool COALESCED[MAX_MESSAGES] = {
+    true,  // USE_TLE
+    true,  // SHOW_BEAM
+    false, // CATALOG_READY
+    true,  // DUMP_PROFILE
+};
+
+Message::Message() = default;
+Message::Message(Message&& other) = default;
+Message& Message::operator=(Message&& other) = default;
+Message::~Message() = default;
+
+Message Message::UseTle(string path) {
+    Message msg;
+    msg.cmd = USE_TLE;
+    msg.path = move(path);
+    return msg;
+}
+
+Message Message::ShowBeam(size_t index, int catnum) {
+    Message msg;
+    msg.cmd = SHOW_BEAM;
+    msg.index = index;
+    msg.catnum = catnum;
+    return msg;
+}
+
+Message Message::CatalogReady(unique_ptr<LoadedCatalog> catalog) {
+    Message msg;
+    msg.cmd = CATALOG_READY;
+    msg.catalog = move(catalog);
+    return msg;
+}
+
+Message Message::DumpProfile() {
+    Message msg;
+    msg.cmd = DUMP_PROFILE;
+    return msg;
+}
+
+bool MessageBatch::IsCoalesced(MESSAGES cmd) {
+    return COALESCED[cmd];
+}
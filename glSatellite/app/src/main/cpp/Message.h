@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MessageRing.h"
+
+struct LoadedCatalog;
+
+// Message commands
+enum MESSAGES {
+    USE_TLE,
+    SHOW_BEAM,
+    CATALOG_READY,
+    DUMP_PROFILE,
+    MAX_MESSAGES
+};
+
+/*
+ * Command to the looper thread with the payload it owns, made by the
+ * functions below. Only the payload of the command is set. Move-only,
+ * so every payload has one owner on its way through the queue.
+ */
+struct Message {
+    MESSAGES cmd = MAX_MESSAGES;
+    // USE_TLE: path of the catalog
+    std::string path;
+    // SHOW_BEAM: index and catalog number of the picked satellite in
+    // the catalog rendered when it was picked
+    size_t index = 0;
+    int catnum = 0;
+    // CATALOG_READY, every one is handled so the replaced manager goes
+    // back to the loader to be destroyed
+    std::unique_ptr<LoadedCatalog> catalog;
+
+    // Defined where LoadedCatalog is complete
+    Message();
+    Message(Message&& other);
+    Message& operator=(Message&& other);
+    ~Message();
+
+    static Message UseTle(std::string path);
+    static Message ShowBeam(size_t index, int catnum);
+    static Message CatalogReady(std::unique_ptr<LoadedCatalog> catalog);
+    static Message DumpProfile();
+};
+
+/*
+ * Takes the messages of a ring in batches and coalesces them: of the
+ * commands that only need their latest state, e.g. a burst of catalog
+ * selections or taps, only the latest message of a batch is handled.
+ * The others are dropped with their payloads.
+ */
+class MessageBatch {
+    std::vector<Message> messages_;
+public:
+    // True if only the latest message of the command counts
+    static bool IsCoalesced(MESSAGES cmd);
+
+    // Drains the ring and calls handle with the messages that are left,
+    // in the order they were taken. Returns their number.
+    template<class F>
+    size_t Read(MessageRing<Message>& ring, F handle) {
+        // Kept between the calls, so its memory is reused
+        messages_.clear();
+        ring.Drain([this](Message msg) {
+            messages_.push_back(std::move(msg));
+        });
+        size_t latest[MAX_MESSAGES];
+        for (size_t k = 0; k < MAX_MESSAGES; ++k) {
+            latest[k] = messages_.size();
+        }
+        for (size_t i = 0; i < messages_.size(); ++i) {
+            latest[messages_[i].cmd] = i;
+        }
+        size_t handled = 0;
+        for (size_t i = 0; i < messages_.size(); ++i) {
+            MESSAGES cmd = messages_[i].cmd;
+            if (!IsCoalesced(cmd) || latest[cmd] == i) {
+                handle(std::move(messages_[i]));
+                ++handled;
+            }
+        }
+        messages_.clear();
+        return handled;
+    }
+};
@@ -1,6 +1,6 @@
-#include <fcntl.h>
-#include <unistd.h>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
 
 #include "ndk_helper/NDKHelper.h"
 #include "MessageQueue.h"
@@ -11,12 +11,8 @@ MessageQueue g_queue;
 using namespace std;
 
 /* External C interface */
-void PostMessage(int queue_id, Message msg) {
-    g_queue.PostMessage(queue_id, msg);
-}
-
 void PostMessage(Message msg) {
-    g_queue.PostMessage(msg);
+    g_queue.PostMessage(move(msg));
 }
 
 int AddMessageQueue(android_poll_source *src) {
@@ -27,12 +23,8 @@ void InitMessageQueue(ALooper* looper) {
     g_queue.Init(looper);
 }
 
-Message ReadMessageQueue(int pipe_read) {
-    Message msg;
-    if (read(pipe_read, &msg, sizeof(msg)) != sizeof(msg)) {
-        LOGE("No data on message pipe!");
-    }
-    return msg;
+void ReadMessageQueue(HandleMessagePtr handle) {
+    g_queue.ReadMessages(handle);
 }
 
 /* Internal implementation */
@@ -40,34 +32,26 @@ int MessageQueue::AddMessageQueue(android_poll_source *src) {
     if (!looper_) {
         return -1;
     }
+    if (ring_.GetFd() < 0) {
+        LOGE("could not create eventfd: %s", strerror(errno));
+        return -1;
+    }
 
     current_id_++;
     src->id = current_id_;
-    MessageQueueEntry entry;
-    if (pipe(entry.message_pipe_)) {
-        LOGE("could not create pipe: %s", strerror(errno));
-        return -1;
-    }
     /* Register the file descriptor to listen on. */
-    int msgread = entry.message_pipe_[0];
-    ALooper_addFd(looper_, msgread, current_id_, ALOOPER_EVENT_INPUT, nullptr,
-        src);
-    // Increment id right before the insert
-    entries_.insert(pair<int, MessageQueueEntry>(current_id_, entry));
-    return msgread;
+    ALooper_addFd(looper_, ring_.GetFd(), current_id_, ALOOPER_EVENT_INPUT,
+        nullptr, src);
+    return current_id_;
 }
 
-void MessageQueue::PostMessage(int queue_id, Message msg) {
-    if (!looper_) {
-        return;
-    }
-
-    int pipe = entries_[queue_id].message_pipe_[1];
-    if (write(pipe, &msg, sizeof(msg)) != sizeof(msg)) {
-        LOGE("Failure writing message: %s\n", strerror(errno));
+void MessageQueue::PostMessage(Message msg) {
+    // Messages before AddMessageQueue() wait for it
+    if (!ring_.Push(move(msg))) {
+        LOGE("Message queue full, dropped command %d", msg.cmd);
     }
 }
 
-void MessageQueue::PostMessage(Message msg) {
-    PostMessage(current_id_, msg);
+void MessageQueue::ReadMessages(HandleMessagePtr handle) {
+    batch_.Read(ring_, handle);
 }
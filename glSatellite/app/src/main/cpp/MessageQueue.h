@@ -1,40 +1,38 @@
 #pragma once
 
-#include <map>
-
-// Message commands
-enum {
-    USE_TLE, SHOW_BEAM
-};
-
-struct Message {
-    int cmd;
-    void *payload;
-};
+#include "Message.h"
 
 typedef void (*HandleMessagePtr)(Message msg);
 
-void PostMessage(int queue_id, Message msg);
+// Any thread: queues the message for the looper thread
 void PostMessage(Message msg);
+// Registers the queue with the looper, which calls the process function
+// of the source when messages arrive. Returns its looper id, -1 on errors.
 int AddMessageQueue(android_poll_source *src);
 void InitMessageQueue(ALooper* looper);
-Message ReadMessageQueue(int pipe_read);
-
-struct MessageQueueEntry {
-    int message_pipe_[2];
-};
+// Looper thread: handles all messages that arrived, in the order of
+// each thread's posts, coalesced by MessageBatch
+void ReadMessageQueue(HandleMessagePtr handle);
 
+/*
+ * Messages of any thread to the looper thread, in a lock-free ring.
+ * The looper wakes up once per burst and handles all of it.
+ */
 class MessageQueue {
-    std::map<int, MessageQueueEntry> entries_;
+    static const size_t CAPACITY = 1024;
+
+    MessageRing<Message> ring_;
+    MessageBatch batch_;
     ALooper* looper_;
     static int current_id_;
 public:
     MessageQueue() :
+                ring_(CAPACITY),
                 looper_(nullptr) {
     }
     int AddMessageQueue(android_poll_source *src);
-    void PostMessage(int queue_id, Message msg);
     void PostMessage(Message msg);
+    void ReadMessages(HandleMessagePtr handle);
     void Init(ALooper* looper) {
         looper_ = looper;
     }
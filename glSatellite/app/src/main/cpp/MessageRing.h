@@ -0,0 +1,150 @@
+#pragma once
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "ThreadPool.h"
+
+/*
+ * Bounded lock-free queue of messages from any number of producer threads
+ * to one consumer thread. Every slot has a sequence number that tells
+ * whose turn it is (D. Vyukov's bounded queue): a producer claims the
+ * next slot with a CAS on the tail and publishes it with the sequence,
+ * the consumer takes the published slots in order.
+ *
+ * The consumer sleeps on an eventfd, e.g. registered with ALooper, that
+ * only the push finding the queue empty writes. It takes all messages at
+ * once when it wakes up, so a burst costs one write() and one read().
+ */
+template<class T>
+class MessageRing {
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slot_;
+    size_t mask_;
+    int fd_;
+    // Next slot of the producers, on its own cache line
+    char pad_[CACHE_LINE];
+    std::atomic<size_t> tail_;
+    char tail_pad_[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    // Pushed messages not yet taken. Counted after the push, so it is
+    // negative while the consumer took messages not counted yet.
+    std::atomic<ptrdiff_t> size_;
+    char size_pad_[CACHE_LINE - sizeof(std::atomic<ptrdiff_t>)];
+    // Next slot of the consumer
+    size_t head_;
+
+    void Signal() {
+        uint64_t one = 1;
+        if (write(fd_, &one, sizeof(one)) != sizeof(one)) {
+            // The counter is already signalled, or there is no eventfd
+        }
+    }
+public:
+    // The capacity is rounded up to a power of two
+    explicit MessageRing(size_t capacity) :
+            fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+            tail_(0),
+            size_(0),
+            head_(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        slot_.reset(new Slot[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            slot_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MessageRing() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    MessageRing(const MessageRing&) = delete;
+    MessageRing& operator=(const MessageRing&) = delete;
+
+    // Readable while messages wait, -1 if it could not be created
+    int GetFd() const {
+        return fd_;
+    }
+
+    size_t GetCapacity() const {
+        return mask_ + 1;
+    }
+
+    // Any thread: moves the value into the queue, false (and the value
+    // is kept) if the queue is full
+    bool Push(T&& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slot_[pos & mask_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            ptrdiff_t diff = (ptrdiff_t)(sequence - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1,
+                    std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The consumer has not taken the value of the last round
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        if (size_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+            Signal();
+        }
+        return true;
+    }
+
+    // Consumer thread: calls handle with every message pushed before the
+    // call, in the order of the claimed slots, and returns their number.
+    // Messages the handler pushes wait for the next call, which the
+    // eventfd wakes up.
+    template<class F>
+    size_t Drain(F handle) {
+        // Cleared first, a push after it wakes the consumer again
+        uint64_t count;
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+            // Woken up by an earlier Drain() that took the message
+        }
+        size_t end = tail_.load(std::memory_order_acquire);
+        size_t taken = 0;
+        while (head_ != end) {
+            Slot &slot = slot_[head_ & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+                // Claimed, but not published yet
+                break;
+            }
+            T value = std::move(slot.value);
+            slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+            ++taken;
+            handle(std::move(value));
+        }
+        // Messages counted but left behind did not signal, so signal
+        // for them
+        ptrdiff_t left = size_.fetch_sub(taken, std::memory_order_acq_rel)
+                - (ptrdiff_t)taken;
+        if (left > 0) {
+            Signal();
+        }
+        return taken;
+    }
+};
@@ -0,0 +1,469 @@
+#include <cstring>
+
+#include "OmmParser.h"
+#include "SatelliteConst.h"
+#include "TleParser.h"
+
+// Keywords in the order of OMM_FIELDS, with their length to rule out
+// most of them before comparing any characters
+struct Keyword {
+    const char *name;
+    size_t size;
+};
+
+#define KEYWORD(name) {#name, sizeof(#name) - 1}
+
+static const Keyword FIELD_NAMES[MAX_OMM_FIELDS] = {
+    KEYWORD(OBJECT_NAME), KEYWORD(OBJECT_ID), KEYWORD(EPOCH),
+    KEYWORD(MEAN_MOTION), KEYWORD(ECCENTRICITY), KEYWORD(INCLINATION),
+    KEYWORD(RA_OF_ASC_NODE), KEYWORD(ARG_OF_PERICENTER),
+    KEYWORD(MEAN_ANOMALY), KEYWORD(NORAD_CAT_ID), KEYWORD(ELEMENT_SET_NO),
+    KEYWORD(REV_AT_EPOCH), KEYWORD(BSTAR), KEYWORD(MEAN_MOTION_DOT),
+    KEYWORD(MEAN_MOTION_DDOT)
+};
+
+#undef KEYWORD
+
+// Fields without which there is nothing to propagate
+static const OMM_FIELDS REQUIRED_FIELDS[] = {
+    OMM_EPOCH, OMM_MEAN_MOTION, OMM_ECCENTRICITY, OMM_INCLINATION,
+    OMM_RA_OF_ASC_NODE, OMM_ARG_OF_PERICENTER, OMM_MEAN_ANOMALY,
+    OMM_NORAD_CAT_ID
+};
+
+// Header keyword of a KVN message, it starts the next OMM
+static const char KVN_VERSION[] = "CCSDS_OMM_VERS";
+static const char KVN_COMMENT[] = "COMMENT";
+static const char XML_OMM[] = "omm";
+
+// Days before the first of each month in a common year
+static const int MONTH_DAYS[] = {
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+static bool IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static StringView Trim(const char *begin, const char *end) {
+    while (begin < end && IsBlank(*begin)) {
+        ++begin;
+    }
+    while (end > begin && IsBlank(end[-1])) {
+        --end;
+    }
+    return StringView(begin, end - begin);
+}
+
+static bool Equals(const StringView &value, const char *str) {
+    return strncmp(str, value.data, value.size) == 0
+            && str[value.size] == '\0';
+}
+
+static bool StartsWith(const char *begin, const char *end, const char *str) {
+    size_t size = strlen(str);
+    return (size_t)(end - begin) >= size && memcmp(begin, str, size) == 0;
+}
+
+/* First occurrence of str in [begin, end), end if there is none. */
+static const char* Find(const char *begin, const char *end, const char *str) {
+    size_t size = strlen(str);
+    while ((begin = static_cast<const char*>(memchr(begin, str[0],
+        end - begin)))) {
+        if ((size_t)(end - begin) < size) {
+            break;
+        }
+        if (memcmp(begin, str, size) == 0) {
+            return begin;
+        }
+        ++begin;
+    }
+    return end;
+}
+
+/* The count digits at begin as a number, false if one is no digit. */
+static bool ParseDigits(const char *begin, size_t count, int &value) {
+    value = 0;
+    for (size_t i = 0; i < count; ++i) {
+        unsigned digit = (unsigned char)begin[i] - '0';
+        if (digit >= 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+OMM_FIELDS FindOmmField(const StringView &keyword) {
+    for (int k = 0; k < MAX_OMM_FIELDS; ++k) {
+        const Keyword &field = FIELD_NAMES[k];
+        if (field.size == keyword.size
+                && memcmp(field.name, keyword.data, keyword.size) == 0) {
+            return (OMM_FIELDS)k;
+        }
+    }
+    return MAX_OMM_FIELDS;
+}
+
+bool ParseOmmEpoch(const StringView &epoch, int &year, double &day) {
+    const char *s = epoch.data;
+    size_t size = epoch.size;
+    if (size > 0 && s[size - 1] == 'Z') {
+        --size;
+    }
+    if (size < 8 || !ParseDigits(s, 4, year) || s[4] != '-') {
+        return false;
+    }
+
+    // Day of the year, or month and day
+    int yday, month, mday;
+    size_t time;
+    if (size == 8 || s[8] == 'T') {
+        if (!ParseDigits(s + 5, 3, yday) || yday < 1 || yday > 366) {
+            return false;
+        }
+        time = 8;
+    } else {
+        if (size < 10 || !ParseDigits(s + 5, 2, month) || s[7] != '-'
+                || !ParseDigits(s + 8, 2, mday) || month < 1 || month > 12
+                || mday < 1 || mday > 31) {
+            return false;
+        }
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        yday = MONTH_DAYS[month - 1] + mday + (leap && month > 2);
+        time = 10;
+    }
+
+    double seconds = 0;
+    if (time < size) {
+        int hour, minute;
+        if (size < time + 9 || s[time] != 'T'
+                || !ParseDigits(s + time + 1, 2, hour) || s[time + 3] != ':'
+                || !ParseDigits(s + time + 4, 2, minute)
+                || s[time + 6] != ':') {
+            return false;
+        }
+        seconds = hour * 3600 + minute * 60
+                + ParseDouble(s, time + 7, size - 1);
+    }
+    day = yday + seconds / SECDAY;
+    return true;
+}
+
+bool OmmCheck(const OmmFields &fields) {
+    for (OMM_FIELDS field : REQUIRED_FIELDS) {
+        if (fields[field].empty()) {
+            return false;
+        }
+    }
+    int year;
+    double day;
+    return ParseOmmEpoch(fields[OMM_EPOCH], year, day);
+}
+
+XmlPullParser::XmlPullParser(const char *data, size_t size) :
+        pos_(data),
+        end_(data + size) {
+}
+
+bool XmlPullParser::Next(EVENTS &event, StringView &value) {
+    if (empty_element_.data) {
+        event = END_ELEMENT;
+        value = empty_element_;
+        empty_element_ = StringView();
+        return true;
+    }
+    while (pos_ < end_) {
+        if (*pos_ != '<') {
+            const char *lt = static_cast<const char*>(memchr(pos_, '<',
+                end_ - pos_));
+            const char *begin = pos_;
+            pos_ = lt ? lt : end_;
+            if (!Trim(begin, pos_).empty()) {
+                event = TEXT;
+                value = StringView(begin, pos_ - begin);
+                return true;
+            }
+            continue;
+        }
+
+        if (StartsWith(pos_, end_, "<!--")) {
+            const char *close = Find(pos_ + 4, end_, "-->");
+            pos_ = close < end_ ? close + 3 : end_;
+            continue;
+        }
+        if (StartsWith(pos_, end_, "<![CDATA[")) {
+            const char *begin = pos_ + 9;
+            const char *close = Find(begin, end_, "]]>");
+            pos_ = close < end_ ? close + 3 : end_;
+            event = TEXT;
+            value = StringView(begin, close - begin);
+            return true;
+        }
+        if (StartsWith(pos_, end_, "<?") || StartsWith(pos_, end_, "<!")) {
+            const char *close = static_cast<const char*>(memchr(pos_, '>',
+                end_ - pos_));
+            pos_ = close ? close + 1 : end_;
+            continue;
+        }
+
+        bool end = StartsWith(pos_, end_, "</");
+        const char *name = pos_ + (end ? 2 : 1);
+        const char *p = name;
+        while (p < end_ && !IsBlank(*p) && *p != '/' && *p != '>') {
+            ++p;
+        }
+        StringView element(name, p - name);
+        // Attribute values may have a '>'
+        char quote = 0;
+        for (; p < end_ && (quote || *p != '>'); ++p) {
+            if (quote) {
+                quote = *p == quote ? 0 : quote;
+            } else if (*p == '"' || *p == '\'') {
+                quote = *p;
+            }
+        }
+        if (!end && p < end_ && p[-1] == '/') {
+            empty_element_ = element;
+        }
+        pos_ = p < end_ ? p + 1 : end_;
+        event = end ? END_ELEMENT : START_ELEMENT;
+        value = element;
+        return true;
+    }
+    return false;
+}
+
+OmmParser::OmmParser(const char *data, size_t size, OMM_FORMATS format) :
+        format_(format),
+        pos_(data),
+        end_(data + size),
+        xml_(data, size) {
+    if (format_ != OMM_CSV) {
+        return;
+    }
+    // Keywords of the columns
+    StringView header = NextLine();
+    const char *p = header.data;
+    const char *end = header.data + header.size;
+    while (p <= end && columns_ < MAX_COLUMNS) {
+        const char *comma = static_cast<const char*>(memchr(p, ',',
+            end - p));
+        const char *stop = comma ? comma : end;
+        StringView keyword = Trim(p, stop);
+        if (keyword.size >= 2 && keyword[0] == '"'
+                && keyword[keyword.size - 1] == '"') {
+            keyword = StringView(keyword.data + 1, keyword.size - 2);
+        }
+        column_[columns_++] = FindOmmField(keyword);
+        p = stop + 1;
+    }
+}
+
+OMM_FORMATS OmmParser::DetectFormat(const StringView &text) {
+    const char *p = text.data;
+    const char *end = text.data + text.size;
+    if (StartsWith(p, end, "\xEF\xBB\xBF")) {
+        p += 3;
+    }
+    while (p < end && IsBlank(*p)) {
+        ++p;
+    }
+    if (p < end && *p == '<') {
+        return OMM_XML;
+    }
+
+    const char *eol = static_cast<const char*>(memchr(p, '\n', end - p));
+    const char *line_end = eol ? eol : end;
+    if (StartsWith(p, line_end, KVN_VERSION)
+            || StartsWith(p, line_end, KVN_COMMENT)) {
+        return OMM_KVN;
+    }
+    const char *eq = static_cast<const char*>(memchr(p, '=',
+        line_end - p));
+    if (eq && FindOmmField(Trim(p, eq)) != MAX_OMM_FIELDS) {
+        return OMM_KVN;
+    }
+    // A header of keywords, one of them is enough
+    while (p < line_end) {
+        const char *comma = static_cast<const char*>(memchr(p, ',',
+            line_end - p));
+        if (!comma) {
+            break;
+        }
+        if (FindOmmField(Trim(p, comma)) != MAX_OMM_FIELDS) {
+            return OMM_CSV;
+        }
+        p = comma + 1;
+    }
+    return MAX_OMM_FORMATS;
+}
+
+StringView OmmParser::NextLine() {
+    const char *begin = pos_;
+    const char *end = static_cast<const char*>(memchr(pos_, '\n',
+        end_ - pos_));
+    if (end) {
+        pos_ = end + 1;
+    } else {
+        end = pos_ = end_;
+    }
+    if (end > begin && end[-1] == '\r') {
+        --end;
+    }
+    return StringView(begin, end - begin);
+}
+
+StringView OmmParser::DecodeName(const StringView &value) {
+    static const struct {
+        const char *entity;
+        char c;
+    } ENTITIES[] = {
+        {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'},
+        {"&apos;", '\''}
+    };
+    const char *p = value.data;
+    const char *end = value.data + value.size;
+    size_t length = 0;
+    while (p < end && length < NAME_SIZE) {
+        char c = *p++;
+        if (c == '&') {
+            for (const auto &e : ENTITIES) {
+                if (StartsWith(p - 1, end, e.entity)) {
+                    c = e.c;
+                    p += strlen(e.entity) - 1;
+                    break;
+                }
+            }
+        }
+        name_[length++] = c;
+    }
+    return StringView(name_, length);
+}
+
+bool OmmParser::Next(OmmFields &fields) {
+    fields = OmmFields();
+    switch (format_) {
+        case OMM_CSV:
+            return NextCsv(fields);
+        case OMM_KVN:
+            return NextKvn(fields);
+        case OMM_XML:
+            return NextXml(fields);
+        default:
+            return false;
+    }
+}
+
+bool OmmParser::NextCsv(OmmFields &fields) {
+    while (pos_ < end_) {
+        StringView line = NextLine();
+        const char *p = line.data;
+        const char *end = line.data + line.size;
+        if (Trim(p, end).empty()) {
+            continue;
+        }
+        // One pass over the line, quoted values may have commas
+        for (size_t k = 0; k < columns_ && p <= end; ++k) {
+            const char *begin = p;
+            const char *stop;
+            while (begin < end && *begin == ' ') {
+                ++begin;
+            }
+            if (begin < end && *begin == '"') {
+                ++begin;
+                const char *quote = static_cast<const char*>(memchr(begin,
+                    '"', end - begin));
+                stop = quote ? quote : end;
+                const char *comma = static_cast<const char*>(memchr(stop,
+                    ',', end - stop));
+                p = comma ? comma + 1 : end + 1;
+            } else {
+                const char *comma = static_cast<const char*>(memchr(begin,
+                    ',', end - begin));
+                stop = comma ? comma : end;
+                p = stop + 1;
+            }
+            if (column_[k] != MAX_OMM_FIELDS) {
+                fields.value[column_[k]] = Trim(begin, stop);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+bool OmmParser::NextKvn(OmmFields &fields) {
+    bool found = false;
+    unsigned seen = 0;
+    while (pos_ < end_) {
+        const char *line_start = pos_;
+        StringView line = NextLine();
+        const char *end = line.data + line.size;
+        const char *eq = static_cast<const char*>(memchr(line.data, '=',
+            line.size));
+        if (!eq) {
+            continue;
+        }
+        StringView keyword = Trim(line.data, eq);
+        OMM_FIELDS field = FindOmmField(keyword);
+        bool next = Equals(keyword, KVN_VERSION)
+                || (field != MAX_OMM_FIELDS && (seen & 1u << field));
+        if (next && found) {
+            // The line belongs to the next OMM
+            pos_ = line_start;
+            return true;
+        }
+        if (field == MAX_OMM_FIELDS) {
+            continue;
+        }
+        // Units in brackets after the value
+        StringView value = Trim(eq + 1, end);
+        if (value.size > 0 && value[value.size - 1] == ']') {
+            const char *bracket = static_cast<const char*>(memchr(value.data,
+                '[', value.size));
+            if (bracket) {
+                value = Trim(value.data, bracket);
+            }
+        }
+        fields.value[field] = value;
+        seen |= 1u << field;
+        found = true;
+    }
+    return found;
+}
+
+bool OmmParser::NextXml(OmmFields &fields) {
+    bool found = false;
+    OMM_FIELDS field = MAX_OMM_FIELDS;
+    XmlPullParser::EVENTS event;
+    StringView value;
+    while (xml_.Next(event, value)) {
+        switch (event) {
+            case XmlPullParser::START_ELEMENT:
+                field = FindOmmField(value);
+                break;
+            case XmlPullParser::TEXT:
+                if (field == MAX_OMM_FIELDS) {
+                    break;
+                }
+                value = Trim(value.data, value.data + value.size);
+                if (field == OMM_OBJECT_NAME
+                        && memchr(value.data, '&', value.size)) {
+                    value = DecodeName(value);
+                }
+                fields.value[field] = value;
+                found = true;
+                break;
+            case XmlPullParser::END_ELEMENT:
+                field = MAX_OMM_FIELDS;
+                if (found && Equals(value, XML_OMM)) {
+                    return true;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return found;
+}
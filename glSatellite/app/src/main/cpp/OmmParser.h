@@ -0,0 +1,121 @@
+#pragma once
+
+#include "StringView.h"
+
+// Text formats of CCSDS Orbit Mean-Elements Messages
+enum OMM_FORMATS {
+    OMM_CSV,
+    OMM_KVN,
+    OMM_XML,
+    MAX_OMM_FORMATS
+};
+
+// Keywords of an OMM the element records are made of
+enum OMM_FIELDS {
+    OMM_OBJECT_NAME,
+    OMM_OBJECT_ID,
+    OMM_EPOCH,
+    OMM_MEAN_MOTION,
+    OMM_ECCENTRICITY,
+    OMM_INCLINATION,
+    OMM_RA_OF_ASC_NODE,
+    OMM_ARG_OF_PERICENTER,
+    OMM_MEAN_ANOMALY,
+    OMM_NORAD_CAT_ID,
+    OMM_ELEMENT_SET_NO,
+    OMM_REV_AT_EPOCH,
+    OMM_BSTAR,
+    OMM_MEAN_MOTION_DOT,
+    OMM_MEAN_MOTION_DDOT,
+    MAX_OMM_FIELDS
+};
+
+/*
+ * Values of one OMM, trimmed views into the parsed buffer. Missing
+ * fields are empty.
+ */
+struct OmmFields {
+    StringView value[MAX_OMM_FIELDS];
+
+    const StringView& operator[](OMM_FIELDS field) const {
+        return value[field];
+    }
+};
+
+/*
+ * Pull parser of the XML subset OMM files use: elements with attributes,
+ * text, comments, processing instructions and CDATA. Nothing is copied
+ * or checked, the names and texts are views into the buffer.
+ */
+class XmlPullParser {
+    const char *pos_;
+    const char *end_;
+    // End of an empty element, reported by the next call
+    StringView empty_element_;
+public:
+    enum EVENTS {
+        START_ELEMENT,
+        END_ELEMENT,
+        TEXT,
+        MAX_EVENTS
+    };
+
+    XmlPullParser(const char *data, size_t size);
+
+    // Next event with the element name or the text, which is not
+    // trimmed. Text of only white space is skipped. False at the end
+    // of the buffer.
+    bool Next(EVENTS &event, StringView &value);
+};
+
+/*
+ * Walks the OMMs of a contiguous buffer in any of the formats, detected
+ * from its start. Like TleParser nothing is copied: the values are views
+ * into the buffer, only names with XML entities are decoded into the
+ * parser, valid until the next record. CSV has one OMM per line with
+ * the keywords in the first line, KVN one "KEYWORD = value" per line
+ * where a keyword seen before starts the next OMM, and XML one <omm>
+ * element per OMM.
+ */
+class OmmParser {
+    // Columns of a CSV line, the rest is ignored
+    static const size_t MAX_COLUMNS = 64;
+    static const size_t NAME_SIZE = 64;
+
+    OMM_FORMATS format_;
+    const char *pos_;
+    const char *end_;
+    // Field of every CSV column, MAX_OMM_FIELDS if it is not used
+    OMM_FIELDS column_[MAX_COLUMNS];
+    size_t columns_ = 0;
+    XmlPullParser xml_;
+    char name_[NAME_SIZE];
+
+    StringView NextLine();
+    // The name with the XML entities replaced, in name_
+    StringView DecodeName(const StringView &value);
+    bool NextCsv(OmmFields &fields);
+    bool NextKvn(OmmFields &fields);
+    bool NextXml(OmmFields &fields);
+public:
+    // The format must not be MAX_OMM_FORMATS
+    OmmParser(const char *data, size_t size, OMM_FORMATS format);
+
+    // Format of the text, MAX_OMM_FORMATS if it is no OMM (a TLE)
+    static OMM_FORMATS DetectFormat(const StringView &text);
+
+    // Next OMM, false at the end of the buffer
+    bool Next(OmmFields &fields);
+};
+
+// Keyword of the field, MAX_OMM_FIELDS if none
+OMM_FIELDS FindOmmField(const StringView &keyword);
+
+// Epoch of an OMM, "YYYY-MM-DDThh:mm:ss.s" or "YYYY-DDDThh:mm:ss.s",
+// as a year and day of the year with its fraction, 1.0 at the start of
+// January 1. False if it is not a valid epoch.
+bool ParseOmmEpoch(const StringView &epoch, int &year, double &day);
+
+// True if the OMM has the epoch, the mean elements and the catalog
+// number the propagator needs, the counterpart of KepCheck()
+bool OmmCheck(const OmmFields &fields);
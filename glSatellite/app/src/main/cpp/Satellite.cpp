@@ -1,30 +1,50 @@
-#include <cstdlib>
+#include <cctype>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
-#include <functional>
 
 #include <sys/time.h>
 
+#include "OmmParser.h"
 #include "Satellite.h"
-#include "SatelliteCalc.h"
+#include "TleParser.h"
 
 using namespace std;
 
-/* Return a substring based on the starting and ending positions provided. */
-static string SubString(const string &value, size_t start, size_t end) {
-    string str = value.substr(start, end - start + 1);
-    str.erase(remove_if(str.begin(), str.end(), ref(isspace)),
-        str.end());
-    return str;
+static bool IsSpace(char c) {
+    return isspace((unsigned char)c);
 }
 
-/* Trim spaces from end */
-static inline string RTrim(const string &s) {
-    string result(s);
-    result.erase(
-        find_if(result.rbegin(), result.rend(),
-            not1(ref(isspace))).base(), result.end());
-    return result;
+/* Copy the columns [start, end] of a line without spaces to a C string. */
+static void CopyField(const char *line, size_t start, size_t end, char *str,
+    size_t size) {
+    size_t length = 0;
+    for (size_t i = start; i <= end && length < size - 1; ++i) {
+        if (!IsSpace(line[i])) {
+            str[length++] = line[i];
+        }
+    }
+    str[length] = '\0';
+}
+
+/* Copy a string without the spaces at its end to a C string. */
+static void CopyRTrim(const StringView &value, char *str, size_t size) {
+    size_t length = value.size;
+    while (length > 0 && IsSpace(value[length - 1])) {
+        --length;
+    }
+    length = min(length, size - 1);
+    copy(value.data, value.data + length, str);
+    str[length] = '\0';
+}
+
+/* Number of an OMM field, 0 if it is missing. */
+static long FieldLong(const StringView &value) {
+    return value.empty() ? 0 : ParseLong(value.data, 0, value.size - 1);
+}
+
+static double FieldDouble(const StringView &value) {
+    return value.empty() ? 0 : ParseDouble(value.data, 0, value.size - 1);
 }
 
 /* Calculate the day number from m/d/y. */
@@ -46,31 +66,64 @@ static long DayNum(int m, int d, int y) {
     return dn;
 }
 
+Satellite::Satellite(const StringView& name, const char *line1,
+    const char *line2) {
+    /* Updates data in TLE structure based on
+     line1 and line2, fields are decoded in place. */
+
+    CopyRTrim(name, name_, NAME_SIZE);
+    catnum_ = ParseLong(line1, 2, 6);
+    CopyField(line1, 9, 16, designator_, DESIGNATOR_SIZE);
+    year_ = ParseLong(line1, 18, 19);
+    refepoch_ = ParseDouble(line1, 20, 31);
+    double tempnum = 1.0e-5 * ParseDouble(line1, 44, 49);
+    nddot6_ = tempnum / Pow10(line1[51] - '0');
+    tempnum = 1.0e-5 * ParseDouble(line1, 53, 58);
+    bstar_ = tempnum / Pow10(line1[60] - '0');
+    setnum_ = ParseLong(line1, 64, 67);
+    incl_ = ParseDouble(line2, 8, 15);
+    raan_ = ParseDouble(line2, 17, 24);
+    eccn_ = 1.0e-07 * ParseDouble(line2, 26, 32);
+    argper_ = ParseDouble(line2, 34, 41);
+    meanan_ = ParseDouble(line2, 43, 50);
+    meanmo_ = ParseDouble(line2, 52, 62);
+    drag_ = ParseDouble(line1, 33, 42);
+    orbitnum_ = ParseLong(line2, 63, 67);
+}
+
 Satellite::Satellite(const string& name, const string& line1,
     const string& line2) :
-            name_(RTrim(name)),
-            line1_(line1),
-            line2_(line2) {
-    /* Updates data in TLE structure based on
-     line1 and line2 stored in structure. */
-
-    catnum_ = atoi(SubString(line1, 2, 6).c_str());
-    designator_ = SubString(line1, 9, 16);
-    year_ = atoi(SubString(line1, 18, 19).c_str());
-    refepoch_ = atof(SubString(line1, 20, 31).c_str());
-    double tempnum = 1.0e-5 * atof(SubString(line1, 44, 49).c_str());
-    nddot6_ = tempnum / pow(10.0, (line1[51] - '0'));
-    tempnum = 1.0e-5 * atof(SubString(line1, 53, 58).c_str());
-    bstar_ = tempnum / pow(10.0, (line1[60] - '0'));
-    setnum_ = atol(SubString(line1, 64, 67).c_str());
-    incl_ = atof(SubString(line2, 8, 15).c_str());
-    raan_ = atof(SubString(line2, 17, 24).c_str());
-    eccn_ = 1.0e-07 * atof(SubString(line2, 26, 32).c_str());
-    argper_ = atof(SubString(line2, 34, 41).c_str());
-    meanan_ = atof(SubString(line2, 43, 50).c_str());
-    meanmo_ = atof(SubString(line2, 52, 62).c_str());
-    drag_ = atof(SubString(line1, 33, 42).c_str());
-    orbitnum_ = atof(SubString(line2, 63, 67).c_str());
+        Satellite(StringView(name), line1.c_str(), line2.c_str()) {
+}
+
+Satellite::Satellite(const OmmFields& fields) {
+    CopyRTrim(fields[OMM_OBJECT_NAME], name_, NAME_SIZE);
+    catnum_ = FieldLong(fields[OMM_NORAD_CAT_ID]);
+    // International designator "1998-067A" as in the TLE, "98067A"
+    const StringView &id = fields[OMM_OBJECT_ID];
+    if (id.size > 5 && id[4] == '-') {
+        CopyField(id.data, 2, id.size - 1, designator_, DESIGNATOR_SIZE);
+        memmove(designator_ + 2, designator_ + 3, DESIGNATOR_SIZE - 3);
+    } else {
+        CopyRTrim(id, designator_, DESIGNATOR_SIZE);
+    }
+    int year = 0;
+    refepoch_ = 0;
+    ParseOmmEpoch(fields[OMM_EPOCH], year, refepoch_);
+    year_ = year % 100;
+    // Same units as the TLE: the derivatives of the mean motion are
+    // divided by 2 and 6 already
+    drag_ = FieldDouble(fields[OMM_MEAN_MOTION_DOT]);
+    nddot6_ = FieldDouble(fields[OMM_MEAN_MOTION_DDOT]);
+    bstar_ = FieldDouble(fields[OMM_BSTAR]);
+    setnum_ = FieldLong(fields[OMM_ELEMENT_SET_NO]);
+    incl_ = FieldDouble(fields[OMM_INCLINATION]);
+    raan_ = FieldDouble(fields[OMM_RA_OF_ASC_NODE]);
+    eccn_ = FieldDouble(fields[OMM_ECCENTRICITY]);
+    argper_ = FieldDouble(fields[OMM_ARG_OF_PERICENTER]);
+    meanan_ = FieldDouble(fields[OMM_MEAN_ANOMALY]);
+    meanmo_ = FieldDouble(fields[OMM_MEAN_MOTION]);
+    orbitnum_ = FieldLong(fields[OMM_REV_AT_EPOCH]);
 }
 
 double CurrentDaynum() {
@@ -88,26 +141,20 @@ double CurrentDaynum() {
     return 0;
 }
 
-void Satellite::UpdatePosition() {
-    SatelliteCalc calc(*this);
-    calc.Calc(CurrentDaynum());
-    calc.Update(*this);
-}
-
-double Satellite::GetLatitude() {
-    return sat_lat;
-}
-
-double Satellite::GetLongitude() {
-    return sat_lon - 360.f;
+bool Satellite::IsDecayed() {
+    return IsDecayed(CurrentDaynum());
 }
 
-double Satellite::GetAltitude() {
-    return sat_alt;
+bool Satellite::IsDecayed(double daynum) const {
+    double satepoch = DayNum(1, 0, year_) + refepoch_;
+    return satepoch + (16.666666 - meanmo_) / (10.0 * fabs(drag_)) < daynum;
 }
 
-bool Satellite::IsDecayed() {
-    double satepoch = DayNum(1, 0, year_) + refepoch_;
-    double dn = CurrentDaynum();
-    return satepoch + (16.666666 - meanmo_) / (10.0 * fabs(drag_)) < dn;
+bool Satellite::SameElements(const Satellite& other) const {
+    return year_ == other.year_ && refepoch_ == other.refepoch_
+            && incl_ == other.incl_ && raan_ == other.raan_
+            && eccn_ == other.eccn_ && argper_ == other.argper_
+            && meanan_ == other.meanan_ && meanmo_ == other.meanmo_
+            && drag_ == other.drag_ && nddot6_ == other.nddot6_
+            && bstar_ == other.bstar_;
 }
@@ -4,17 +4,36 @@
 #include <vector>
 
 #include "IFileReader.h"
+#include "StringView.h"
 
+/* Return the number of days since 31Dec79 00:00:00 UTC (daynum 0). */
+double CurrentDaynum();
+
+// Calculated position of a satellite
+struct SatellitePosition {
+    // Degrees, longitude in [-360, 0)
+    float latitude, longitude;
+    // km and km/sec
+    float altitude, velocity;
+};
+
+struct OmmFields;
+
+/*
+ * Elements of one TLE, decoded in place from the fixed columns of the
+ * lines, or of one OMM. The record has no heap allocations.
+ */
 class Satellite {
     friend class SatelliteCalc;
 
-    // Original unmodified data
-    std::string name_;
-    std::string line1_;
-    std::string line2_;
+    // Room for the 24 characters of the name line and some extra
+    static const size_t NAME_SIZE = 32;
+    static const size_t DESIGNATOR_SIZE = 9;
+
+    char name_[NAME_SIZE];
     int catnum_;
     long setnum_;
-    std::string designator_;
+    char designator_[DESIGNATOR_SIZE];
     int year_;
     double refepoch_;
     double incl_;
@@ -27,18 +46,21 @@ class Satellite {
     double nddot6_;
     double bstar_;
     long orbitnum_;
-
-    // Calculated values
-    double sat_lat, sat_lon, sat_alt;
 public:
+    // The lines must have at least TLE_LINE_LENGTH characters,
+    // the name is trimmed
+    Satellite(const StringView& name, const char *line1, const char *line2);
     Satellite(const std::string& name, const std::string& line1,
         const std::string& line2);
+    // The fields must pass OmmCheck(). The same elements as the TLE of
+    // the OMM, the epoch may differ in the last digits.
+    explicit Satellite(const OmmFields& fields);
 
     bool IsDecayed();
-    void UpdatePosition();
-    double GetLatitude();
-    double GetLongitude();
-    double GetAltitude();
+    // Same at the given time, days since 31Dec79 00:00:00 UTC
+    bool IsDecayed(double daynum) const;
+    // Same elements for the propagator, the name and numbers may differ
+    bool SameElements(const Satellite& other) const;
     std::string GetName() const {
         return name_;
     }
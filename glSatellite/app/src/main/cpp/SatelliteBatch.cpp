@@ -0,0 +1,332 @@
+#include <algorithm>
+
+#include "SatelliteBatch.h"
+#include "SatelliteConst.h"
+#include "Simd.h"
+
+using namespace std;
+using namespace simd;
+
+// ----------------------------------------------------------------------------
+// Extended math functions on packed vectors, see SatelliteCalc.cpp
+// ----------------------------------------------------------------------------
+
+static vdouble AcTan(vdouble sinx, vdouble cosx) {
+    // Four-quadrant arctan function
+    vdouble a = Atan(sinx / cosx);
+    vdouble ret = Select(cosx > 0.0, Select(sinx > 0.0, a, a + TWOPI),
+        a + M_PI);
+    vdouble zero = Select(sinx > 0.0, PIO2, X3PIO2);
+    return Select(cosx == 0.0, zero, ret);
+}
+
+static vdouble FMod2p(vdouble x) {
+    // Returns mod 2PI of argument
+    return x - TWOPI * Floor(x * (1 / TWOPI));
+}
+
+// ----------------------------------------------------------------------------
+// Class methods
+// ----------------------------------------------------------------------------
+
+SGP4Batch::SGP4Batch(REGIMES regime) :
+        regime_(regime),
+        columns_(regime == NEAR_EARTH_SIMPLE ? C5 : MAX_COLUMNS) {
+}
+
+void SGP4Batch::Clear() {
+    for (size_t i = 0; i < MAX_COLUMNS; ++i) {
+        column_[i].clear();
+    }
+    for (size_t i = 0; i < MAX_STATE; ++i) {
+        state_[i].clear();
+    }
+    index_.clear();
+}
+
+void SGP4Batch::Add(size_t index, const SatelliteCalc& calc) {
+    // Drops the padding, the new satellite takes the first lane of it
+    size_t num = index_.size();
+    for (size_t i = 0; i < columns_; ++i) {
+        column_[i].resize(num + 1);
+    }
+    index_.push_back(index);
+    Store(num, calc);
+    Pad();
+}
+
+void SGP4Batch::Set(size_t num, size_t index, const SatelliteCalc& calc) {
+    index_[num] = index;
+    Store(num, calc);
+}
+
+void SGP4Batch::Remove(size_t num) {
+    size_t last = index_.size() - 1;
+    for (size_t i = 0; i < columns_; ++i) {
+        column_[i][num] = column_[i][last];
+        column_[i].resize(last);
+    }
+    index_[num] = index_[last];
+    index_.pop_back();
+    if (index_.empty()) {
+        Clear();
+    } else {
+        Pad();
+    }
+}
+
+void SGP4Batch::Store(size_t num, const SatelliteCalc& calc) {
+    const NearEarthPropagator &sgp4 = *calc.near_earth_;
+    column_[EPOCH][num] = calc.JulianEpoch();
+    column_[XMO][num] = sgp4.tle_xmo;
+    column_[OMEGAO][num] = sgp4.tle_omegao;
+    column_[XNODEO][num] = sgp4.tle_xnodeo;
+    column_[XINCL][num] = sgp4.tle_xincl;
+    column_[EO][num] = sgp4.tle_eo;
+    column_[BSTAR][num] = sgp4.tle_bstar;
+    column_[AODP][num] = sgp4.aodp;
+    column_[AYCOF][num] = sgp4.aycof;
+    column_[C1][num] = sgp4.c1;
+    column_[C4][num] = sgp4.c4;
+    column_[COSIO][num] = sgp4.cosio;
+    column_[SINIO][num] = sgp4.sinio;
+    column_[OMGDOT][num] = sgp4.omgdot;
+    column_[XNODP][num] = sgp4.xnodp;
+    column_[T2COF][num] = sgp4.t2cof;
+    column_[X1MTH2][num] = sgp4.x1mth2;
+    column_[X3THM1][num] = sgp4.x3thm1;
+    column_[X7THM1][num] = sgp4.x7thm1;
+    column_[XMDOT][num] = sgp4.xmdot;
+    column_[XNODCF][num] = sgp4.xnodcf;
+    column_[XNODOT][num] = sgp4.xnodot;
+    column_[XLCOF][num] = sgp4.xlcof;
+
+    if (regime_ == NEAR_EARTH) {
+        column_[C5][num] = sgp4.c5;
+        column_[D2][num] = sgp4.d2;
+        column_[D3][num] = sgp4.d3;
+        column_[D4][num] = sgp4.d4;
+        column_[DELMO][num] = sgp4.delmo;
+        column_[OMGCOF][num] = sgp4.omgcof;
+        column_[ETA][num] = sgp4.eta;
+        column_[SINMO][num] = sgp4.sinmo;
+        column_[T3COF][num] = sgp4.t3cof;
+        column_[T4COF][num] = sgp4.t4cof;
+        column_[T5COF][num] = sgp4.t5cof;
+        column_[XMCOF][num] = sgp4.xmcof;
+    }
+}
+
+void SGP4Batch::Pad() {
+    // Fill the last vector with copies of the first satellite,
+    // so the padding lanes never produce NaNs or denormals
+    size_t num = index_.size();
+    size_t padded = (num + vdouble::WIDTH - 1) / vdouble::WIDTH
+            * vdouble::WIDTH;
+    for (size_t i = 0; i < columns_; ++i) {
+        column_[i].resize(padded, column_[i][0]);
+    }
+    for (size_t i = 0; i < MAX_STATE; ++i) {
+        state_[i].resize(padded);
+    }
+}
+
+void SGP4Batch::Propagate(const PropagationContext& context) {
+    Propagate(context, 0, index_.size());
+}
+
+void SGP4Batch::Propagate(const PropagationContext& context, size_t begin,
+    size_t end) {
+    if (regime_ == NEAR_EARTH_SIMPLE) {
+        Kernel<NEAR_EARTH_SIMPLE>(context, begin, end);
+    } else {
+        Kernel<NEAR_EARTH>(context, begin, end);
+    }
+}
+
+template<REGIMES REGIME>
+void SGP4Batch::Kernel(const PropagationContext& context, size_t begin,
+    size_t end) {
+    // Vectorized version of NearEarthPropagator::Propagate
+    // Whole vectors only, the last one includes the padding lanes
+    end = min((end + vdouble::WIDTH - 1) / vdouble::WIDTH * vdouble::WIDTH,
+        column_[EPOCH].size());
+
+    for (size_t n = begin; n < end; n += vdouble::WIDTH) {
+#define COL(var, name) vdouble var = vdouble::Load(&column_[name][n])
+        COL(epoch, EPOCH);
+        COL(xmo, XMO);
+        COL(omegao, OMEGAO);
+        COL(xnodeo, XNODEO);
+        COL(xincl, XINCL);
+        COL(eo, EO);
+        COL(bstar, BSTAR);
+        COL(aodp, AODP);
+        COL(aycof, AYCOF);
+        COL(c1, C1);
+        COL(c4, C4);
+        COL(cosio, COSIO);
+        COL(sinio, SINIO);
+        COL(omgdot, OMGDOT);
+        COL(xnodp, XNODP);
+        COL(t2cof, T2COF);
+        COL(x1mth2, X1MTH2);
+        COL(x3thm1, X3THM1);
+        COL(x7thm1, X7THM1);
+        COL(xmdot, XMDOT);
+        COL(xnodcf, XNODCF);
+        COL(xnodot, XNODOT);
+        COL(xlcof, XLCOF);
+
+        vdouble tsince = (vdouble(context.jul_utc) - epoch) * MINDAY;
+
+        // Update for secular gravity and atmospheric drag.
+        vdouble xmdf = xmo + xmdot * tsince;
+        vdouble omgadf = omegao + omgdot * tsince;
+        vdouble xnoddf = xnodeo + xnodot * tsince;
+        vdouble tsq = tsince * tsince;
+        vdouble xnode = xnoddf + xnodcf * tsq;
+        vdouble tempa = 1.0 - c1 * tsince;
+        vdouble tempe = bstar * c4 * tsince;
+        vdouble templ = t2cof * tsq;
+        vdouble xmp = xmdf;
+        vdouble omega = omgadf;
+
+        if (REGIME != NEAR_EARTH_SIMPLE) {
+            COL(c5, C5);
+            COL(d2, D2);
+            COL(d3, D3);
+            COL(d4, D4);
+            COL(delmo, DELMO);
+            COL(omgcof, OMGCOF);
+            COL(eta, ETA);
+            COL(sinmo, SINMO);
+            COL(t3cof, T3COF);
+            COL(t4cof, T4COF);
+            COL(t5cof, T5COF);
+            COL(xmcof, XMCOF);
+
+            vdouble sin_xmdf, cos_xmdf;
+            SinCos(xmdf, sin_xmdf, cos_xmdf);
+            vdouble delomg = omgcof * tsince;
+            vdouble delm_base = 1.0 + eta * cos_xmdf;
+            vdouble delm = xmcof * (delm_base * delm_base * delm_base - delmo);
+            vdouble temp = delomg + delm;
+            xmp = xmdf + temp;
+            omega = omgadf - temp;
+            vdouble tcube = tsq * tsince;
+            vdouble tfour = tsince * tcube;
+            tempa = tempa - d2 * tsq - d3 * tcube - d4 * tfour;
+            vdouble sin_xmp, cos_xmp;
+            SinCos(xmp, sin_xmp, cos_xmp);
+            tempe = tempe + bstar * c5 * (sin_xmp - sinmo);
+            templ = templ + t3cof * tcube + tfour * (t4cof + tsince * t5cof);
+        }
+#undef COL
+
+        vdouble a = aodp * tempa * tempa;
+        vdouble e = eo - tempe;
+        vdouble xl = xmp + omega + xnode + xnodp * templ;
+        vdouble beta = Sqrt(1.0 - e * e);
+        vdouble xn = XKE / (a * Sqrt(a));
+
+        // Long period periodics
+        vdouble sin_omega, cos_omega;
+        SinCos(omega, sin_omega, cos_omega);
+        vdouble axn = e * cos_omega;
+        vdouble temp = 1.0 / (a * beta * beta);
+        vdouble xll = temp * xlcof * axn;
+        vdouble aynl = temp * aycof;
+        vdouble xlt = xl + xll;
+        vdouble ayn = e * sin_omega + aynl;
+
+        // Solve Kepler's Equation, lanes are frozen once converged
+        vdouble capu = FMod2p(xlt - xnode);
+        vdouble temp2 = capu;
+        vdouble sinepw = 0.0, cosepw = 0.0;
+        vdouble temp3 = 0.0, temp4 = 0.0, temp5 = 0.0, temp6 = 0.0;
+        vmask active = vdouble(0.0) == 0.0;
+
+        for (int i = 0; i <= 10 && Any(active); ++i) {
+            vdouble s, c;
+            SinCos(temp2, s, c);
+            vdouble t3 = axn * s;
+            vdouble t4 = ayn * c;
+            vdouble t5 = axn * c;
+            vdouble t6 = ayn * s;
+            vdouble epw = (capu - t4 + t3 - temp2) / (1.0 - t5 - t6) + temp2;
+
+            sinepw = Select(active, s, sinepw);
+            cosepw = Select(active, c, cosepw);
+            temp3 = Select(active, t3, temp3);
+            temp4 = Select(active, t4, temp4);
+            temp5 = Select(active, t5, temp5);
+            temp6 = Select(active, t6, temp6);
+
+            active = AndNot(active, Abs(epw - temp2) <= E6A);
+            temp2 = Select(active, epw, temp2);
+        }
+
+        // Short period preliminary quantities
+        vdouble ecose = temp5 + temp6;
+        vdouble esine = temp3 - temp4;
+        vdouble elsq = axn * axn + ayn * ayn;
+        temp = 1.0 - elsq;
+        vdouble pl = a * temp;
+        vdouble r = a * (1.0 - ecose);
+        vdouble temp1 = 1.0 / r;
+        vdouble rdot = XKE * Sqrt(a) * esine * temp1;
+        vdouble rfdot = XKE * Sqrt(pl) * temp1;
+        temp2 = a * temp1;
+        vdouble betal = Sqrt(temp);
+        temp3 = 1.0 / (1.0 + betal);
+        vdouble cosu = temp2 * (cosepw - axn + ayn * esine * temp3);
+        vdouble sinu = temp2 * (sinepw - ayn - axn * esine * temp3);
+        vdouble u = AcTan(sinu, cosu);
+        vdouble sin2u = 2.0 * sinu * cosu;
+        vdouble cos2u = 2.0 * cosu * cosu - 1.0;
+        temp = 1.0 / pl;
+        temp1 = CK2 * temp;
+        temp2 = temp1 * temp;
+
+        // Update for short periodics
+        vdouble rk = r * (1.0 - 1.5 * temp2 * betal * x3thm1)
+                + 0.5 * temp1 * x1mth2 * cos2u;
+        vdouble uk = u - 0.25 * temp2 * x7thm1 * sin2u;
+        vdouble xnodek = xnode + 1.5 * temp2 * cosio * sin2u;
+        vdouble xinck = xincl + 1.5 * temp2 * cosio * sinio * cos2u;
+        vdouble rdotk = rdot - xn * temp1 * x1mth2 * sin2u;
+        vdouble rfdotk = rfdot + xn * temp1 * (x1mth2 * cos2u + 1.5 * x3thm1);
+
+        // Orientation vectors
+        vdouble sinuk, cosuk, sinik, cosik, sinnok, cosnok;
+        SinCos(uk, sinuk, cosuk);
+        SinCos(xinck, sinik, cosik);
+        SinCos(xnodek, sinnok, cosnok);
+        vdouble xmx = -sinnok * cosik;
+        vdouble xmy = cosnok * cosik;
+        vdouble ux = xmx * sinuk + cosnok * cosuk;
+        vdouble uy = xmy * sinuk + sinnok * cosuk;
+        vdouble uz = sinik * sinuk;
+        vdouble vx = xmx * cosuk - cosnok * sinuk;
+        vdouble vy = xmy * cosuk - sinnok * sinuk;
+        vdouble vz = sinik * cosuk;
+
+        // Position and velocity
+        (rk * ux).Store(&state_[POS_X][n]);
+        (rk * uy).Store(&state_[POS_Y][n]);
+        (rk * uz).Store(&state_[POS_Z][n]);
+        (rdotk * ux + rfdotk * vx).Store(&state_[VEL_X][n]);
+        (rdotk * uy + rfdotk * vy).Store(&state_[VEL_Y][n]);
+        (rdotk * uz + rfdotk * vz).Store(&state_[VEL_Z][n]);
+    }
+}
+
+void SGP4Batch::GetState(size_t num, vector_t &pos, vector_t &vel) const {
+    pos.x = state_[POS_X][num];
+    pos.y = state_[POS_Y][num];
+    pos.z = state_[POS_Z][num];
+    vel.x = state_[VEL_X][num];
+    vel.y = state_[VEL_Y][num];
+    vel.z = state_[VEL_Z][num];
+}
@@ -1,73 +1,16 @@
+#include "Geodetic.h"
 #include "SatelliteCalc.h"
-
-// ----------------------------------------------------------------------------
-// Constants used by SGP4/SDP4
-// ----------------------------------------------------------------------------
-
-const double DEG2RAD = 1.745329251994330E-2; // Degrees to radians
-const double PIO2 = M_PI / 2; // Pi/2
-const double X3PIO2 = 3 * M_PI / 2; // 3*Pi/2
-const double TWOPI = 2 * M_PI; // 2*Pi
-const double E6A = 1.0E-6;
-const double TOTHRD = 2.0 / 3; // 2/3
-const double XJ3 = -2.53881E-6; // J3 Harmonic (WGS '72)
-const double XKE = 7.43669161E-2;
-const double XKMPER = 6.378137E3; // WGS 84 Earth radius km
-const double SECDAY = 8.6400E4; // Seconds per day
-const double MINDAY = 1.44E3; // Minutes per day
-const double AE = 1.0;
-const double CK2 = 5.413079E-4;
-const double CK4 = 6.209887E-7;
-const double FF = 3.35281066474748E-3; // Flattening factor
-const double S4_INIT = 1.012229;
-const double QOMS2T = 1.880279E-09;
-const double OMEGA_E = 1.00273790934; // Earth rotations/siderial day
-const double ZNS = 1.19459E-5;
-const double C1SS = 2.9864797E-6;
-const double ZES = 1.675E-2;
-const double ZNL = 1.5835218E-4;
-const double C1L = 4.7968065E-7;
-const double ZEL = 5.490E-2;
-const double ZCOSIS = 9.1744867E-1;
-const double ZSINIS = 3.9785416E-1;
-const double ZSINGS = -9.8088458E-1;
-const double ZCOSGS = 1.945905E-1;
-const double Q22 = 1.7891679E-6;
-const double Q31 = 2.1460748E-6;
-const double Q33 = 2.2123015E-7;
-const double G22 = 5.7686396;
-const double G32 = 9.5240898E-1;
-const double G44 = 1.8014998;
-const double G52 = 1.0508330;
-const double G54 = 4.4108898;
-const double ROOT22 = 1.7891679E-6;
-const double ROOT32 = 3.7393792E-7;
-const double ROOT44 = 7.3636953E-9;
-const double ROOT52 = 1.1428639E-7;
-const double ROOT54 = 2.1765803E-9;
-const double THDT = 4.3752691E-3;
-
-// Stages of deep-space calculations
-enum {
-    DPINIT, // Deep-space initialization code
-    DPSEC, // Deep-space secular code
-    DPPER // Deep-space periodic code
-};
+#include "SatelliteConst.h"
 
 // Geodetic position structure
 typedef struct {
-    double lat, lon, alt, theta;
+    double lat, lon, alt;
 } geodetic_t;
 
 // ----------------------------------------------------------------------------
 // Extended math functions
 // ----------------------------------------------------------------------------
 
-static double Sqr(double arg) {
-    // Returns square of a double
-    return arg * arg;
-}
-
 static double AcTan(double sinx, double cosx) {
     // Four-quadrant arctan function
 
@@ -166,63 +109,149 @@ static double ThetaG_JD(double jd) {
     return TWOPI * gmst / SECDAY;
 }
 
-static void CalculateLatLonAlt(double time, vector_t &pos,
+static void CalculateLon(const PropagationContext& context, vector_t &pos,
     geodetic_t &geodetic) {
+    // Right ascension minus GMST, as the angle of the position
+    // rotated into the earth fixed frame
+    double x = pos.x * context.cos_gmst + pos.y * context.sin_gmst;
+    double y = pos.y * context.cos_gmst - pos.x * context.sin_gmst;
+    geodetic.lon = AcTan(y, x); /* radians */
+}
+
+static void CalculateLatLonAlt(const PropagationContext& context,
+    vector_t &pos, geodetic_t &geodetic) {
     // Procedure CalculateLatLonAlt will calculate the geodetic
     // position of an object given its ECI position pos and time.
     // It is intended to be used to determine the ground track of
     // a satellite.  The calculations  assume the earth to be an
     // oblate spheroid as defined in WGS '72.
-    // Reference:  The 1992 Astronomical Almanac, page K12.
+    // Latitude and altitude are calculated in closed form,
+    // see GeodeticLatAlt().
+
+    CalculateLon(context, pos, geodetic);
+    GeodeticLatAlt(pos.x, pos.y, pos.z, geodetic.lat, geodetic.alt);
+}
 
-    double r, e2, phi, c;
+// ----------------------------------------------------------------------------
+// Class methods
+// ----------------------------------------------------------------------------
 
-    geodetic.theta = AcTan(pos.y, pos.x); /* radians */
-    geodetic.lon = FMod2p(geodetic.theta - ThetaG_JD(time)); /* radians */
-    r = sqrt(Sqr(pos.x) + Sqr(pos.y));
-    e2 = FF * (2 - FF);
-    geodetic.lat = AcTan(pos.z, r); /* radians */
+PropagationContext::PropagationContext(double daynum) :
+        daynum(daynum) {
+    jul_utc = daynum + 2444238.5;
+    gmst = ThetaG_JD(jul_utc);
+    sin_gmst = sin(gmst);
+    cos_gmst = cos(gmst);
+}
 
-    do {
-        phi = geodetic.lat;
-        c = 1 / sqrt(1 - e2 * Sqr(sin(phi)));
-        geodetic.lat = AcTan(pos.z + XKMPER * c * e2 * sin(phi), r);
-    } while (fabs(geodetic.lat - phi) >= 1E-10);
+static void ConvertElements(Elements &elements) {
+    // Processes values in the TLE set so that
+    // they are appropriate for the SGP4/SDP4 routines
+    elements.tle_xnodeo *= DEG2RAD;
+    elements.tle_omegao *= DEG2RAD;
+    elements.tle_xmo *= DEG2RAD;
+    elements.tle_xincl *= DEG2RAD;
+    const double TEMP_C = TWOPI / MINDAY / MINDAY;
+    elements.tle_xno = elements.tle_xno * TEMP_C * MINDAY;
+    elements.tle_bstar /= AE;
+}
 
-    geodetic.alt = r / cos(geodetic.lat) - XKMPER * c; /* kilometers */
+static bool IsDeepSpaceOrbit(const Elements &elements) {
+    // Selects the appropriate ephemeris type to be used
+    // for predictions according to the data in the TLE
 
-    if (geodetic.lat > PIO2) {
-        geodetic.lat -= TWOPI;
+    // Period > 225 minutes is deep space
+    double dd1 = (XKE / elements.tle_xno);
+    double dd2 = TOTHRD;
+    double a1 = pow(dd1, dd2);
+    double r1 = cos(elements.tle_xincl);
+    dd1 = (1.0 - elements.tle_eo * elements.tle_eo);
+    double temp = CK2 * 1.5f * (r1 * r1 * 3.0 - 1.0) / pow(dd1, 1.5);
+    double del1 = temp / (a1 * a1);
+    double ao = a1
+            * (1.0
+                    - del1
+                            * (TOTHRD * .5
+                                    + del1 * (del1 * 1.654320987654321 + 1.0)));
+    double delo = temp / (ao * ao);
+    double xnodp = elements.tle_xno / (delo + 1.0);
+
+    // Select a deep-space/near-earth ephemeris
+    return TWOPI / xnodp / MINDAY >= 0.15625;
+}
+
+SatelliteCalc::SatelliteCalc(const Satellite& satellite) {
+    Elements elements;
+    elements.tle_epoch = (1000.0 * (double)satellite.year_)
+            + satellite.refepoch_;
+    elements.tle_bstar = satellite.bstar_;
+    elements.tle_xincl = satellite.incl_;
+    elements.tle_xnodeo = satellite.raan_;
+    elements.tle_eo = satellite.eccn_;
+    elements.tle_omegao = satellite.argper_;
+    elements.tle_xmo = satellite.meanan_;
+    elements.tle_xno = satellite.meanmo_;
+    jul_epoch_ = JulianDateofEpoch(elements.tle_epoch);
+    sat_lat = sat_lon = sat_alt = sat_vel = 0;
+
+    // Precalculate all time-independent values, so Propagate() only runs
+    // the time-dependent part of the propagation
+    ConvertElements(elements);
+    if (IsDeepSpaceOrbit(elements)) {
+        deep_space_.reset(new DeepSpacePropagator(elements));
+        regime_ = deep_space_->GetRegime();
+    } else {
+        near_earth_.reset(new NearEarthPropagator(elements));
+        regime_ = near_earth_->GetRegime();
     }
 }
 
-// ----------------------------------------------------------------------------
-// Class methods
-// ----------------------------------------------------------------------------
+SatelliteCalc::SatelliteCalc(const NearEarthPropagator& near_earth) :
+        regime_(near_earth.GetRegime()),
+        jul_epoch_(JulianDateofEpoch(near_earth.tle_epoch)),
+        near_earth_(new NearEarthPropagator(near_earth)),
+        sat_lat(0),
+        sat_lon(0),
+        sat_alt(0),
+        sat_vel(0) {
+}
 
-SatelliteCalc::SatelliteCalc(const Satellite& satellite) {
-    tle_sat_name = satellite.name_;
-    tle_idesg = satellite.designator_;
-    tle_catnr = satellite.catnum_;
-    tle_epoch = (1000.0 * (double)satellite.year_) + satellite.refepoch_;
-    tle_xndt2o = satellite.drag_;
-    tle_xndd6o = satellite.nddot6_;
-    tle_bstar = satellite.bstar_;
-    tle_xincl = satellite.incl_;
-    tle_xnodeo = satellite.raan_;
-    tle_eo = satellite.eccn_;
-    tle_omegao = satellite.argper_;
-    tle_xmo = satellite.meanan_;
-    tle_xno = satellite.meanmo_;
-    tle_revnum = satellite.orbitnum_;
-
-    /* Clear all flags */
-    is_sdp4_ = epoch_restart = synchronous = resonance = do_loop =
-        lunar_terms_done = simple = sdp4_initialized = sgp4_initialized = false;
-    SelectEphemeris();
+SatelliteCalc::SatelliteCalc(const DeepSpaceTerms& deep_space) :
+        jul_epoch_(JulianDateofEpoch(deep_space.tle_epoch)),
+        deep_space_(new DeepSpacePropagator(deep_space)),
+        sat_lat(0),
+        sat_lon(0),
+        sat_alt(0),
+        sat_vel(0) {
+    regime_ = deep_space_->GetRegime();
 }
 
-void SatelliteCalc::Calc(double daynum) {
+SatelliteCalc::SatelliteCalc(const SatelliteCalc& other) :
+        regime_(other.regime_),
+        jul_epoch_(other.jul_epoch_),
+        near_earth_(other.near_earth_ ?
+                new NearEarthPropagator(*other.near_earth_) : nullptr),
+        deep_space_(other.deep_space_ ?
+                new DeepSpacePropagator(*other.deep_space_) : nullptr),
+        sat_lat(other.sat_lat),
+        sat_lon(other.sat_lon),
+        sat_alt(other.sat_alt),
+        sat_vel(other.sat_vel) {
+}
+
+SatelliteCalc& SatelliteCalc::operator=(SatelliteCalc other) {
+    regime_ = other.regime_;
+    jul_epoch_ = other.jul_epoch_;
+    near_earth_.swap(other.near_earth_);
+    deep_space_.swap(other.deep_space_);
+    sat_lat = other.sat_lat;
+    sat_lon = other.sat_lon;
+    sat_alt = other.sat_alt;
+    sat_vel = other.sat_vel;
+    return *this;
+}
+
+void SatelliteCalc::Calc(const PropagationContext& context) {
     // Zero vector for initializations
     vector_t zero_vector = {};
 
@@ -230,23 +259,64 @@ void SatelliteCalc::Calc(double daynum) {
     vector_t vel = zero_vector;
     vector_t pos = zero_vector;
 
-    // Satellite's predicted geodetic position
-    geodetic_t sat_geodetic;
+    Propagate(TimeSinceEpoch(context), pos, vel);
+    SetState(context, pos, vel);
+}
 
-    double jul_utc = daynum + 2444238.5;
+double SatelliteCalc::TimeSinceEpoch(const PropagationContext& context) const {
+    return (context.jul_utc - jul_epoch_) * MINDAY;
+}
 
-    // Convert satellite's epoch time to Julian
-    // and calculate time since epoch in minutes
-    double jul_epoch = JulianDateofEpoch(tle_epoch);
-    double tsince = (jul_utc - jul_epoch) * MINDAY;
-    age = jul_utc - jul_epoch;
+void SatelliteCalc::Propagate(double tsince, vector_t &pos, vector_t &vel) {
+    // Call NORAD routines according to the regime
+    switch (regime_) {
+    case NEAR_EARTH:
+        Propagate<NEAR_EARTH>(tsince, pos, vel);
+        break;
+    case NEAR_EARTH_SIMPLE:
+        Propagate<NEAR_EARTH_SIMPLE>(tsince, pos, vel);
+        break;
+    case DEEP_SPACE:
+        Propagate<DEEP_SPACE>(tsince, pos, vel);
+        break;
+    case DEEP_SPACE_SYNCHRONOUS:
+        Propagate<DEEP_SPACE_SYNCHRONOUS>(tsince, pos, vel);
+        break;
+    case DEEP_SPACE_HALF_DAY:
+        Propagate<DEEP_SPACE_HALF_DAY>(tsince, pos, vel);
+        break;
+    default:
+        break;
+    }
+}
 
-    // Call NORAD routines according to deep-space flag.
-    if (is_sdp4_) {
-        SDP4(tsince, pos, vel);
+template<REGIMES REGIME>
+void SatelliteCalc::Propagate(double tsince, vector_t &pos, vector_t &vel) {
+    // Only the kernels of the propagator's own regimes are instantiated
+    if (REGIME < DEEP_SPACE) {
+        near_earth_->Propagate<REGIME == NEAR_EARTH_SIMPLE ?
+                NEAR_EARTH_SIMPLE : NEAR_EARTH>(tsince, pos, vel);
     } else {
-        SGP4(tsince, pos, vel);
+        deep_space_->Propagate<REGIME < DEEP_SPACE ?
+                DEEP_SPACE : REGIME>(tsince, pos, vel);
     }
+}
+
+template void SatelliteCalc::Propagate<NEAR_EARTH>(double, vector_t&,
+    vector_t&);
+template void SatelliteCalc::Propagate<NEAR_EARTH_SIMPLE>(double, vector_t&,
+    vector_t&);
+template void SatelliteCalc::Propagate<DEEP_SPACE>(double, vector_t&,
+    vector_t&);
+template void SatelliteCalc::Propagate<DEEP_SPACE_SYNCHRONOUS>(double,
+    vector_t&, vector_t&);
+template void SatelliteCalc::Propagate<DEEP_SPACE_HALF_DAY>(double,
+    vector_t&, vector_t&);
+
+void SatelliteCalc::SetState(const PropagationContext& context, vector_t &pos,
+    vector_t &vel) {
+    // Satellite's predicted geodetic position
+    geodetic_t sat_geodetic;
 
     // Scale position and velocity vectors to km and km/sec
     pos.Scale(XKMPER);
@@ -257,7 +327,7 @@ void SatelliteCalc::Calc(double daynum) {
     sat_vel = vel.w;
 
     // All angles in radians. Distance in km. Velocity in km/s
-    CalculateLatLonAlt(jul_utc, pos, sat_geodetic);
+    CalculateLatLonAlt(context, pos, sat_geodetic);
 
     // Convert satellite data
     sat_lat = sat_geodetic.lat / DEG2RAD;
@@ -265,67 +335,153 @@ void SatelliteCalc::Calc(double daynum) {
     sat_alt = sat_geodetic.alt;
 }
 
-double SatelliteCalc::ThetaG() {
-    // The function ThetaG calculates the Greenwich Mean Sidereal Time
-    // for an epoch specified in the format used in the NORAD two-line
-    // element sets. It has now been adapted for dates beyond the year
-    // 1999, as described above. The function ThetaG_JD provides the
-    // same calculation except that it is based on an input in the
-    // form of a Julian Date.
-    // Reference:  The 1992 Astronomical Almanac, page B6.
+void SatelliteCalc::SetState(const PropagationContext& context,
+    vector_t &pos, vector_t &vel, double lat, double alt) {
+    geodetic_t sat_geodetic;
 
-    double year;
+    pos.Scale(XKMPER);
+    vel.Scale(XKMPER * MINDAY / SECDAY);
+    sat_vel = vel.w;
 
-    /* Modification to support Y2K */
-    /* Valid 1957 through 2056     */
+    CalculateLon(context, pos, sat_geodetic);
 
-    double day = modf(tle_epoch * 1E-3, &year) * 1E3;
-    year += year < 57 ? 2000 : 1900;
-
-    double ut = modf(day, &day);
-    double jd = JulianDateofYear(year) + day;
-    deep_arg.ds50 = jd - 2433281.5 + ut;
-    return FMod2p(6.3003880987 * deep_arg.ds50 + 1.72944494);
+    sat_lat = lat / DEG2RAD;
+    sat_lon = sat_geodetic.lon / DEG2RAD;
+    sat_alt = alt;
 }
 
-void SatelliteCalc::SelectEphemeris() {
-    // Selects the appropriate ephemeris type to be used
-    // for predictions according to the data in the TLE
-    // It also processes values in the TLE set so that
-    // they are appropriate for the SGP4/SDP4 routines
+void SatelliteCalc::Update(SatellitePosition& position) {
+    position.latitude = sat_lat;
+    position.longitude = sat_lon - 360.f;
+    position.altitude = sat_alt;
+    position.velocity = sat_vel;
+}
 
-    // Preprocess TLE set
-    tle_xnodeo *= DEG2RAD;
-    tle_omegao *= DEG2RAD;
-    tle_xmo *= DEG2RAD;
-    tle_xincl *= DEG2RAD;
-    const double TEMP_C = TWOPI / MINDAY / MINDAY;
-    tle_xno = tle_xno * TEMP_C * MINDAY;
-    tle_xndt2o *= TEMP_C;
-    tle_xndd6o = tle_xndd6o * TEMP_C / MINDAY;
-    tle_bstar /= AE;
+const Elements& SatelliteCalc::GetElements() const {
+    if (near_earth_) {
+        return *near_earth_;
+    }
+    return *deep_space_;
+}
 
-    // Period > 225 minutes is deep space
-    double dd1 = (XKE / tle_xno);
-    double dd2 = TOTHRD;
-    double a1 = pow(dd1, dd2);
-    double r1 = cos(tle_xincl);
-    dd1 = (1.0 - tle_eo * tle_eo);
-    double temp = CK2 * 1.5f * (r1 * r1 * 3.0 - 1.0) / pow(dd1, 1.5);
-    double del1 = temp / (a1 * a1);
-    double ao = a1
+NearEarthPropagator::NearEarthPropagator(const Elements& elements) :
+        Elements(elements) {
+    // Initialization of the time-independent SGP4 constants. It is run
+    // only once per satellite, Propagate() then reuses the stored values.
+    double x1m5th, xhdot1, a1, a3ovk2, ao, betao, betao2, c1sq, c2, c3, coef,
+            coef1, del1, delo, eeta, eosq, etasq, perigee, pinvsq, psisq,
+            qoms24, s4, temp, temp1, temp2, temp3, theta2, theta4, tsi;
+
+    // Recover original mean motion (xnodp) and
+    // semimajor axis (aodp) from input elements.
+    a1 = pow(XKE / tle_xno, TOTHRD);
+    cosio = cos(tle_xincl);
+    theta2 = cosio * cosio;
+    x3thm1 = 3 * theta2 - 1.0;
+    eosq = tle_eo * tle_eo;
+    betao2 = 1.0 - eosq;
+    betao = sqrt(betao2);
+    del1 = 1.5 * CK2 * x3thm1 / (a1 * a1 * betao * betao2);
+    ao = a1
             * (1.0
                     - del1
-                            * (TOTHRD * .5
-                                    + del1 * (del1 * 1.654320987654321 + 1.0)));
-    double delo = temp / (ao * ao);
-    double xnodp = tle_xno / (delo + 1.0);
+                            * (0.5 * TOTHRD
+                                    + del1 * (1.0 + 134.0 / 81.0 * del1)));
+    delo = 1.5 * CK2 * x3thm1 / (ao * ao * betao * betao2);
+    xnodp = tle_xno / (1.0 + delo);
+    aodp = ao / (1.0 - delo);
+
+    // For perigee less than 220 kilometers, the "simple"
+    // flag is set and the equations are truncated to linear
+    // variation in sqrt a and quadratic variation in mean
+    // anomaly.  Also, the c3 term, the delta omega term, and
+    // the delta m term are dropped.
+
+    simple = (aodp * (1 - tle_eo) / AE) < (220 / XKMPER + AE);
+
+    // For perigees below 156 km, the values of s and QOMS2T are altered.
+    s4 = S4_INIT;
+    qoms24 = QOMS2T;
+    perigee = (aodp * (1 - tle_eo) - AE) * XKMPER;
+
+    if (perigee < 156.0) {
+        s4 = perigee <= 98.0 ? 20 : perigee - 78.0;
+        qoms24 = pow((120 - s4) * AE / XKMPER, 4);
+        s4 = s4 / XKMPER + AE;
+    }
 
-    // Select a deep-space/near-earth ephemeris
-    is_sdp4_ = TWOPI / xnodp / MINDAY >= 0.15625;
+    pinvsq = 1 / (aodp * aodp * betao2 * betao2);
+    tsi = 1 / (aodp - s4);
+    eta = aodp * tle_eo * tsi;
+    etasq = eta * eta;
+    eeta = tle_eo * eta;
+    psisq = fabs(1 - etasq);
+    coef = qoms24 * pow(tsi, 4);
+    coef1 = coef / pow(psisq, 3.5);
+    c2 = coef1 * xnodp
+            * (aodp * (1 + 1.5 * etasq + eeta * (4 + etasq))
+                    + 0.75 * CK2 * tsi / psisq * x3thm1
+                            * (8 + 3 * etasq * (8 + etasq)));
+    c1 = tle_bstar * c2;
+    sinio = sin(tle_xincl);
+    a3ovk2 = -XJ3 / CK2 * pow(AE, 3);
+    c3 = coef * tsi * a3ovk2 * xnodp * AE * sinio / tle_eo;
+    x1mth2 = 1 - theta2;
+
+    c4 = 2 * xnodp * coef1 * aodp * betao2
+            * (eta * (2 + 0.5 * etasq) + tle_eo * (0.5 + 2 * etasq)
+                    - 2 * CK2 * tsi / (aodp * psisq)
+                            * (-3 * x3thm1
+                                    * (1 - 2 * eeta
+                                            + etasq * (1.5 - 0.5 * eeta))
+                                    + 0.75 * x1mth2
+                                            * (2 * etasq
+                                                    - eeta * (1 + etasq))
+                                            * cos(2 * tle_omegao)));
+    c5 = 2 * coef1 * aodp * betao2
+            * (1 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    theta4 = theta2 * theta2;
+    temp1 = 3 * CK2 * pinvsq * xnodp;
+    temp2 = temp1 * CK2 * pinvsq;
+    temp3 = 1.25 * CK4 * pinvsq * pinvsq * xnodp;
+    xmdot = xnodp + 0.5 * temp1 * betao * x3thm1
+            + 0.0625 * temp2 * betao * (13 - 78 * theta2 + 137 * theta4);
+    x1m5th = 1 - 5 * theta2;
+    omgdot = -0.5 * temp1 * x1m5th
+            + 0.0625 * temp2 * (7 - 114 * theta2 + 395 * theta4)
+            + temp3 * (3 - 36 * theta2 + 49 * theta4);
+    xhdot1 = -temp1 * cosio;
+    xnodot = xhdot1
+            + (0.5 * temp2 * (4 - 19 * theta2)
+                    + 2 * temp3 * (3 - 7 * theta2)) * cosio;
+    omgcof = tle_bstar * c3 * cos(tle_omegao);
+    xmcof = -TOTHRD * coef * tle_bstar * AE / eeta;
+    xnodcf = 3.5 * betao2 * xhdot1 * c1;
+    t2cof = 1.5 * c1;
+    xlcof = 0.125 * a3ovk2 * sinio * (3 + 5 * cosio) / (1 + cosio);
+    aycof = 0.25 * a3ovk2 * sinio;
+    delmo = pow(1 + eta * cos(tle_xmo), 3);
+    sinmo = sin(tle_xmo);
+    x7thm1 = 7 * theta2 - 1;
+
+    if (!simple) {
+        c1sq = c1 * c1;
+        d2 = 4 * aodp * tsi * c1sq;
+        temp = d2 * tsi * c1 / 3;
+        d3 = (17 * aodp + s4) * temp;
+        d4 = 0.5 * temp * aodp * tsi * (221 * aodp + 31 * s4) * c1;
+        t3cof = d2 + 2 * c1sq;
+        t4cof = 0.25 * (3 * d3 + c1 * (12 * d2 + 10 * c1sq));
+        t5cof = 0.2
+                * (3 * d4 + 12 * c1 * d3 + 6 * d2 * d2
+                        + 15 * c1sq * (2 * d2 + c1sq));
+    }
 }
 
-void SatelliteCalc::SGP4(double tsince, vector_t &pos, vector_t &vel) {
+template<REGIMES REGIME>
+void NearEarthPropagator::Propagate(double tsince, vector_t &pos,
+    vector_t &vel) const {
     // This function is used to calculate the position and velocity
     // of near-earth (period < 225 minutes) satellites. tsince is
     // time since epoch in minutes, pos and vel are vector_t structures
@@ -333,126 +489,13 @@ void SatelliteCalc::SGP4(double tsince, vector_t &pos, vector_t &vel) {
     double cosuk, sinuk, rfdotk, vx, vy, vz, ux, uy, uz, xmy, xmx, cosnok,
             sinnok, cosik, sinik, rdotk, xinck, xnodek, uk, rk, cos2u, sin2u, u,
             sinu, cosu, betal, rfdot, rdot, r, pl, elsq, esine, ecose, epw,
-            cosepw, x1m5th, xhdot1, tfour, sinepw, capu, ayn, xlt, aynl, xll,
-            axn, xn, beta, xl, e, a, tcube, delm, delomg, templ, tempe, tempa,
-            xnode, tsq, xmp, omega, xnoddf, omgadf, xmdf, a1, a3ovk2, ao, betao,
-            betao2, c1sq, c2, c3, coef, coef1, del1, delo, eeta, eosq, etasq,
-            perigee, pinvsq, psisq, qoms24, s4, temp, temp1, temp2, temp3,
-            temp4, temp5, temp6, theta2, theta4, tsi;
+            cosepw, tfour, sinepw, capu, ayn, xlt, aynl, xll, axn, xn, beta, xl,
+            e, a, tcube, delm, delomg, templ, tempe, tempa, xnode, tsq, xmp,
+            omega, xnoddf, omgadf, xmdf, temp, temp1, temp2, temp3, temp4,
+            temp5, temp6;
 
     int i;
 
-    // Initialization
-    if (!sgp4_initialized) {
-        sgp4_initialized = true;
-
-        // Recover original mean motion (xnodp) and
-        // semimajor axis (aodp) from input elements.
-        a1 = pow(XKE / tle_xno, TOTHRD);
-        cosio = cos(tle_xincl);
-        theta2 = cosio * cosio;
-        x3thm1 = 3 * theta2 - 1.0;
-        eosq = tle_eo * tle_eo;
-        betao2 = 1.0 - eosq;
-        betao = sqrt(betao2);
-        del1 = 1.5 * CK2 * x3thm1 / (a1 * a1 * betao * betao2);
-        ao = a1
-                * (1.0
-                        - del1
-                                * (0.5 * TOTHRD
-                                        + del1 * (1.0 + 134.0 / 81.0 * del1)));
-        delo = 1.5 * CK2 * x3thm1 / (ao * ao * betao * betao2);
-        xnodp = tle_xno / (1.0 + delo);
-        aodp = ao / (1.0 - delo);
-
-        // For perigee less than 220 kilometers, the "simple"
-        // flag is set and the equations are truncated to linear
-        // variation in sqrt a and quadratic variation in mean
-        // anomaly.  Also, the c3 term, the delta omega term, and
-        // the delta m term are dropped.
-
-        simple = (aodp * (1 - tle_eo) / AE) < (220 / XKMPER + AE);
-
-        // For perigees below 156 km, the values of s and QOMS2T are altered.
-        s4 = S4_INIT;
-        qoms24 = QOMS2T;
-        perigee = (aodp * (1 - tle_eo) - AE) * XKMPER;
-
-        if (perigee < 156.0) {
-            s4 = perigee <= 98.0 ? 20 : perigee - 78.0;
-            qoms24 = pow((120 - s4) * AE / XKMPER, 4);
-            s4 = s4 / XKMPER + AE;
-        }
-
-        pinvsq = 1 / (aodp * aodp * betao2 * betao2);
-        tsi = 1 / (aodp - s4);
-        eta = aodp * tle_eo * tsi;
-        etasq = eta * eta;
-        eeta = tle_eo * eta;
-        psisq = fabs(1 - etasq);
-        coef = qoms24 * pow(tsi, 4);
-        coef1 = coef / pow(psisq, 3.5);
-        c2 = coef1 * xnodp
-                * (aodp * (1 + 1.5 * etasq + eeta * (4 + etasq))
-                        + 0.75 * CK2 * tsi / psisq * x3thm1
-                                * (8 + 3 * etasq * (8 + etasq)));
-        c1 = tle_bstar * c2;
-        sinio = sin(tle_xincl);
-        a3ovk2 = -XJ3 / CK2 * pow(AE, 3);
-        c3 = coef * tsi * a3ovk2 * xnodp * AE * sinio / tle_eo;
-        x1mth2 = 1 - theta2;
-
-        c4 = 2 * xnodp * coef1 * aodp * betao2
-                * (eta * (2 + 0.5 * etasq) + tle_eo * (0.5 + 2 * etasq)
-                        - 2 * CK2 * tsi / (aodp * psisq)
-                                * (-3 * x3thm1
-                                        * (1 - 2 * eeta
-                                                + etasq * (1.5 - 0.5 * eeta))
-                                        + 0.75 * x1mth2
-                                                * (2 * etasq
-                                                        - eeta * (1 + etasq))
-                                                * cos(2 * tle_omegao)));
-        c5 = 2 * coef1 * aodp * betao2
-                * (1 + 2.75 * (etasq + eeta) + eeta * etasq);
-
-        theta4 = theta2 * theta2;
-        temp1 = 3 * CK2 * pinvsq * xnodp;
-        temp2 = temp1 * CK2 * pinvsq;
-        temp3 = 1.25 * CK4 * pinvsq * pinvsq * xnodp;
-        xmdot = xnodp + 0.5 * temp1 * betao * x3thm1
-                + 0.0625 * temp2 * betao * (13 - 78 * theta2 + 137 * theta4);
-        x1m5th = 1 - 5 * theta2;
-        omgdot = -0.5 * temp1 * x1m5th
-                + 0.0625 * temp2 * (7 - 114 * theta2 + 395 * theta4)
-                + temp3 * (3 - 36 * theta2 + 49 * theta4);
-        xhdot1 = -temp1 * cosio;
-        xnodot = xhdot1
-                + (0.5 * temp2 * (4 - 19 * theta2)
-                        + 2 * temp3 * (3 - 7 * theta2)) * cosio;
-        omgcof = tle_bstar * c3 * cos(tle_omegao);
-        xmcof = -TOTHRD * coef * tle_bstar * AE / eeta;
-        xnodcf = 3.5 * betao2 * xhdot1 * c1;
-        t2cof = 1.5 * c1;
-        xlcof = 0.125 * a3ovk2 * sinio * (3 + 5 * cosio) / (1 + cosio);
-        aycof = 0.25 * a3ovk2 * sinio;
-        delmo = pow(1 + eta * cos(tle_xmo), 3);
-        sinmo = sin(tle_xmo);
-        x7thm1 = 7 * theta2 - 1;
-
-        if (!simple) {
-            c1sq = c1 * c1;
-            d2 = 4 * aodp * tsi * c1sq;
-            temp = d2 * tsi * c1 / 3;
-            d3 = (17 * aodp + s4) * temp;
-            d4 = 0.5 * temp * aodp * tsi * (221 * aodp + 31 * s4) * c1;
-            t3cof = d2 + 2 * c1sq;
-            t4cof = 0.25 * (3 * d3 + c1 * (12 * d2 + 10 * c1sq));
-            t5cof = 0.2
-                    * (3 * d4 + 12 * c1 * d3 + 6 * d2 * d2
-                            + 15 * c1sq * (2 * d2 + c1sq));
-        }
-    }
-
     // Update for secular gravity and atmospheric drag.
     xmdf = tle_xmo + xmdot * tsince;
     omgadf = tle_omegao + omgdot * tsince;
@@ -465,7 +508,7 @@ void SatelliteCalc::SGP4(double tsince, vector_t &pos, vector_t &vel) {
     tempe = tle_bstar * c4 * tsince;
     templ = t2cof * tsq;
 
-    if (!simple) {
+    if (REGIME != NEAR_EARTH_SIMPLE) {
         delomg = omgcof * tsince;
         delm = xmcof * (pow(1 + eta * cos(xmdf), 3) - delmo);
         temp = delomg + delm;
@@ -569,524 +612,685 @@ void SatelliteCalc::SGP4(double tsince, vector_t &pos, vector_t &vel) {
     vel.z = rdotk * uz + rfdotk * vz;
 }
 
-void SatelliteCalc::Deep(int ientry) {
-    // This function is used by SDP4 to add lunar and solar
-    // perturbation effects to deep-space orbit objects.
-    double a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, ainv2, alfdp, aqnv, sgh,
-            sini2, sinis, sinok, sh, si, sil, day, betdp, dalf, bfact, c, cc,
-            cosis, cosok, cosq, ctem, f322, zx, zy, dbet, dls, eoc, eq, f2,
-            f220, f221, f3, f311, f321, xnoh, f330, f441, f442, f522, f523,
-            f542, f543, g200, g201, g211, pgh, ph, s1, s2, s3, s4, s5, s6, s7,
-            se, sel, ses, xls, g300, g310, g322, g410, g422, g520, g521, g532,
-            g533, gam, sinq, sinzf, sis, sl, sll, sls, stem, temp, temp1, x1,
-            x2, x2li, x2omi, x3, x4, x5, x6, x7, x8, xl, xldot, xmao, xnddt,
-            xndot, xno2, xnodce, xnoi, xomi, xpidot, z1, z11, z12, z13, z2, z21,
-            z22, z23, z3, z31, z32, z33, ze, zf, zm, zmo, zn, zsing, zsinh,
-            zsini, zcosg, zcosh, zcosi, delt = 0, ft = 0;
-
-    switch (ientry) {
-    case DPINIT: // Entrance for deep space initialization
-        thgr = ThetaG();
-        eq = tle_eo;
-        xnq = deep_arg.xnodp;
-        aqnv = 1 / deep_arg.aodp;
-        xqncl = tle_xincl;
-        xmao = tle_xmo;
-        xpidot = deep_arg.omgdot + deep_arg.xnodot;
-        sinq = sin(tle_xnodeo);
-        cosq = cos(tle_xnodeo);
-        omegaq = tle_omegao;
-
-        // Initialize lunar solar terms
-        day = deep_arg.ds50 + 18261.5; // Days since 1900 Jan 0.5
-
-        if (day != preep) {
-            preep = day;
-            xnodce = 4.5236020 - 9.2422029E-4 * day;
-            stem = sin(xnodce);
-            ctem = cos(xnodce);
-            zcosil = 0.91375164 - 0.03568096 * ctem;
-            zsinil = sqrt(1 - zcosil * zcosil);
-            zsinhl = 0.089683511 * stem / zsinil;
-            zcoshl = sqrt(1 - zsinhl * zsinhl);
-            c = 4.7199672 + 0.22997150 * day;
-            gam = 5.8351514 + 0.0019443680 * day;
-            zmol = FMod2p(c - gam);
-            zx = 0.39785416 * stem / zsinil;
-            zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
-            zx = AcTan(zx, zy);
-            zx = gam + zx - xnodce;
-            zcosgl = cos(zx);
-            zsingl = sin(zx);
-            zmos = 6.2565837 + 0.017201977 * day;
-            zmos = FMod2p(zmos);
-        }
+template void NearEarthPropagator::Propagate<NEAR_EARTH>(double, vector_t&,
+    vector_t&) const;
+template void NearEarthPropagator::Propagate<NEAR_EARTH_SIMPLE>(double,
+    vector_t&, vector_t&) const;
 
-        // Do solar terms
-        savtsn = 1E20;
-        zcosg = ZCOSGS;
-        zsing = ZSINGS;
-        zcosi = ZCOSIS;
-        zsini = ZSINIS;
-        zcosh = cosq;
-        zsinh = sinq;
-        cc = C1SS;
-        zn = ZNS;
-        ze = ZES;
-        zmo = zmos;
-        xnoi = 1 / xnq;
-
-        // Loop breaks when Solar terms are done a second
-        // time, after Lunar terms are initialized
-
-        for (;;) {
-            // Solar terms done again after Lunar terms are done
-            a1 = zcosg * zcosh + zsing * zcosi * zsinh;
-            a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
-            a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
-            a8 = zsing * zsini;
-            a9 = zsing * zsinh + zcosg * zcosi * zcosh;
-            a10 = zcosg * zsini;
-            a2 = deep_arg.cosio * a7 + deep_arg.sinio * a8;
-            a4 = deep_arg.cosio * a9 + deep_arg.sinio * a10;
-            a5 = -deep_arg.sinio * a7 + deep_arg.cosio * a8;
-            a6 = -deep_arg.sinio * a9 + deep_arg.cosio * a10;
-            x1 = a1 * deep_arg.cosg + a2 * deep_arg.sing;
-            x2 = a3 * deep_arg.cosg + a4 * deep_arg.sing;
-            x3 = -a1 * deep_arg.sing + a2 * deep_arg.cosg;
-            x4 = -a3 * deep_arg.sing + a4 * deep_arg.cosg;
-            x5 = a5 * deep_arg.sing;
-            x6 = a6 * deep_arg.sing;
-            x7 = a5 * deep_arg.cosg;
-            x8 = a6 * deep_arg.cosg;
-            z31 = 12 * x1 * x1 - 3 * x3 * x3;
-            z32 = 24 * x1 * x2 - 6 * x3 * x4;
-            z33 = 12 * x2 * x2 - 3 * x4 * x4;
-            z1 = 3 * (a1 * a1 + a2 * a2) + z31 * deep_arg.eosq;
-            z2 = 6 * (a1 * a3 + a2 * a4) + z32 * deep_arg.eosq;
-            z3 = 3 * (a3 * a3 + a4 * a4) + z33 * deep_arg.eosq;
-            z11 = -6 * a1 * a5 + deep_arg.eosq * (-24 * x1 * x7 - 6 * x3 * x5);
-            z12 = -6 * (a1 * a6 + a3 * a5)
-                    + deep_arg.eosq
-                            * (-24 * (x2 * x7 + x1 * x8)
-                                    - 6 * (x3 * x6 + x4 * x5));
-            z13 = -6 * a3 * a6 + deep_arg.eosq * (-24 * x2 * x8 - 6 * x4 * x6);
-            z21 = 6 * a2 * a5 + deep_arg.eosq * (24 * x1 * x5 - 6 * x3 * x7);
-            z22 = 6 * (a4 * a5 + a2 * a6)
-                    + deep_arg.eosq
-                            * (24 * (x2 * x5 + x1 * x6)
-                                    - 6 * (x4 * x7 + x3 * x8));
-            z23 = 6 * a4 * a6 + deep_arg.eosq * (24 * x2 * x6 - 6 * x4 * x8);
-            z1 = z1 + z1 + deep_arg.betao2 * z31;
-            z2 = z2 + z2 + deep_arg.betao2 * z32;
-            z3 = z3 + z3 + deep_arg.betao2 * z33;
-            s3 = cc * xnoi;
-            s2 = -0.5 * s3 / deep_arg.betao;
-            s4 = s3 * deep_arg.betao;
-            s1 = -15 * eq * s4;
-            s5 = x1 * x3 + x2 * x4;
-            s6 = x2 * x3 + x1 * x4;
-            s7 = x2 * x4 - x1 * x3;
-            se = s1 * zn * s5;
-            si = s2 * zn * (z11 + z13);
-            sl = -zn * s3 * (z1 + z3 - 14 - 6 * deep_arg.eosq);
-            sgh = s4 * zn * (z31 + z33 - 6);
-            sh = -zn * s2 * (z21 + z23);
-
-            if (xqncl < 5.2359877E-2) {
-                sh = 0;
-            }
+double DeepSpacePropagator::ThetaG() {
+    // The function ThetaG calculates the Greenwich Mean Sidereal Time
+    // for an epoch specified in the format used in the NORAD two-line
+    // element sets. It has now been adapted for dates beyond the year
+    // 1999, as described above. The function ThetaG_JD provides the
+    // same calculation except that it is based on an input in the
+    // form of a Julian Date.
+    // Reference:  The 1992 Astronomical Almanac, page B6.
 
-            ee2 = 2 * s1 * s6;
-            e3 = 2 * s1 * s7;
-            xi2 = 2 * s2 * z12;
-            xi3 = 2 * s2 * (z13 - z11);
-            xl2 = -2 * s3 * z2;
-            xl3 = -2 * s3 * (z3 - z1);
-            xl4 = -2 * s3 * (-21 - 9 * deep_arg.eosq) * ze;
-            xgh2 = 2 * s4 * z32;
-            xgh3 = 2 * s4 * (z33 - z31);
-            xgh4 = -18 * s4 * ze;
-            xh2 = -2 * s2 * z22;
-            xh3 = -2 * s2 * (z23 - z21);
-
-            if (lunar_terms_done) {
-                break;
-            }
+    double year;
 
-            // Do lunar terms
-            sse = se;
-            ssi = si;
-            ssl = sl;
-            ssh = sh / deep_arg.sinio;
-            ssg = sgh - deep_arg.cosio * ssh;
-            se2 = ee2;
-            si2 = xi2;
-            sl2 = xl2;
-            sgh2 = xgh2;
-            sh2 = xh2;
-            se3 = e3;
-            si3 = xi3;
-            sl3 = xl3;
-            sgh3 = xgh3;
-            sh3 = xh3;
-            sl4 = xl4;
-            sgh4 = xgh4;
-            zcosg = zcosgl;
-            zsing = zsingl;
-            zcosi = zcosil;
-            zsini = zsinil;
-            zcosh = zcoshl * cosq + zsinhl * sinq;
-            zsinh = sinq * zcoshl - cosq * zsinhl;
-            zn = ZNL;
-            cc = C1L;
-            ze = ZEL;
-            zmo = zmol;
-            lunar_terms_done = true;
-        }
+    /* Modification to support Y2K */
+    /* Valid 1957 through 2056     */
 
-        sse = sse + se;
-        ssi = ssi + si;
-        ssl = ssl + sl;
-        ssg = ssg + sgh - deep_arg.cosio / deep_arg.sinio * sh;
-        ssh = ssh + sh / deep_arg.sinio;
+    double day = modf(tle_epoch * 1E-3, &year) * 1E3;
+    year += year < 57 ? 2000 : 1900;
 
-        // Geopotential resonance initialization for 12 hour orbits
-        resonance = false;
-        synchronous = false;
+    double ut = modf(day, &day);
+    double jd = JulianDateofYear(year) + day;
+    deep_arg.ds50 = jd - 2433281.5 + ut;
+    return FMod2p(6.3003880987 * deep_arg.ds50 + 1.72944494);
+}
 
-        if (!((xnq < 0.0052359877) && (xnq > 0.0034906585))) {
-            if ((xnq < 0.00826) || (xnq > 0.00924)) {
-                return;
-            }
+DeepSpacePropagator::DeepSpacePropagator(const Elements& elements) :
+        DeepSpaceTerms(elements) {
+    // Initialization of the time-independent SDP4 constants including
+    // the lunar-solar and resonance terms. It is run only once per
+    // satellite.
+    double theta4, a1, a3ovk2, ao, c2, coef, coef1, x1m5th, xhdot1, del1, delo,
+            eeta, eta, etasq, perigee, psisq, tsi, qoms24, s4, pinvsq, temp1,
+            temp2, temp3;
+
+    // Recover original mean motion (xnodp) and
+    // semimajor axis (aodp) from input elements.
+    a1 = pow(XKE / tle_xno, TOTHRD);
+    deep_arg.cosio = cos(tle_xincl);
+    deep_arg.theta2 = deep_arg.cosio * deep_arg.cosio;
+    x3thm1 = 3 * deep_arg.theta2 - 1;
+    deep_arg.eosq = tle_eo * tle_eo;
+    deep_arg.betao2 = 1 - deep_arg.eosq;
+    deep_arg.betao = sqrt(deep_arg.betao2);
+    del1 = 1.5 * CK2 * x3thm1
+            / (a1 * a1 * deep_arg.betao * deep_arg.betao2);
+    ao = a1 * (1 - del1 * (0.5 * TOTHRD + del1 * (1 + 134 / 81 * del1)));
+    delo = 1.5 * CK2 * x3thm1
+            / (ao * ao * deep_arg.betao * deep_arg.betao2);
+    deep_arg.xnodp = tle_xno / (1 + delo);
+    deep_arg.aodp = ao / (1 - delo);
+
+    // For perigee below 156 km, the values of s and QOMS2T are altered.
+    s4 = S4_INIT;
+    qoms24 = QOMS2T;
+    perigee = (deep_arg.aodp * (1 - tle_eo) - AE) * XKMPER;
+
+    if (perigee < 156.0) {
+        s4 = perigee <= 98.0 ? 20.0 : perigee - 78.0;
+        qoms24 = pow((120 - s4) * AE / XKMPER, 4);
+        s4 = s4 / XKMPER + AE;
+    }
 
-            if (eq < 0.5) {
-                return;
-            }
+    pinvsq = 1
+            / (deep_arg.aodp * deep_arg.aodp * deep_arg.betao2
+                    * deep_arg.betao2);
+    deep_arg.sing = sin(tle_omegao);
+    deep_arg.cosg = cos(tle_omegao);
+    tsi = 1 / (deep_arg.aodp - s4);
+    eta = deep_arg.aodp * tle_eo * tsi;
+    etasq = eta * eta;
+    eeta = tle_eo * eta;
+    psisq = fabs(1 - etasq);
+    coef = qoms24 * pow(tsi, 4);
+    coef1 = coef / pow(psisq, 3.5);
+    c2 = coef1 * deep_arg.xnodp
+            * (deep_arg.aodp * (1 + 1.5 * etasq + eeta * (4 + etasq))
+                    + 0.75 * CK2 * tsi / psisq * x3thm1
+                            * (8 + 3 * etasq * (8 + etasq)));
+    c1 = tle_bstar * c2;
+    deep_arg.sinio = sin(tle_xincl);
+    a3ovk2 = -XJ3 / CK2 * pow(AE, 3);
+    x1mth2 = 1 - deep_arg.theta2;
+    c4 = 2 * deep_arg.xnodp * coef1 * deep_arg.aodp * deep_arg.betao2
+            * (eta * (2 + 0.5 * etasq) + tle_eo * (0.5 + 2 * etasq)
+                    - 2 * CK2 * tsi / (deep_arg.aodp * psisq)
+                            * (-3 * x3thm1
+                                    * (1 - 2 * eeta
+                                            + etasq * (1.5 - 0.5 * eeta))
+                                    + 0.75 * x1mth2
+                                            * (2 * etasq
+                                                    - eeta * (1 + etasq))
+                                            * cos(2 * tle_omegao)));
+    theta4 = deep_arg.theta2 * deep_arg.theta2;
+    temp1 = 3 * CK2 * pinvsq * deep_arg.xnodp;
+    temp2 = temp1 * CK2 * pinvsq;
+    temp3 = 1.25 * CK4 * pinvsq * pinvsq * deep_arg.xnodp;
+    deep_arg.xmdot = deep_arg.xnodp + 0.5 * temp1 * deep_arg.betao * x3thm1
+            + 0.0625 * temp2 * deep_arg.betao
+                    * (13 - 78 * deep_arg.theta2 + 137 * theta4);
+    x1m5th = 1 - 5 * deep_arg.theta2;
+    deep_arg.omgdot = -0.5 * temp1 * x1m5th
+            + 0.0625 * temp2 * (7 - 114 * deep_arg.theta2 + 395 * theta4)
+            + temp3 * (3 - 36 * deep_arg.theta2 + 49 * theta4);
+    xhdot1 = -temp1 * deep_arg.cosio;
+    deep_arg.xnodot = xhdot1
+            + (0.5 * temp2 * (4 - 19 * deep_arg.theta2)
+                    + 2 * temp3 * (3 - 7 * deep_arg.theta2))
+                    * deep_arg.cosio;
+    xnodcf = 3.5 * deep_arg.betao2 * xhdot1 * c1;
+    t2cof = 1.5 * c1;
+    xlcof = 0.125 * a3ovk2 * deep_arg.sinio * (3 + 5 * deep_arg.cosio)
+            / (1 + deep_arg.cosio);
+    aycof = 0.25 * a3ovk2 * deep_arg.sinio;
+    x7thm1 = 7 * deep_arg.theta2 - 1;
+
+    // initialize the deep-space terms
+    DeepInit();
+}
 
-            resonance = true;
-            eoc = eq * deep_arg.eosq;
-            g201 = -0.306 - (eq - 0.64) * 0.440;
-
-            if (eq <= 0.65) {
-                g211 = 3.616 - 13.247 * eq + 16.290 * deep_arg.eosq;
-                g310 = -19.302 + 117.390 * eq - 228.419 * deep_arg.eosq
-                        + 156.591 * eoc;
-                g322 = -18.9068 + 109.7927 * eq - 214.6334 * deep_arg.eosq
-                        + 146.5816 * eoc;
-                g410 = -41.122 + 242.694 * eq - 471.094 * deep_arg.eosq
-                        + 313.953 * eoc;
-                g422 = -146.407 + 841.880 * eq - 1629.014 * deep_arg.eosq
-                        + 1083.435 * eoc;
-                g520 = -532.114 + 3017.977 * eq - 5740 * deep_arg.eosq
-                        + 3708.276 * eoc;
-            } else {
-                g211 = -72.099 + 331.819 * eq - 508.738 * deep_arg.eosq
-                        + 266.724 * eoc;
-                g310 = -346.844 + 1582.851 * eq - 2415.925 * deep_arg.eosq
-                        + 1246.113 * eoc;
-                g322 = -342.585 + 1554.908 * eq - 2366.899 * deep_arg.eosq
-                        + 1215.972 * eoc;
-                g410 = -1052.797 + 4758.686 * eq - 7193.992 * deep_arg.eosq
-                        + 3651.957 * eoc;
-                g422 = -3581.69 + 16178.11 * eq - 24462.77 * deep_arg.eosq
-                        + 12422.52 * eoc;
-
-                if (eq <= 0.715) {
-                    g520 = 1464.74 - 4664.75 * eq + 3763.64 * deep_arg.eosq;
-                } else {
-                    g520 = -5149.66 + 29936.92 * eq - 54087.36 * deep_arg.eosq
-                            + 31324.56 * eoc;
-                }
-            }
+DeepSpacePropagator::DeepSpacePropagator(const DeepSpaceTerms& terms) :
+        DeepSpaceTerms(terms) {
+    // The terms may come from a propagator that already ran
+    ResetState();
+}
 
-            if (eq < 0.7) {
-                g533 = -919.2277 + 4988.61 * eq - 9064.77 * deep_arg.eosq
-                        + 5542.21 * eoc;
-                g521 = -822.71072 + 4568.6173 * eq - 8491.4146 * deep_arg.eosq
-                        + 5337.524 * eoc;
-                g532 = -853.666 + 4690.25 * eq - 8624.77 * deep_arg.eosq
-                        + 5341.4 * eoc;
-            } else {
-                g533 = -37995.78 + 161616.52 * eq - 229838.2 * deep_arg.eosq
-                        + 109377.94 * eoc;
-                g521 = -51752.104 + 218913.95 * eq - 309468.16 * deep_arg.eosq
-                        + 146349.42 * eoc;
-                g532 = -40023.88 + 170470.89 * eq - 242699.48 * deep_arg.eosq
-                        + 115605.82 * eoc;
-            }
+void DeepSpacePropagator::DeepInit() {
+    // Lunar-solar and resonance terms for deep-space orbit objects,
+    // it also selects the regime of the resonance.
+    double a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, ainv2, aqnv, sgh, sini2,
+            sh, si, day, bfact, c, cc, cosq, ctem, f322, zx, zy, eoc, eq, f220,
+            f221, f311, f321, f330, f441, f442, f522, f523, f542, f543, g200,
+            g201, g211, s1, s2, s3, s4, s5, s6, s7, se, g300, g310, g322, g410,
+            g422, g520, g521, g532, g533, gam, sinq, sl, stem, temp, temp1, x1,
+            x2, x3, x4, x5, x6, x7, x8, xmao, xno2, xnodce, xnoi, xpidot, z1,
+            z11, z12, z13, z2, z21, z22, z23, z3, z31, z32, z33, ze, zn,
+            zsing, zsinh, zsini, zcosg, zcosh, zcosi, zcosgl, zsingl, zcosil,
+            zsinil, zcoshl, zsinhl;
+    bool lunar_terms_done = false;
+
+    thgr = ThetaG();
+    eq = tle_eo;
+    xnq = deep_arg.xnodp;
+    aqnv = 1 / deep_arg.aodp;
+    xqncl = tle_xincl;
+    xmao = tle_xmo;
+    xpidot = deep_arg.omgdot + deep_arg.xnodot;
+    sinq = sin(tle_xnodeo);
+    cosq = cos(tle_xnodeo);
+    omegaq = tle_omegao;
+
+    // Initialize lunar solar terms
+    day = deep_arg.ds50 + 18261.5; // Days since 1900 Jan 0.5
+
+    xnodce = 4.5236020 - 9.2422029E-4 * day;
+    stem = sin(xnodce);
+    ctem = cos(xnodce);
+    zcosil = 0.91375164 - 0.03568096 * ctem;
+    zsinil = sqrt(1 - zcosil * zcosil);
+    zsinhl = 0.089683511 * stem / zsinil;
+    zcoshl = sqrt(1 - zsinhl * zsinhl);
+    c = 4.7199672 + 0.22997150 * day;
+    gam = 5.8351514 + 0.0019443680 * day;
+    zmol = FMod2p(c - gam);
+    zx = 0.39785416 * stem / zsinil;
+    zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
+    zx = AcTan(zx, zy);
+    zx = gam + zx - xnodce;
+    zcosgl = cos(zx);
+    zsingl = sin(zx);
+    zmos = 6.2565837 + 0.017201977 * day;
+    zmos = FMod2p(zmos);
+
+    // Do solar terms
+    savtsn = 1E20;
+    zcosg = ZCOSGS;
+    zsing = ZSINGS;
+    zcosi = ZCOSIS;
+    zsini = ZSINIS;
+    zcosh = cosq;
+    zsinh = sinq;
+    cc = C1SS;
+    zn = ZNS;
+    ze = ZES;
+    xnoi = 1 / xnq;
+
+    // Loop breaks when Solar terms are done a second
+    // time, after Lunar terms are initialized
+
+    for (;;) {
+        // Solar terms done again after Lunar terms are done
+        a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+        a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+        a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+        a8 = zsing * zsini;
+        a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+        a10 = zcosg * zsini;
+        a2 = deep_arg.cosio * a7 + deep_arg.sinio * a8;
+        a4 = deep_arg.cosio * a9 + deep_arg.sinio * a10;
+        a5 = -deep_arg.sinio * a7 + deep_arg.cosio * a8;
+        a6 = -deep_arg.sinio * a9 + deep_arg.cosio * a10;
+        x1 = a1 * deep_arg.cosg + a2 * deep_arg.sing;
+        x2 = a3 * deep_arg.cosg + a4 * deep_arg.sing;
+        x3 = -a1 * deep_arg.sing + a2 * deep_arg.cosg;
+        x4 = -a3 * deep_arg.sing + a4 * deep_arg.cosg;
+        x5 = a5 * deep_arg.sing;
+        x6 = a6 * deep_arg.sing;
+        x7 = a5 * deep_arg.cosg;
+        x8 = a6 * deep_arg.cosg;
+        z31 = 12 * x1 * x1 - 3 * x3 * x3;
+        z32 = 24 * x1 * x2 - 6 * x3 * x4;
+        z33 = 12 * x2 * x2 - 3 * x4 * x4;
+        z1 = 3 * (a1 * a1 + a2 * a2) + z31 * deep_arg.eosq;
+        z2 = 6 * (a1 * a3 + a2 * a4) + z32 * deep_arg.eosq;
+        z3 = 3 * (a3 * a3 + a4 * a4) + z33 * deep_arg.eosq;
+        z11 = -6 * a1 * a5 + deep_arg.eosq * (-24 * x1 * x7 - 6 * x3 * x5);
+        z12 = -6 * (a1 * a6 + a3 * a5)
+                + deep_arg.eosq
+                        * (-24 * (x2 * x7 + x1 * x8)
+                                - 6 * (x3 * x6 + x4 * x5));
+        z13 = -6 * a3 * a6 + deep_arg.eosq * (-24 * x2 * x8 - 6 * x4 * x6);
+        z21 = 6 * a2 * a5 + deep_arg.eosq * (24 * x1 * x5 - 6 * x3 * x7);
+        z22 = 6 * (a4 * a5 + a2 * a6)
+                + deep_arg.eosq
+                        * (24 * (x2 * x5 + x1 * x6)
+                                - 6 * (x4 * x7 + x3 * x8));
+        z23 = 6 * a4 * a6 + deep_arg.eosq * (24 * x2 * x6 - 6 * x4 * x8);
+        z1 = z1 + z1 + deep_arg.betao2 * z31;
+        z2 = z2 + z2 + deep_arg.betao2 * z32;
+        z3 = z3 + z3 + deep_arg.betao2 * z33;
+        s3 = cc * xnoi;
+        s2 = -0.5 * s3 / deep_arg.betao;
+        s4 = s3 * deep_arg.betao;
+        s1 = -15 * eq * s4;
+        s5 = x1 * x3 + x2 * x4;
+        s6 = x2 * x3 + x1 * x4;
+        s7 = x2 * x4 - x1 * x3;
+        se = s1 * zn * s5;
+        si = s2 * zn * (z11 + z13);
+        sl = -zn * s3 * (z1 + z3 - 14 - 6 * deep_arg.eosq);
+        sgh = s4 * zn * (z31 + z33 - 6);
+        sh = -zn * s2 * (z21 + z23);
+
+        if (xqncl < 5.2359877E-2) {
+            sh = 0;
+        }
 
-            sini2 = deep_arg.sinio * deep_arg.sinio;
-            f220 = 0.75 * (1 + 2 * deep_arg.cosio + deep_arg.theta2);
-            f221 = 1.5 * sini2;
-            f321 = 1.875 * deep_arg.sinio
-                    * (1 - 2 * deep_arg.cosio - 3 * deep_arg.theta2);
-            f322 = -1.875 * deep_arg.sinio
-                    * (1 + 2 * deep_arg.cosio - 3 * deep_arg.theta2);
-            f441 = 35 * sini2 * f220;
-            f442 = 39.3750 * sini2 * sini2;
-            f522 = 9.84375 * deep_arg.sinio
-                    * (sini2 * (1 - 2 * deep_arg.cosio - 5 * deep_arg.theta2)
-                            + 0.33333333
-                                    * (-2 + 4 * deep_arg.cosio
-                                            + 6 * deep_arg.theta2));
-            f523 = deep_arg.sinio
-                    * (4.92187512 * sini2
-                            * (-2 - 4 * deep_arg.cosio + 10 * deep_arg.theta2)
-                            + 6.56250012
-                                    * (1 + 2 * deep_arg.cosio
-                                            - 3 * deep_arg.theta2));
-            f542 = 29.53125 * deep_arg.sinio
-                    * (2 - 8 * deep_arg.cosio
-                            + deep_arg.theta2
-                                    * (-12 + 8 * deep_arg.cosio
-                                            + 10 * deep_arg.theta2));
-            f543 = 29.53125 * deep_arg.sinio
-                    * (-2 - 8 * deep_arg.cosio
-                            + deep_arg.theta2
-                                    * (12 + 8 * deep_arg.cosio
-                                            - 10 * deep_arg.theta2));
-            xno2 = xnq * xnq;
-            ainv2 = aqnv * aqnv;
-            temp1 = 3 * xno2 * ainv2;
-            temp = temp1 * ROOT22;
-            d2201 = temp * f220 * g201;
-            d2211 = temp * f221 * g211;
-            temp1 = temp1 * aqnv;
-            temp = temp1 * ROOT32;
-            d3210 = temp * f321 * g310;
-            d3222 = temp * f322 * g322;
-            temp1 = temp1 * aqnv;
-            temp = 2 * temp1 * ROOT44;
-            d4410 = temp * f441 * g410;
-            d4422 = temp * f442 * g422;
-            temp1 = temp1 * aqnv;
-            temp = temp1 * ROOT52;
-            d5220 = temp * f522 * g520;
-            d5232 = temp * f523 * g532;
-            temp = 2 * temp1 * ROOT54;
-            d5421 = temp * f542 * g521;
-            d5433 = temp * f543 * g533;
-            xlamo = xmao + tle_xnodeo + tle_xnodeo - thgr - thgr;
-            bfact = deep_arg.xmdot + deep_arg.xnodot + deep_arg.xnodot - THDT
-                    - THDT;
-            bfact = bfact + ssl + ssh + ssh;
-        } else {
-            resonance = true;
-            synchronous = true;
-
-            // Synchronous resonance terms initialization
-            g200 = 1 + deep_arg.eosq * (-2.5 + 0.8125 * deep_arg.eosq);
-            g310 = 1 + 2 * deep_arg.eosq;
-            g300 = 1 + deep_arg.eosq * (-6 + 6.60937 * deep_arg.eosq);
-            f220 = 0.75 * (1 + deep_arg.cosio) * (1 + deep_arg.cosio);
-            f311 = 0.9375 * deep_arg.sinio * deep_arg.sinio
-                    * (1 + 3 * deep_arg.cosio) - 0.75 * (1 + deep_arg.cosio);
-            f330 = 1 + deep_arg.cosio;
-            f330 = 1.875 * f330 * f330 * f330;
-            del1 = 3 * xnq * xnq * aqnv * aqnv;
-            del2 = 2 * del1 * f220 * g200 * Q22;
-            del3 = 3 * del1 * f330 * g300 * Q33 * aqnv;
-            del1 = del1 * f311 * g310 * Q31 * aqnv;
-            fasx2 = 0.13130908;
-            fasx4 = 2.8843198;
-            fasx6 = 0.37448087;
-            xlamo = xmao + tle_xnodeo + tle_omegao - thgr;
-            bfact = deep_arg.xmdot + xpidot - THDT;
-            bfact = bfact + ssl + ssg + ssh;
+        ee2 = 2 * s1 * s6;
+        e3 = 2 * s1 * s7;
+        xi2 = 2 * s2 * z12;
+        xi3 = 2 * s2 * (z13 - z11);
+        xl2 = -2 * s3 * z2;
+        xl3 = -2 * s3 * (z3 - z1);
+        xl4 = -2 * s3 * (-21 - 9 * deep_arg.eosq) * ze;
+        xgh2 = 2 * s4 * z32;
+        xgh3 = 2 * s4 * (z33 - z31);
+        xgh4 = -18 * s4 * ze;
+        xh2 = -2 * s2 * z22;
+        xh3 = -2 * s2 * (z23 - z21);
+
+        if (lunar_terms_done) {
+            break;
         }
 
-        xfact = bfact - xnq;
+        // Do lunar terms
+        sse = se;
+        ssi = si;
+        ssl = sl;
+        ssh = sh / deep_arg.sinio;
+        ssg = sgh - deep_arg.cosio * ssh;
+        se2 = ee2;
+        si2 = xi2;
+        sl2 = xl2;
+        sgh2 = xgh2;
+        sh2 = xh2;
+        se3 = e3;
+        si3 = xi3;
+        sl3 = xl3;
+        sgh3 = xgh3;
+        sh3 = xh3;
+        sl4 = xl4;
+        sgh4 = xgh4;
+        zcosg = zcosgl;
+        zsing = zsingl;
+        zcosi = zcosil;
+        zsini = zsinil;
+        zcosh = zcoshl * cosq + zsinhl * sinq;
+        zsinh = sinq * zcoshl - cosq * zsinhl;
+        zn = ZNL;
+        cc = C1L;
+        ze = ZEL;
+        lunar_terms_done = true;
+    }
 
-        // Initialize integrator
-        xli = xlamo;
-        xni = xnq;
-        atime = 0;
-        stepp = 720;
-        stepn = -720;
-        step2 = 259200;
+    sse = sse + se;
+    ssi = ssi + si;
+    ssl = ssl + sl;
+    ssg = ssg + sgh - deep_arg.cosio / deep_arg.sinio * sh;
+    ssh = ssh + sh / deep_arg.sinio;
 
-        return;
+    // Geopotential resonance initialization for 12 hour orbits
+    regime_ = DEEP_SPACE;
 
-    case DPSEC: // Entrance for deep space secular effects
-        deep_arg.xll = deep_arg.xll + ssl * deep_arg.t;
-        deep_arg.omgadf = deep_arg.omgadf + ssg * deep_arg.t;
-        deep_arg.xnode = deep_arg.xnode + ssh * deep_arg.t;
-        deep_arg.em = tle_eo + sse * deep_arg.t;
-        deep_arg.xinc = tle_xincl + ssi * deep_arg.t;
-
-        if (deep_arg.xinc < 0) {
-            deep_arg.xinc = -deep_arg.xinc;
-            deep_arg.xnode = deep_arg.xnode + M_PI;
-            deep_arg.omgadf = deep_arg.omgadf - M_PI;
+    if (!((xnq < 0.0052359877) && (xnq > 0.0034906585))) {
+        if ((xnq < 0.00826) || (xnq > 0.00924)) {
+            return;
         }
 
-        if (!resonance) {
+        if (eq < 0.5) {
             return;
         }
 
-        do {
-            if ((atime == 0) || ((deep_arg.t >= 0) && (atime < 0))
-                    || ((deep_arg.t < 0) && (atime >= 0))) {
-                /* Epoch restart */
-                delt = deep_arg.t >= 0 ? stepp : stepn;
-                atime = 0;
-                xni = xnq;
-                xli = xlamo;
+        regime_ = DEEP_SPACE_HALF_DAY;
+        eoc = eq * deep_arg.eosq;
+        g201 = -0.306 - (eq - 0.64) * 0.440;
+
+        if (eq <= 0.65) {
+            g211 = 3.616 - 13.247 * eq + 16.290 * deep_arg.eosq;
+            g310 = -19.302 + 117.390 * eq - 228.419 * deep_arg.eosq
+                    + 156.591 * eoc;
+            g322 = -18.9068 + 109.7927 * eq - 214.6334 * deep_arg.eosq
+                    + 146.5816 * eoc;
+            g410 = -41.122 + 242.694 * eq - 471.094 * deep_arg.eosq
+                    + 313.953 * eoc;
+            g422 = -146.407 + 841.880 * eq - 1629.014 * deep_arg.eosq
+                    + 1083.435 * eoc;
+            g520 = -532.114 + 3017.977 * eq - 5740 * deep_arg.eosq
+                    + 3708.276 * eoc;
+        } else {
+            g211 = -72.099 + 331.819 * eq - 508.738 * deep_arg.eosq
+                    + 266.724 * eoc;
+            g310 = -346.844 + 1582.851 * eq - 2415.925 * deep_arg.eosq
+                    + 1246.113 * eoc;
+            g322 = -342.585 + 1554.908 * eq - 2366.899 * deep_arg.eosq
+                    + 1215.972 * eoc;
+            g410 = -1052.797 + 4758.686 * eq - 7193.992 * deep_arg.eosq
+                    + 3651.957 * eoc;
+            g422 = -3581.69 + 16178.11 * eq - 24462.77 * deep_arg.eosq
+                    + 12422.52 * eoc;
+
+            if (eq <= 0.715) {
+                g520 = 1464.74 - 4664.75 * eq + 3763.64 * deep_arg.eosq;
             } else {
-                if (fabs(deep_arg.t) >= fabs(atime)) {
-                    delt = deep_arg.t > 0 ? stepp : stepn;
-                }
+                g520 = -5149.66 + 29936.92 * eq - 54087.36 * deep_arg.eosq
+                        + 31324.56 * eoc;
             }
+        }
 
-            do {
-                if (fabs(deep_arg.t - atime) >= stepp) {
-                    do_loop = true;
-                    epoch_restart = false;
-                } else {
-                    ft = deep_arg.t - atime;
-                    do_loop = false;
-                }
-
-                if (fabs(deep_arg.t) < fabs(atime)) {
-                    delt = deep_arg.t >= 0 ? stepn : stepp;
-                    do_loop = epoch_restart = true;
-                }
-
-                // Dot terms calculated
-                if (synchronous) {
-                    xndot = del1 * sin(xli - fasx2)
-                            + del2 * sin(2 * (xli - fasx4))
-                            + del3 * sin(3 * (xli - fasx6));
-                    xnddt = del1 * cos(xli - fasx2)
-                            + 2 * del2 * cos(2 * (xli - fasx4))
-                            + 3 * del3 * cos(3 * (xli - fasx6));
-                } else {
-                    xomi = omegaq + deep_arg.omgdot * atime;
-                    x2omi = xomi + xomi;
-                    x2li = xli + xli;
-                    xndot = d2201 * sin(x2omi + xli - G22)
-                            + d2211 * sin(xli - G22)
-                            + d3210 * sin(xomi + xli - G32)
-                            + d3222 * sin(-xomi + xli - G32)
-                            + d4410 * sin(x2omi + x2li - G44)
-                            + d4422 * sin(x2li - G44)
-                            + d5220 * sin(xomi + xli - G52)
-                            + d5232 * sin(-xomi + xli - G52)
-                            + d5421 * sin(xomi + x2li - G54)
-                            + d5433 * sin(-xomi + x2li - G54);
-                    xnddt = d2201 * cos(x2omi + xli - G22)
-                            + d2211 * cos(xli - G22)
-                            + d3210 * cos(xomi + xli - G32)
-                            + d3222 * cos(-xomi + xli - G32)
-                            + d5220 * cos(xomi + xli - G52)
-                            + d5232 * cos(-xomi + xli - G52)
-                            + 2
-                                    * (d4410 * cos(x2omi + x2li - G44)
-                                            + d4422 * cos(x2li - G44)
-                                            + d5421 * cos(xomi + x2li - G54)
-                                            + d5433 * cos(-xomi + x2li - G54));
-                }
-
-                xldot = xni + xfact;
-                xnddt = xnddt * xldot;
-
-                if (do_loop) {
-                    xli = xli + xldot * delt + xndot * step2;
-                    xni = xni + xndot * delt + xnddt * step2;
-                    atime = atime + delt;
-                }
-            } while (do_loop && !epoch_restart);
-        } while (do_loop && epoch_restart);
-
-        deep_arg.xn = xni + xndot * ft + xnddt * ft * ft * 0.5;
-        xl = xli + xldot * ft + xndot * ft * ft * 0.5;
-        temp = -deep_arg.xnode + thgr + deep_arg.t * THDT;
-
-        if (!synchronous) {
-            deep_arg.xll = xl + temp + temp;
+        if (eq < 0.7) {
+            g533 = -919.2277 + 4988.61 * eq - 9064.77 * deep_arg.eosq
+                    + 5542.21 * eoc;
+            g521 = -822.71072 + 4568.6173 * eq - 8491.4146 * deep_arg.eosq
+                    + 5337.524 * eoc;
+            g532 = -853.666 + 4690.25 * eq - 8624.77 * deep_arg.eosq
+                    + 5341.4 * eoc;
         } else {
-            deep_arg.xll = xl - deep_arg.omgadf + temp;
+            g533 = -37995.78 + 161616.52 * eq - 229838.2 * deep_arg.eosq
+                    + 109377.94 * eoc;
+            g521 = -51752.104 + 218913.95 * eq - 309468.16 * deep_arg.eosq
+                    + 146349.42 * eoc;
+            g532 = -40023.88 + 170470.89 * eq - 242699.48 * deep_arg.eosq
+                    + 115605.82 * eoc;
         }
 
+        sini2 = deep_arg.sinio * deep_arg.sinio;
+        f220 = 0.75 * (1 + 2 * deep_arg.cosio + deep_arg.theta2);
+        f221 = 1.5 * sini2;
+        f321 = 1.875 * deep_arg.sinio
+                * (1 - 2 * deep_arg.cosio - 3 * deep_arg.theta2);
+        f322 = -1.875 * deep_arg.sinio
+                * (1 + 2 * deep_arg.cosio - 3 * deep_arg.theta2);
+        f441 = 35 * sini2 * f220;
+        f442 = 39.3750 * sini2 * sini2;
+        f522 = 9.84375 * deep_arg.sinio
+                * (sini2 * (1 - 2 * deep_arg.cosio - 5 * deep_arg.theta2)
+                        + 0.33333333
+                                * (-2 + 4 * deep_arg.cosio
+                                        + 6 * deep_arg.theta2));
+        f523 = deep_arg.sinio
+                * (4.92187512 * sini2
+                        * (-2 - 4 * deep_arg.cosio + 10 * deep_arg.theta2)
+                        + 6.56250012
+                                * (1 + 2 * deep_arg.cosio
+                                        - 3 * deep_arg.theta2));
+        f542 = 29.53125 * deep_arg.sinio
+                * (2 - 8 * deep_arg.cosio
+                        + deep_arg.theta2
+                                * (-12 + 8 * deep_arg.cosio
+                                        + 10 * deep_arg.theta2));
+        f543 = 29.53125 * deep_arg.sinio
+                * (-2 - 8 * deep_arg.cosio
+                        + deep_arg.theta2
+                                * (12 + 8 * deep_arg.cosio
+                                        - 10 * deep_arg.theta2));
+        xno2 = xnq * xnq;
+        ainv2 = aqnv * aqnv;
+        temp1 = 3 * xno2 * ainv2;
+        temp = temp1 * ROOT22;
+        half_day_.d2201 = temp * f220 * g201;
+        half_day_.d2211 = temp * f221 * g211;
+        temp1 = temp1 * aqnv;
+        temp = temp1 * ROOT32;
+        half_day_.d3210 = temp * f321 * g310;
+        half_day_.d3222 = temp * f322 * g322;
+        temp1 = temp1 * aqnv;
+        temp = 2 * temp1 * ROOT44;
+        half_day_.d4410 = temp * f441 * g410;
+        half_day_.d4422 = temp * f442 * g422;
+        temp1 = temp1 * aqnv;
+        temp = temp1 * ROOT52;
+        half_day_.d5220 = temp * f522 * g520;
+        half_day_.d5232 = temp * f523 * g532;
+        temp = 2 * temp1 * ROOT54;
+        half_day_.d5421 = temp * f542 * g521;
+        half_day_.d5433 = temp * f543 * g533;
+        xlamo = xmao + tle_xnodeo + tle_xnodeo - thgr - thgr;
+        bfact = deep_arg.xmdot + deep_arg.xnodot + deep_arg.xnodot - THDT
+                - THDT;
+        bfact = bfact + ssl + ssh + ssh;
+    } else {
+        regime_ = DEEP_SPACE_SYNCHRONOUS;
+
+        // Synchronous resonance terms initialization
+        g200 = 1 + deep_arg.eosq * (-2.5 + 0.8125 * deep_arg.eosq);
+        g310 = 1 + 2 * deep_arg.eosq;
+        g300 = 1 + deep_arg.eosq * (-6 + 6.60937 * deep_arg.eosq);
+        f220 = 0.75 * (1 + deep_arg.cosio) * (1 + deep_arg.cosio);
+        f311 = 0.9375 * deep_arg.sinio * deep_arg.sinio
+                * (1 + 3 * deep_arg.cosio) - 0.75 * (1 + deep_arg.cosio);
+        f330 = 1 + deep_arg.cosio;
+        f330 = 1.875 * f330 * f330 * f330;
+        sync_.del1 = 3 * xnq * xnq * aqnv * aqnv;
+        sync_.del2 = 2 * sync_.del1 * f220 * g200 * Q22;
+        sync_.del3 = 3 * sync_.del1 * f330 * g300 * Q33 * aqnv;
+        sync_.del1 = sync_.del1 * f311 * g310 * Q31 * aqnv;
+        sync_.fasx2 = 0.13130908;
+        sync_.fasx4 = 2.8843198;
+        sync_.fasx6 = 0.37448087;
+        xlamo = xmao + tle_xnodeo + tle_omegao - thgr;
+        bfact = deep_arg.xmdot + xpidot - THDT;
+        bfact = bfact + ssl + ssg + ssh;
+    }
+
+    xfact = bfact - xnq;
+
+    // Initialize integrator
+    ResetState();
+}
+
+void DeepSpacePropagator::ResetState() {
+    savtsn = 1E20;
+    if (regime_ == DEEP_SPACE) {
         return;
+    }
+    xli = xlamo;
+    xni = xnq;
+    atime = 0;
+    stepp = 720;
+    stepn = -720;
+    step2 = 259200;
+    for (size_t i = 0; i < 2; ++i) {
+        checkpoint_[i].clear();
+        checkpoint_[i].push_back({xli, xni});
+    }
+}
 
-    case DPPER: // Entrance for lunar-solar periodics
-        sinis = sin(deep_arg.xinc);
-        cosis = cos(deep_arg.xinc);
-
-        if (fabs(savtsn - deep_arg.t) >= 30) {
-            savtsn = deep_arg.t;
-            zm = zmos + ZNS * deep_arg.t;
-            zf = zm + 2 * ZES * sin(zm);
-            sinzf = sin(zf);
-            f2 = 0.5 * sinzf * sinzf - 0.25;
-            f3 = -0.5 * sinzf * cos(zf);
-            ses = se2 * f2 + se3 * f3;
-            sis = si2 * f2 + si3 * f3;
-            sls = sl2 * f2 + sl3 * f3 + sl4 * sinzf;
-            sghs = sgh2 * f2 + sgh3 * f3 + sgh4 * sinzf;
-            shs = sh2 * f2 + sh3 * f3;
-            zm = zmol + ZNL * deep_arg.t;
-            zf = zm + 2 * ZEL * sin(zm);
-            sinzf = sin(zf);
-            f2 = 0.5 * sinzf * sinzf - 0.25;
-            f3 = -0.5 * sinzf * cos(zf);
-            sel = ee2 * f2 + e3 * f3;
-            sil = xi2 * f2 + xi3 * f3;
-            sll = xl2 * f2 + xl3 * f3 + xl4 * sinzf;
-            sghl = xgh2 * f2 + xgh3 * f3 + xgh4 * sinzf;
-            sh1 = xh2 * f2 + xh3 * f3;
-            pe = ses + sel;
-            pinc = sis + sil;
-            pl = sls + sll;
-        }
+template<REGIMES REGIME>
+void DeepSpacePropagator::DeepSecular() {
+    // Deep space secular effects, with the resonance integrator
+    // of the regime
+    double ft, xndot, xnddt, xldot, xl, temp;
+
+    deep_arg.xll = deep_arg.xll + ssl * deep_arg.t;
+    deep_arg.omgadf = deep_arg.omgadf + ssg * deep_arg.t;
+    deep_arg.xnode = deep_arg.xnode + ssh * deep_arg.t;
+    deep_arg.em = tle_eo + sse * deep_arg.t;
+    deep_arg.xinc = tle_xincl + ssi * deep_arg.t;
+
+    if (deep_arg.xinc < 0) {
+        deep_arg.xinc = -deep_arg.xinc;
+        deep_arg.xnode = deep_arg.xnode + M_PI;
+        deep_arg.omgadf = deep_arg.omgadf - M_PI;
+    }
 
-        pgh = sghs + sghl;
-        ph = shs + sh1;
-        deep_arg.xinc = deep_arg.xinc + pinc;
-        deep_arg.em = deep_arg.em + pe;
-
-        if (xqncl >= 0.2) {
-            // Apply periodics directly
-            ph = ph / deep_arg.sinio;
-            pgh = pgh - deep_arg.cosio * ph;
-            deep_arg.omgadf = deep_arg.omgadf + pgh;
-            deep_arg.xnode = deep_arg.xnode + ph;
-            deep_arg.xll = deep_arg.xll + pl;
-        } else {
-            // Apply periodics with Lyddane modification
-            sinok = sin(deep_arg.xnode);
-            cosok = cos(deep_arg.xnode);
-            alfdp = sinis * sinok;
-            betdp = sinis * cosok;
-            dalf = ph * cosok + pinc * cosis * sinok;
-            dbet = -ph * sinok + pinc * cosis * cosok;
-            alfdp = alfdp + dalf;
-            betdp = betdp + dbet;
-            deep_arg.xnode = FMod2p(deep_arg.xnode);
-            xls = deep_arg.xll + deep_arg.omgadf + cosis * deep_arg.xnode;
-            dls = pl + pgh - pinc * deep_arg.xnode * sinis;
-            xls = xls + dls;
-            xnoh = deep_arg.xnode;
-            deep_arg.xnode = AcTan(alfdp, betdp);
-            if (fabs(xnoh - deep_arg.xnode) > M_PI) {
-                if (deep_arg.xnode < xnoh) {
-                    deep_arg.xnode += TWOPI;
-                } else {
-                    deep_arg.xnode -= TWOPI;
-                }
+    if (REGIME == DEEP_SPACE) {
+        return;
+    }
+
+    // The integrator state is resumed from the nearest checkpoint,
+    // it gives exactly the same result as the integration from epoch
+    ResonanceStep<REGIME>(deep_arg.t);
+    ft = deep_arg.t - atime;
+    ResonanceDots<REGIME>(xndot, xnddt, xldot);
+
+    deep_arg.xn = xni + xndot * ft + xnddt * ft * ft * 0.5;
+    xl = xli + xldot * ft + xndot * ft * ft * 0.5;
+    temp = -deep_arg.xnode + thgr + deep_arg.t * THDT;
+
+    if (REGIME != DEEP_SPACE_SYNCHRONOUS) {
+        deep_arg.xll = xl + temp + temp;
+    } else {
+        deep_arg.xll = xl - deep_arg.omgadf + temp;
+    }
+}
+
+void DeepSpacePropagator::DeepPeriodics() {
+    // Lunar-solar periodics
+    double sinis, cosis, zm, zf, sinzf, f2, f3, ses, sis, sls, sel, sil, sll,
+            pgh, ph, sinok, cosok, alfdp, betdp, dalf, dbet, xls, dls, xnoh;
+
+    sinis = sin(deep_arg.xinc);
+    cosis = cos(deep_arg.xinc);
+
+    // The calculator outlives a single call, so refresh the periodics
+    // for every new time instead of the original 30 minutes window
+    // to keep the results the same as for the fresh calculator.
+    if (savtsn != deep_arg.t) {
+        savtsn = deep_arg.t;
+        zm = zmos + ZNS * deep_arg.t;
+        zf = zm + 2 * ZES * sin(zm);
+        sinzf = sin(zf);
+        f2 = 0.5 * sinzf * sinzf - 0.25;
+        f3 = -0.5 * sinzf * cos(zf);
+        ses = se2 * f2 + se3 * f3;
+        sis = si2 * f2 + si3 * f3;
+        sls = sl2 * f2 + sl3 * f3 + sl4 * sinzf;
+        sghs = sgh2 * f2 + sgh3 * f3 + sgh4 * sinzf;
+        shs = sh2 * f2 + sh3 * f3;
+        zm = zmol + ZNL * deep_arg.t;
+        zf = zm + 2 * ZEL * sin(zm);
+        sinzf = sin(zf);
+        f2 = 0.5 * sinzf * sinzf - 0.25;
+        f3 = -0.5 * sinzf * cos(zf);
+        sel = ee2 * f2 + e3 * f3;
+        sil = xi2 * f2 + xi3 * f3;
+        sll = xl2 * f2 + xl3 * f3 + xl4 * sinzf;
+        sghl = xgh2 * f2 + xgh3 * f3 + xgh4 * sinzf;
+        sh1 = xh2 * f2 + xh3 * f3;
+        pe = ses + sel;
+        pinc = sis + sil;
+        pl = sls + sll;
+    }
+
+    pgh = sghs + sghl;
+    ph = shs + sh1;
+    deep_arg.xinc = deep_arg.xinc + pinc;
+    deep_arg.em = deep_arg.em + pe;
+
+    if (xqncl >= 0.2) {
+        // Apply periodics directly
+        ph = ph / deep_arg.sinio;
+        pgh = pgh - deep_arg.cosio * ph;
+        deep_arg.omgadf = deep_arg.omgadf + pgh;
+        deep_arg.xnode = deep_arg.xnode + ph;
+        deep_arg.xll = deep_arg.xll + pl;
+    } else {
+        // Apply periodics with Lyddane modification
+        sinok = sin(deep_arg.xnode);
+        cosok = cos(deep_arg.xnode);
+        alfdp = sinis * sinok;
+        betdp = sinis * cosok;
+        dalf = ph * cosok + pinc * cosis * sinok;
+        dbet = -ph * sinok + pinc * cosis * cosok;
+        alfdp = alfdp + dalf;
+        betdp = betdp + dbet;
+        deep_arg.xnode = FMod2p(deep_arg.xnode);
+        xls = deep_arg.xll + deep_arg.omgadf + cosis * deep_arg.xnode;
+        dls = pl + pgh - pinc * deep_arg.xnode * sinis;
+        xls = xls + dls;
+        xnoh = deep_arg.xnode;
+        deep_arg.xnode = AcTan(alfdp, betdp);
+        if (fabs(xnoh - deep_arg.xnode) > M_PI) {
+            if (deep_arg.xnode < xnoh) {
+                deep_arg.xnode += TWOPI;
+            } else {
+                deep_arg.xnode -= TWOPI;
             }
-            deep_arg.xll = deep_arg.xll + pl;
-            deep_arg.omgadf = xls - deep_arg.xll
-                    - cos(deep_arg.xinc) * deep_arg.xnode;
         }
-        return;
-        default: break;
+        deep_arg.xll = deep_arg.xll + pl;
+        deep_arg.omgadf = xls - deep_arg.xll
+                - cos(deep_arg.xinc) * deep_arg.xnode;
+    }
+}
+
+template<REGIMES REGIME>
+void DeepSpacePropagator::ResonanceDots(double &xndot, double &xnddt,
+    double &xldot) {
+    // Dot terms of the resonance integrator at its current state
+    double xomi, x2omi, x2li;
+
+    if (REGIME == DEEP_SPACE_SYNCHRONOUS) {
+        xndot = sync_.del1 * sin(xli - sync_.fasx2)
+                + sync_.del2 * sin(2 * (xli - sync_.fasx4))
+                + sync_.del3 * sin(3 * (xli - sync_.fasx6));
+        xnddt = sync_.del1 * cos(xli - sync_.fasx2)
+                + 2 * sync_.del2 * cos(2 * (xli - sync_.fasx4))
+                + 3 * sync_.del3 * cos(3 * (xli - sync_.fasx6));
+    } else {
+        xomi = omegaq + deep_arg.omgdot * atime;
+        x2omi = xomi + xomi;
+        x2li = xli + xli;
+        xndot = half_day_.d2201 * sin(x2omi + xli - G22)
+                + half_day_.d2211 * sin(xli - G22)
+                + half_day_.d3210 * sin(xomi + xli - G32)
+                + half_day_.d3222 * sin(-xomi + xli - G32)
+                + half_day_.d4410 * sin(x2omi + x2li - G44)
+                + half_day_.d4422 * sin(x2li - G44)
+                + half_day_.d5220 * sin(xomi + xli - G52)
+                + half_day_.d5232 * sin(-xomi + xli - G52)
+                + half_day_.d5421 * sin(xomi + x2li - G54)
+                + half_day_.d5433 * sin(-xomi + x2li - G54);
+        xnddt = half_day_.d2201 * cos(x2omi + xli - G22)
+                + half_day_.d2211 * cos(xli - G22)
+                + half_day_.d3210 * cos(xomi + xli - G32)
+                + half_day_.d3222 * cos(-xomi + xli - G32)
+                + half_day_.d5220 * cos(xomi + xli - G52)
+                + half_day_.d5232 * cos(-xomi + xli - G52)
+                + 2
+                        * (half_day_.d4410 * cos(x2omi + x2li - G44)
+                                + half_day_.d4422 * cos(x2li - G44)
+                                + half_day_.d5421 * cos(xomi + x2li - G54)
+                                + half_day_.d5433 * cos(-xomi + x2li - G54));
     }
+
+    xldot = xni + xfact;
+    xnddt = xnddt * xldot;
 }
 
-void SatelliteCalc::SDP4(double tsince, vector_t &pos, vector_t &vel) {
+template<REGIMES REGIME>
+void DeepSpacePropagator::ResonanceStep(double t) {
+    // Moves the resonance integrator to the last whole step before t.
+    // The integration from epoch always steps away from it, so the states
+    // on both sides are fixed sequences: every CHECKPOINT_STEPS-th state is
+    // stored and the integration continues from the nearest stored state
+    // (or from the current one) instead of starting from epoch.
+    size_t dir = t >= 0 ? 0 : 1;
+    double delt = t >= 0 ? stepp : stepn;
+
+    // Number of steps the integration from epoch does
+    long steps = (long)(fabs(t) / stepp);
+    while (steps > 0 && fabs(t - (steps - 1) * delt) < stepp) {
+        --steps;
+    }
+    while (fabs(t - steps * delt) >= stepp) {
+        ++steps;
+    }
+
+    // Continue from the current state if the nearest checkpoint
+    // is not closer
+    std::vector<resonance_state_t> &checkpoint = checkpoint_[dir];
+    long num = std::min(steps / CHECKPOINT_STEPS,
+        (long)checkpoint.size() - 1);
+    long current = (long)(atime / delt);
+    bool same_side = atime == 0 || (atime > 0) == (delt > 0);
+    if (!same_side || current > steps || current < num * CHECKPOINT_STEPS) {
+        xli = checkpoint[num].xli;
+        xni = checkpoint[num].xni;
+        current = num * CHECKPOINT_STEPS;
+        atime = current * delt;
+    }
+
+    double xndot, xnddt, xldot;
+    while (current < steps) {
+        ResonanceDots<REGIME>(xndot, xnddt, xldot);
+        xli = xli + xldot * delt + xndot * step2;
+        xni = xni + xndot * delt + xnddt * step2;
+        atime = atime + delt;
+        ++current;
+        if (current == (long)checkpoint.size() * CHECKPOINT_STEPS) {
+            checkpoint.push_back({xli, xni});
+        }
+    }
+}
+
+template<REGIMES REGIME>
+void DeepSpacePropagator::Propagate(double tsince, vector_t &pos,
+    vector_t &vel) {
     // This function is used to calculate the position and velocity
     // of deep-space (period > 225 minutes) satellites. tsince is
     // time since epoch in minutes, pos and vel are vector_t structures
@@ -1094,103 +1298,12 @@ void SatelliteCalc::SDP4(double tsince, vector_t &pos, vector_t &vel) {
 
     int i;
     double a, axn, ayn, aynl, beta, betal, capu, cos2u, cosepw, cosik, cosnok,
-            cosu, cosuk, ecose, elsq, epw, esine, pl, theta4, rdot, rdotk,
-            rfdot, rfdotk, rk, sin2u, sinepw, sinik, sinnok, sinu, sinuk, tempe,
-            templ, tsq, u, uk, ux, uy, uz, vx, vy, vz, xinck, xl, xlt, xmam,
-            xmdf, xmx, xmy, xnoddf, xnodek, xll, a1, a3ovk2, ao, c2, coef,
-            coef1, x1m5th, xhdot1, del1, r, delo, eeta, eta, etasq, perigee,
-            psisq, tsi, qoms24, s4, pinvsq, temp, tempa, temp1, temp2, temp3,
+            cosu, cosuk, ecose, elsq, epw, esine, pl, rdot, rdotk, rfdot,
+            rfdotk, rk, sin2u, sinepw, sinik, sinnok, sinu, sinuk, tempe, templ,
+            tsq, u, uk, ux, uy, uz, vx, vy, vz, xinck, xl, xlt, xmam, xmdf, xmx,
+            xmy, xnoddf, xnodek, xll, r, temp, tempa, temp1, temp2, temp3,
             temp4, temp5, temp6;
 
-    // Initialization
-    if (!sdp4_initialized) {
-        sdp4_initialized = true;
-
-        // Recover original mean motion (xnodp) and
-        // semimajor axis (aodp) from input elements.
-        a1 = pow(XKE / tle_xno, TOTHRD);
-        deep_arg.cosio = cos(tle_xincl);
-        deep_arg.theta2 = deep_arg.cosio * deep_arg.cosio;
-        x3thm1 = 3 * deep_arg.theta2 - 1;
-        deep_arg.eosq = tle_eo * tle_eo;
-        deep_arg.betao2 = 1 - deep_arg.eosq;
-        deep_arg.betao = sqrt(deep_arg.betao2);
-        del1 = 1.5 * CK2 * x3thm1
-                / (a1 * a1 * deep_arg.betao * deep_arg.betao2);
-        ao = a1 * (1 - del1 * (0.5 * TOTHRD + del1 * (1 + 134 / 81 * del1)));
-        delo = 1.5 * CK2 * x3thm1
-                / (ao * ao * deep_arg.betao * deep_arg.betao2);
-        deep_arg.xnodp = tle_xno / (1 + delo);
-        deep_arg.aodp = ao / (1 - delo);
-
-        // For perigee below 156 km, the values of s and QOMS2T are altered.
-        s4 = S4_INIT;
-        qoms24 = QOMS2T;
-        perigee = (deep_arg.aodp * (1 - tle_eo) - AE) * XKMPER;
-
-        if (perigee < 156.0) {
-            s4 = perigee <= 98.0 ? 20.0 : perigee - 78.0;
-            qoms24 = pow((120 - s4) * AE / XKMPER, 4);
-            s4 = s4 / XKMPER + AE;
-        }
-
-        pinvsq = 1
-                / (deep_arg.aodp * deep_arg.aodp * deep_arg.betao2
-                        * deep_arg.betao2);
-        deep_arg.sing = sin(tle_omegao);
-        deep_arg.cosg = cos(tle_omegao);
-        tsi = 1 / (deep_arg.aodp - s4);
-        eta = deep_arg.aodp * tle_eo * tsi;
-        etasq = eta * eta;
-        eeta = tle_eo * eta;
-        psisq = fabs(1 - etasq);
-        coef = qoms24 * pow(tsi, 4);
-        coef1 = coef / pow(psisq, 3.5);
-        c2 = coef1 * deep_arg.xnodp
-                * (deep_arg.aodp * (1 + 1.5 * etasq + eeta * (4 + etasq))
-                        + 0.75 * CK2 * tsi / psisq * x3thm1
-                                * (8 + 3 * etasq * (8 + etasq)));
-        c1 = tle_bstar * c2;
-        deep_arg.sinio = sin(tle_xincl);
-        a3ovk2 = -XJ3 / CK2 * pow(AE, 3);
-        x1mth2 = 1 - deep_arg.theta2;
-        c4 = 2 * deep_arg.xnodp * coef1 * deep_arg.aodp * deep_arg.betao2
-                * (eta * (2 + 0.5 * etasq) + tle_eo * (0.5 + 2 * etasq)
-                        - 2 * CK2 * tsi / (deep_arg.aodp * psisq)
-                                * (-3 * x3thm1
-                                        * (1 - 2 * eeta
-                                                + etasq * (1.5 - 0.5 * eeta))
-                                        + 0.75 * x1mth2
-                                                * (2 * etasq
-                                                        - eeta * (1 + etasq))
-                                                * cos(2 * tle_omegao)));
-        theta4 = deep_arg.theta2 * deep_arg.theta2;
-        temp1 = 3 * CK2 * pinvsq * deep_arg.xnodp;
-        temp2 = temp1 * CK2 * pinvsq;
-        temp3 = 1.25 * CK4 * pinvsq * pinvsq * deep_arg.xnodp;
-        deep_arg.xmdot = deep_arg.xnodp + 0.5 * temp1 * deep_arg.betao * x3thm1
-                + 0.0625 * temp2 * deep_arg.betao
-                        * (13 - 78 * deep_arg.theta2 + 137 * theta4);
-        x1m5th = 1 - 5 * deep_arg.theta2;
-        deep_arg.omgdot = -0.5 * temp1 * x1m5th
-                + 0.0625 * temp2 * (7 - 114 * deep_arg.theta2 + 395 * theta4)
-                + temp3 * (3 - 36 * deep_arg.theta2 + 49 * theta4);
-        xhdot1 = -temp1 * deep_arg.cosio;
-        deep_arg.xnodot = xhdot1
-                + (0.5 * temp2 * (4 - 19 * deep_arg.theta2)
-                        + 2 * temp3 * (3 - 7 * deep_arg.theta2))
-                        * deep_arg.cosio;
-        xnodcf = 3.5 * deep_arg.betao2 * xhdot1 * c1;
-        t2cof = 1.5 * c1;
-        xlcof = 0.125 * a3ovk2 * deep_arg.sinio * (3 + 5 * deep_arg.cosio)
-                / (1 + deep_arg.cosio);
-        aycof = 0.25 * a3ovk2 * deep_arg.sinio;
-        x7thm1 = 7 * deep_arg.theta2 - 1;
-
-        // initialize Deep()
-        Deep(DPINIT);
-    }
-
     // Update for secular gravity and atmospheric drag
     xmdf = tle_xmo + deep_arg.xmdot * tsince;
     deep_arg.omgadf = tle_omegao + deep_arg.omgdot * tsince;
@@ -1206,7 +1319,7 @@ void SatelliteCalc::SDP4(double tsince, vector_t &pos, vector_t &vel) {
     deep_arg.xll = xmdf;
     deep_arg.t = tsince;
 
-    Deep(DPSEC);
+    DeepSecular<REGIME>();
 
     xmdf = deep_arg.xll;
     a = pow(XKE / deep_arg.xn, TOTHRD) * tempa * tempa;
@@ -1216,7 +1329,7 @@ void SatelliteCalc::SDP4(double tsince, vector_t &pos, vector_t &vel) {
     // Update for deep-space periodic effects
     deep_arg.xll = xmam;
 
-    Deep(DPPER);
+    DeepPeriodics();
 
     xmam = deep_arg.xll;
     xl = xmam + deep_arg.omgadf + deep_arg.xnode;
@@ -1309,8 +1422,9 @@ void SatelliteCalc::SDP4(double tsince, vector_t &pos, vector_t &vel) {
     vel.z = rdotk * uz + rfdotk * vz;
 }
 
-void SatelliteCalc::Update(Satellite& satellite) {
-    satellite.sat_lat = sat_lat;
-    satellite.sat_lon = sat_lon;
-    satellite.sat_alt = sat_alt;
-}
+template void DeepSpacePropagator::Propagate<DEEP_SPACE>(double, vector_t&,
+    vector_t&);
+template void DeepSpacePropagator::Propagate<DEEP_SPACE_SYNCHRONOUS>(double,
+    vector_t&, vector_t&);
+template void DeepSpacePropagator::Propagate<DEEP_SPACE_HALF_DAY>(double,
+    vector_t&, vector_t&);
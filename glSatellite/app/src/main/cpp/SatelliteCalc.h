@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cmath>
+#include <memory>
+#include <vector>
 #include "Satellite.h"
 
 /* General three-dimensional vector structure used by SGP4/SDP4 code. */
@@ -21,55 +23,214 @@ struct vector_t {
     }
 };
 
+/*
+ * Time of one update, computed once and shared by all satellites
+ * propagated together so they get the same timestamp.
+ */
+struct PropagationContext {
+    // Days since 31Dec79 00:00:00 UTC
+    double daynum;
+    // Julian date (UTC)
+    double jul_utc;
+    // Greenwich mean sidereal time in radians, with its sine and cosine
+    double gmst, sin_gmst, cos_gmst;
+
+    explicit PropagationContext(double daynum);
+};
+
+/* State of the deep-space resonance integrator. */
+struct resonance_state_t {
+    double xli, xni;
+};
+
 /* Common arguments between deep-space functions used by SGP4/SDP4 code. */
 typedef struct {
-    /* Used by dpinit part of Deep() */
+    /* Used by DeepInit() */
     double eosq, sinio, cosio, betao, aodp, theta2, sing, cosg, betao2, xmdot,
             omgdot, xnodot, xnodp;
 
-    /* Used by dpsec and dpper parts of Deep() */
+    /* Used by DeepSecular() and DeepPeriodics() */
     double xll, omgadf, xnode, em, xinc, xn, t;
 
-    /* Used by thetg and Deep() */
+    /* Used by ThetaG() and DeepInit() */
     double ds50;
 } deep_arg_t;
 
-class SatelliteCalc {
-    // Two-line-element satellite orbital data used for calculations
-    double tle_epoch, tle_xndt2o, tle_xndd6o, tle_bstar, tle_xincl, tle_xnodeo;
-    double tle_xmo, tle_xno, tle_eo, tle_omegao;
-    int tle_catnr, tle_revnum;
-    std::string tle_sat_name, tle_idesg;
+// Orbit regimes, each one has its own propagator kernel
+enum REGIMES {
+    NEAR_EARTH, // SGP4
+    NEAR_EARTH_SIMPLE, // SGP4 without the higher order drag terms
+    DEEP_SPACE, // SDP4 without resonance
+    DEEP_SPACE_SYNCHRONOUS, // SDP4 with the 24 hour resonance
+    DEEP_SPACE_HALF_DAY, // SDP4 with the 12 hour resonance
+    MAX_REGIMES
+};
 
-    // Flags
-    bool is_sdp4_, epoch_restart, synchronous, resonance, do_loop,
-            lunar_terms_done, simple, sdp4_initialized, sgp4_initialized;
+/* Mean elements of a TLE in radians and minutes, as SGP4/SDP4 use them. */
+struct Elements {
+    double tle_epoch, tle_bstar, tle_xincl, tle_xnodeo, tle_xmo, tle_xno,
+            tle_eo, tle_omegao;
+};
 
-    // SGP4 temp values
+/*
+ * SGP4 for near-earth satellites (period < 225 minutes). Orbits with
+ * perigee below 220 km use the NEAR_EARTH_SIMPLE kernel, which leaves out
+ * the terms whose constants are not calculated for them.
+ */
+class NearEarthPropagator: public Elements {
+    friend class SGP4Batch;
+
+    bool simple;
     double aodp, aycof, c1, c4, c5, cosio, d2, d3, d4, delmo, omgcof, eta,
             omgdot, sinio, xnodp, sinmo, t2cof, t3cof, t4cof, t5cof, x1mth2,
             x3thm1, x7thm1, xmcof, xmdot, xnodcf, xnodot, xlcof;
+public:
+    // Initialization of the time-independent constants
+    explicit NearEarthPropagator(const Elements& elements);
 
-    // SDP4 temp values
-    double thgr, xnq, xqncl, omegaq, zmol, zmos, savtsn, ee2, e3, xi2, xl2, xl3,
-            xl4, xgh2, xgh3, xgh4, xh2, xh3, sse, ssi, ssg, xi3, se2, si2, sl2,
-            sgh2, sh2, se3, si3, sl3, sgh3, sh3, sl4, sgh4, ssl, ssh, d3210,
-            d3222, d4410, d4422, d5220, d5232, d5421, d5433, del1, del2, del3,
-            fasx2, fasx4, fasx6, xlamo, xfact, xni, atime, stepp, stepn, step2,
-            preep, pl, sghs, xli, d2201, d2211, sghl, sh1, pinc, pe, shs,
-            zsingl, zcosgl, zsinhl, zcoshl, zsinil, zcosil;
+    REGIMES GetRegime() const {
+        return simple ? NEAR_EARTH_SIMPLE : NEAR_EARTH;
+    }
+
+    // Position and velocity in earth radii and earth radii per minute,
+    // REGIME must be GetRegime()
+    template<REGIMES REGIME>
+    void Propagate(double tsince, vector_t &pos, vector_t &vel) const;
+};
+
+/*
+ * Time-independent SDP4 terms of a deep-space satellite, kept apart from
+ * the heap-allocated state of DeepSpacePropagator so they can be stored
+ * and loaded as one block.
+ */
+class DeepSpaceTerms: public Elements {
+protected:
+    // 24 hour resonance terms
+    struct Synchronous {
+        double del1, del2, del3, fasx2, fasx4, fasx6;
+    };
+
+    // 12 hour resonance terms
+    struct HalfDay {
+        double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421,
+                d5433;
+    };
+
+    REGIMES regime_;
+    double aycof, c1, c4, x1mth2, x3thm1, x7thm1, xlcof, xnodcf, t2cof;
     deep_arg_t deep_arg;
 
-    // Calculated values
-    double sat_lat, sat_lon, sat_alt, sat_vel, age;
+    // Lunar-solar terms
+    double thgr, xnq, xqncl, omegaq, zmol, zmos, ee2, e3, xi2, xl2, xl3, xl4,
+            xgh2, xgh3, xgh4, xh2, xh3, sse, ssi, ssg, xi3, se2, si2, sl2,
+            sgh2, sh2, se3, si3, sl3, sgh3, sh3, sl4, sgh4, ssl, ssh;
+    // Periodics of the time savtsn
+    double savtsn, pe, pinc, pl, sghs, sghl, shs, sh1;
+
+    // Resonance terms of the regime
+    union {
+        Synchronous sync_;
+        HalfDay half_day_;
+    };
+    double xlamo, xfact, stepp, stepn, step2;
+    // Resonance integrator
+    double xli, xni, atime;
+
+    explicit DeepSpaceTerms(const Elements& elements) :
+            Elements(elements) {
+    }
+};
+
+/*
+ * SDP4 for deep-space satellites with the lunar-solar terms, the
+ * resonance terms and the resonance integrator of their regime. Not
+ * const: the integrator state and the periodics of the last time are
+ * kept between calls.
+ */
+class DeepSpacePropagator: public DeepSpaceTerms {
+    // Resonance integrator states every CHECKPOINT_STEPS steps
+    // after (index 0) and before (index 1) epoch
+    static const long CHECKPOINT_STEPS = 8;
+    std::vector<resonance_state_t> checkpoint_[2];
 
-    void SelectEphemeris();
-    void SGP4(double tsince, vector_t &pos, vector_t &vel);
-    void SDP4(double tsince, vector_t &pos, vector_t &vel);
-    void Deep(int ientry);
     double ThetaG();
+    void DeepInit();
+    // Integrator and periodics as right after the initialization
+    void ResetState();
+    template<REGIMES REGIME>
+    void DeepSecular();
+    void DeepPeriodics();
+    template<REGIMES REGIME>
+    void ResonanceDots(double &xndot, double &xnddt, double &xldot);
+    template<REGIMES REGIME>
+    void ResonanceStep(double t);
+public:
+    // Initialization of the time-independent constants
+    explicit DeepSpacePropagator(const Elements& elements);
+    // Same from the terms of an initialized propagator
+    explicit DeepSpacePropagator(const DeepSpaceTerms& terms);
+
+    REGIMES GetRegime() const {
+        return regime_;
+    }
+
+    // Position and velocity in earth radii and earth radii per minute,
+    // REGIME must be GetRegime()
+    template<REGIMES REGIME>
+    void Propagate(double tsince, vector_t &pos, vector_t &vel);
+};
+
+/*
+ * Propagation of one satellite and its last calculated position. Only
+ * the propagator of the satellite's regime is allocated.
+ */
+class SatelliteCalc {
+    friend class SGP4Batch;
+    friend class CatalogFile;
+
+    REGIMES regime_;
+    // Julian date of the epoch
+    double jul_epoch_;
+    std::unique_ptr<NearEarthPropagator> near_earth_;
+    std::unique_ptr<DeepSpacePropagator> deep_space_;
+
+    // Calculated values
+    double sat_lat, sat_lon, sat_alt, sat_vel;
+
+    double JulianEpoch() const {
+        return jul_epoch_;
+    }
 public:
     SatelliteCalc(const Satellite& satellite);
-    void Calc(double daynum);
-    void Update(Satellite& satellite);
+    // Same from already initialized propagators
+    explicit SatelliteCalc(const NearEarthPropagator& near_earth);
+    explicit SatelliteCalc(const DeepSpaceTerms& deep_space);
+    SatelliteCalc(const SatelliteCalc& other);
+    SatelliteCalc(SatelliteCalc&& other) = default;
+    SatelliteCalc& operator=(SatelliteCalc other);
+
+    void Calc(const PropagationContext& context);
+    // Time since epoch in minutes
+    double TimeSinceEpoch(const PropagationContext& context) const;
+    // Position and velocity in earth radii and earth radii per minute
+    void Propagate(double tsince, vector_t &pos, vector_t &vel);
+    // Same with the kernel of the regime, REGIME must be GetRegime()
+    template<REGIMES REGIME>
+    void Propagate(double tsince, vector_t &pos, vector_t &vel);
+    // Same as Calc(), but with position and velocity already propagated
+    // (in earth radii and earth radii per minute, as Propagate() returns them)
+    void SetState(const PropagationContext& context, vector_t &pos,
+        vector_t &vel);
+    // Same as SetState(), with the geodetic latitude and altitude
+    // already calculated by GeodeticLatAlt() (radians and km)
+    void SetState(const PropagationContext& context, vector_t &pos,
+        vector_t &vel, double lat, double alt);
+    void Update(SatellitePosition& position);
+    const Elements& GetElements() const;
+    REGIMES GetRegime() const {
+        return regime_;
+    }
+    bool IsDeepSpace() const {
+        return regime_ >= DEEP_SPACE;
+    }
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cmath>
+
+// ----------------------------------------------------------------------------
+// Constants used by SGP4/SDP4
+// ----------------------------------------------------------------------------
+
+const double DEG2RAD = 1.745329251994330E-2; // Degrees to radians
+const double PIO2 = M_PI / 2; // Pi/2
+const double X3PIO2 = 3 * M_PI / 2; // 3*Pi/2
+const double TWOPI = 2 * M_PI; // 2*Pi
+const double E6A = 1.0E-6;
+const double TOTHRD = 2.0 / 3; // 2/3
+const double XJ3 = -2.53881E-6; // J3 Harmonic (WGS '72)
+const double XKE = 7.43669161E-2;
+const double XKMPER = 6.378137E3; // WGS 84 Earth radius km
+const double SECDAY = 8.6400E4; // Seconds per day
+const double MINDAY = 1.44E3; // Minutes per day
+const double AE = 1.0;
+const double CK2 = 5.413079E-4;
+const double CK4 = 6.209887E-7;
+const double FF = 3.35281066474748E-3; // Flattening factor
+const double S4_INIT = 1.012229;
+const double QOMS2T = 1.880279E-09;
+const double OMEGA_E = 1.00273790934; // Earth rotations/siderial day
+const double ZNS = 1.19459E-5;
+const double C1SS = 2.9864797E-6;
+const double ZES = 1.675E-2;
+const double ZNL = 1.5835218E-4;
+const double C1L = 4.7968065E-7;
+const double ZEL = 5.490E-2;
+const double ZCOSIS = 9.1744867E-1;
+const double ZSINIS = 3.9785416E-1;
+const double ZSINGS = -9.8088458E-1;
+const double ZCOSGS = 1.945905E-1;
+const double Q22 = 1.7891679E-6;
+const double Q31 = 2.1460748E-6;
+const double Q33 = 2.2123015E-7;
+const double G22 = 5.7686396;
+const double G32 = 9.5240898E-1;
+const double G44 = 1.8014998;
+const double G52 = 1.0508330;
+const double G54 = 4.4108898;
+const double ROOT22 = 1.7891679E-6;
+const double ROOT32 = 3.7393792E-7;
+const double ROOT44 = 7.3636953E-9;
+const double ROOT52 = 1.1428639E-7;
+const double ROOT54 = 2.1765803E-9;
+const double THDT = 4.3752691E-3;
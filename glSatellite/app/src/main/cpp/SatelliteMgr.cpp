@@ -1,84 +1,871 @@
+#include <chrono>
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <unordered_map>
 
+#include "CatalogFile.h"
+#include "Geodetic.h"
+#include "OmmParser.h"
+#include "SatelliteConst.h"
 #include "SatelliteMgr.h"
+#include "TextBlocks.h"
+#include "TleParser.h"
 
 using namespace std;
 
-static unsigned char val[256];
+// Minimum time between two snapshots of the producer thread
+static const chrono::milliseconds UPDATE_PERIOD(16);
 
-static bool KepCheck(const string &line1, const string &line2) {
-    /* This function scans line 1 and line 2 of a NASA 2-Line element
-     set and returns a 1 if the element set appears to be valid or
-     a 0 if it does not.  If the data survives this torture test,
-     it's a pretty safe bet we're looking at a valid 2-line
-     element set and not just some random text that might pass
-     as orbital data based on a simple checksum calculation alone. */
+// Propagated states, converted to geodetic coordinates together
+static const size_t BLOCK = 64;
 
-    int x;
-    unsigned sum1, sum2;
+struct StateBlock {
+    size_t number = 0;
+    size_t index[BLOCK];
+    vector_t pos[BLOCK], vel[BLOCK];
+};
 
-    /* Compute checksum for each line */
+// Propagator kernels of the deep-space regimes
+typedef void (SatelliteCalc::*PropagateKernel)(double, vector_t&, vector_t&);
 
-    for (x = 0, sum1 = 0, sum2 = 0; x <= 67; sum1 += val[(int)line1[x]], sum2 +=
-        val[(int)line2[x]], ++x)
-        ;
+static const PropagateKernel KERNEL[MAX_REGIMES] = {
+    nullptr,
+    nullptr,
+    &SatelliteCalc::Propagate<DEEP_SPACE>,
+    &SatelliteCalc::Propagate<DEEP_SPACE_SYNCHRONOUS>,
+    &SatelliteCalc::Propagate<DEEP_SPACE_HALF_DAY>
+};
 
-    /* Perform a "torture test" on the data */
+// Parts of the catalog text parsed in parallel, big enough to keep
+// the pool overhead small and several per thread for the balance
+static const size_t MIN_CHUNK_SIZE = 64 * 1024;
+static const size_t CHUNKS_PER_THREAD = 4;
+// Element sets initialized together by Refresh()
+static const size_t MIN_INIT_CHUNK = 256;
 
-    x = (val[(int)line1[68]] ^ (sum1 % 10))
-            | (val[(int)line2[68]] ^ (sum2 % 10)) | (line1[0] ^ '1')
-            | (line1[1] ^ ' ') | (line1[7] ^ 'U') | (line1[8] ^ ' ')
-            | (line1[17] ^ ' ') | (line1[23] ^ '.') | (line1[32] ^ ' ')
-            | (line1[34] ^ '.') | (line1[43] ^ ' ') | (line1[52] ^ ' ')
-            | (line1[61] ^ ' ') | (line1[62] ^ '0') | (line1[63] ^ ' ')
-            | (line2[0] ^ '2') | (line2[1] ^ ' ') | (line2[7] ^ ' ')
-            | (line2[11] ^ '.') | (line2[16] ^ ' ') | (line2[20] ^ '.')
-            | (line2[25] ^ ' ') | (line2[33] ^ ' ') | (line2[37] ^ '.')
-            | (line2[42] ^ ' ') | (line2[46] ^ '.') | (line2[51] ^ ' ')
-            | (line2[54] ^ '.') | (line1[2] ^ line2[2]) | (line1[3] ^ line2[3])
-            | (line1[4] ^ line2[4]) | (line1[5] ^ line2[5])
-            | (line1[6] ^ line2[6]) | (isdigit(line1[68]) ? 0 : 1)
-            | (isdigit(line2[68]) ? 0 : 1) | (isdigit(line1[18]) ? 0 : 1)
-            | (isdigit(line1[19]) ? 0 : 1) | (isdigit(line2[31]) ? 0 : 1)
-            | (isdigit(line2[32]) ? 0 : 1);
+// Shortest OMM, a CSV line of the fields the propagator needs
+static const size_t MIN_OMM_SIZE = 48;
+// Start of a compressed text the format is detected in
+static const size_t DETECT_BLOCK_SIZE = 4096;
 
-    return !x;
+// Element sets in the batches of a streaming load: a small first one
+// shows satellites right away, the larger ones after it keep the cost
+// of adding them to the catalog low
+static const size_t FIRST_BATCH_SIZE = 64;
+static const size_t MAX_BATCH_SIZE = 4096;
+
+static size_t CountLines(const char *begin, const char *end) {
+    size_t lines = 0;
+    while ((begin = static_cast<const char*>(memchr(begin, '\n',
+        end - begin)))) {
+        ++lines;
+        ++begin;
+    }
+    return lines;
+}
+
+static const char* SkipLines(const char *begin, const char *end,
+    size_t lines) {
+    for (; lines > 0 && begin < end; --lines) {
+        const char *eol = static_cast<const char*>(memchr(begin, '\n',
+            end - begin));
+        begin = eol ? eol + 1 : end;
+    }
+    return begin;
+}
+
+/*
+ * Splits the catalog text into parts of whole element sets. The sets are
+ * groups of three lines from the start of the text, so the lines before
+ * each split point are counted (in parallel) to move the split point to
+ * the start of a set. The parts are parsed as if the text was parsed in
+ * one piece.
+ */
+static vector<CatalogChunk> SplitCatalog(const char *data, size_t size,
+    ThreadPool *pool) {
+    size_t count = 1;
+    if (pool && size >= 2 * MIN_CHUNK_SIZE) {
+        count = min(size / MIN_CHUNK_SIZE,
+            pool->GetThreadCount() * CHUNKS_PER_THREAD);
+    }
+
+    // Split points at line starts and the number of lines between them
+    const char *end = data + size;
+    vector<const char*> start(count + 1, end);
+    start[0] = data;
+    for (size_t k = 1; k < count; ++k) {
+        const char *pos = data + size / count * k;
+        const char *eol = static_cast<const char*>(memchr(pos - 1, '\n',
+            end - pos + 1));
+        start[k] = eol ? eol + 1 : end;
+    }
+    vector<size_t> lines(count);
+    auto count_lines = [&](size_t begin, size_t end, size_t worker) {
+        for (size_t k = begin; k < end; ++k) {
+            lines[k] = CountLines(start[k], start[k + 1]);
+        }
+    };
+    if (count > 1) {
+        pool->ParallelFor(count, 1, count_lines);
+    }
+
+    vector<CatalogChunk> chunks(count);
+    size_t line = 0;
+    const char *set_start = data;
+    for (size_t k = 0; k < count; ++k) {
+        // First set at or after the split point
+        const char *next = k + 1 < count ? SkipLines(start[k + 1], end,
+            (3 - (line + lines[k]) % 3) % 3) : end;
+        chunks[k].text = StringView(set_start, next - set_start);
+        line += lines[k];
+        set_start = next;
+    }
+    return chunks;
+}
+
+/* Adds the element set if it is valid and not decayed at daynum. */
+static void AddElementSet(const TleLines &lines, double daynum,
+    vector<Satellite> &sat) {
+    if (KepCheck(lines.line1, lines.line2)) {
+        /* We found a valid TLE! */
+        sat.emplace_back(lines.name, lines.line1.data, lines.line2.data);
+        if (sat.back().IsDecayed(daynum)) {
+            sat.pop_back();
+        }
+    }
+}
+
+/* Adds the OMM if it is valid and not decayed at daynum. */
+static void AddOmm(const OmmFields &fields, double daynum,
+    vector<Satellite> &sat) {
+    if (OmmCheck(fields)) {
+        sat.emplace_back(fields);
+        if (sat.back().IsDecayed(daynum)) {
+            sat.pop_back();
+        }
+    }
+}
+
+/* OMM format of the text, plain or compressed, MAX_OMM_FORMATS for TLE. */
+static OMM_FORMATS DetectFormat(StringView text) {
+    TextBlocks blocks(text, 1, DETECT_BLOCK_SIZE);
+    StringView block;
+    return blocks.Next(block) ? OmmParser::DetectFormat(block)
+            : MAX_OMM_FORMATS;
+}
+
+/*
+ * Element sets of a catalog text one at a time: TLE or OMM, plain or
+ * gzip compressed. The blocks of a TLE text are parsed as they are
+ * inflated. OMM records are not on a grid of lines, so a compressed
+ * OMM text is inflated whole first.
+ */
+class ElementSetReader {
+    TextBlocks blocks_;
+    StringView block_;
+    TleParser tle_;
+    string omm_text_;
+    unique_ptr<OmmParser> omm_;
+public:
+    explicit ElementSetReader(StringView text) :
+            blocks_(text, TLE_SET_LINES),
+            tle_(nullptr, 0) {
+        if (!blocks_.Next(block_)) {
+            return;
+        }
+        OMM_FORMATS format = OmmParser::DetectFormat(block_);
+        if (format == MAX_OMM_FORMATS) {
+            tle_ = TleParser(block_.data, block_.size);
+            return;
+        }
+        if (TextBlocks::IsGzip(text)) {
+            omm_text_.assign(block_.data, block_.size);
+            while (blocks_.Next(block_)) {
+                omm_text_.append(block_.data, block_.size);
+            }
+            block_ = StringView(omm_text_);
+        }
+        omm_.reset(new OmmParser(block_.data, block_.size, format));
+    }
+
+    // Adds the next element set to sat if it is valid and not decayed
+    // at daynum. False at the end of the text.
+    bool Next(double daynum, vector<Satellite> &sat) {
+        if (omm_) {
+            OmmFields fields;
+            if (!omm_->Next(fields)) {
+                return false;
+            }
+            AddOmm(fields, daynum, sat);
+            return true;
+        }
+        TleLines lines;
+        while (!tle_.Next(lines)) {
+            if (!blocks_.Next(block_)) {
+                return false;
+            }
+            tle_ = TleParser(block_.data, block_.size);
+        }
+        AddElementSet(lines, daynum, sat);
+        return true;
+    }
+};
+
+/* Valid element sets of an OMM text that are not decayed at daynum. */
+static vector<Satellite> ReadOmm(StringView text, double daynum) {
+    vector<Satellite> sat;
+    ElementSetReader reader(text);
+    while (reader.Next(daynum, sat)) {
+    }
+    return sat;
+}
+
+static void InitChunk(CatalogChunk &chunk) {
+    // Propagators are initialized only once per catalog
+    chunk.calc.reserve(chunk.sat.size());
+    for (const Satellite &sat : chunk.sat) {
+        chunk.calc.emplace_back(sat);
+    }
+}
+
+/* Parses the valid element sets that are not decayed at daynum. */
+static void ParseChunk(CatalogChunk &chunk, double daynum) {
+    // At most one element set per two lines
+    chunk.sat.reserve(chunk.text.size / (2 * TLE_LINE_LENGTH) + 1);
+    TleParser parser(chunk.text.data, chunk.text.size);
+    TleLines lines;
+    while (parser.Next(lines)) {
+        AddElementSet(lines, daynum, chunk.sat);
+    }
+}
+
+/* Parses the text like Init(), on the pool if there is one. */
+static vector<CatalogChunk> ParseCatalog(const char *data, size_t size,
+    ThreadPool *pool, bool init) {
+    double daynum = CurrentDaynum();
+    vector<CatalogChunk> chunks = SplitCatalog(data, size, pool);
+    auto parse = [&](size_t begin, size_t end, size_t worker) {
+        for (size_t k = begin; k < end; ++k) {
+            ParseChunk(chunks[k], daynum);
+            if (init) {
+                InitChunk(chunks[k]);
+            }
+        }
+    };
+    if (pool && chunks.size() > 1) {
+        pool->ParallelFor(chunks.size(), 1, parse);
+    } else {
+        parse(0, chunks.size(), 0);
+    }
+    return chunks;
+}
+
+/* Propagators of the element sets in their order, on the pool. */
+static vector<CatalogChunk> InitElementSets(const vector<Satellite> &sat,
+    ThreadPool *pool) {
+    size_t count = 1;
+    if (pool && sat.size() >= 2 * MIN_INIT_CHUNK) {
+        count = min(sat.size() / MIN_INIT_CHUNK,
+            pool->GetThreadCount() * CHUNKS_PER_THREAD);
+    }
+    vector<CatalogChunk> chunks(count);
+    for (size_t k = 0; k < count; ++k) {
+        chunks[k].sat.assign(sat.begin() + sat.size() * k / count,
+            sat.begin() + sat.size() * (k + 1) / count);
+    }
+    auto init = [&](size_t begin, size_t end, size_t worker) {
+        for (size_t k = begin; k < end; ++k) {
+            InitChunk(chunks[k]);
+        }
+    };
+    if (count > 1) {
+        pool->ParallelFor(count, 1, init);
+    } else {
+        init(0, count, 0);
+    }
+    return chunks;
 }
 
 void SatelliteMgr::Init(IFileReader& fd) {
+    StringView text = fd.view();
+    Init(text.data, text.size);
+}
+
+void SatelliteMgr::Init(const char *data, size_t size) {
+    Stop();
+    StopLoader();
     sat_.clear();
-    // Use temporary vector to set all values at once below
-    vector<Satellite> sat_list;
-    if (fd.is_open()) {
-        while (!fd.eof()) {
-            /* Read element set */
-            string name, line1, line2;
-
-            name = fd.getline();
-            line1 = fd.getline();
-            line2 = fd.getline();
-
-            if (KepCheck(line1, line2) && !fd.eof()) {
-                /* We found a valid TLE! */
-                Satellite sat(name, line1, line2);
-                if (!sat.IsDecayed()) {
-                    sat_list.push_back(sat);
-                }
+    calc_.clear();
+
+    StringView text(data, size);
+    if (DetectFormat(text) != MAX_OMM_FORMATS) {
+        // Parsed in one pass, initialized in parallel
+        Init(ReadOmm(text, CurrentDaynum()));
+        return;
+    }
+
+    // The parts of every block are parsed and initialized in parallel
+    // and put together in their original order
+    TextBlocks blocks(text, TLE_SET_LINES);
+    StringView block;
+    while (blocks.Next(block)) {
+        vector<CatalogChunk> chunks = ParseCatalog(block.data, block.size,
+            pool_, true);
+        size_t number = sat_.size();
+        for (const CatalogChunk &chunk : chunks) {
+            number += chunk.sat.size();
+        }
+        if (number > sat_.capacity()) {
+            number = max(number, 2 * sat_.capacity());
+            sat_.reserve(number);
+            calc_.reserve(number);
+        }
+        for (CatalogChunk &chunk : chunks) {
+            sat_.insert(sat_.end(), chunk.sat.begin(), chunk.sat.end());
+            move(chunk.calc.begin(), chunk.calc.end(), back_inserter(calc_));
+        }
+    }
+    initialized_ = sat_.size();
+    InitPropagation();
+}
+
+void SatelliteMgr::Init(vector<Satellite> sat) {
+    Stop();
+    StopLoader();
+    vector<CatalogChunk> chunks = InitElementSets(sat, pool_);
+    sat_ = move(sat);
+    calc_.clear();
+    calc_.reserve(sat_.size());
+    for (CatalogChunk &chunk : chunks) {
+        move(chunk.calc.begin(), chunk.calc.end(), back_inserter(calc_));
+    }
+    initialized_ = sat_.size();
+    InitPropagation();
+}
+
+void SatelliteMgr::Init(vector<Satellite> sat, vector<SatelliteCalc> calc) {
+    Stop();
+    StopLoader();
+    sat_ = move(sat);
+    calc_ = move(calc);
+    initialized_ = 0;
+    InitPropagation();
+}
+
+bool SatelliteMgr::Load(const char *path) {
+    CatalogFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+    Stop();
+    StopLoader();
+
+    // Only the records are copied, the propagators are ready to use
+    double daynum = CurrentDaynum();
+    sat_.clear();
+    sat_.reserve(file.GetNumber());
+    calc_.clear();
+    calc_.reserve(file.GetNumber());
+    for (size_t i = 0; i < file.GetNumber(); ++i) {
+        const Satellite &sat = file.GetSatellite(i);
+        if (!sat.IsDecayed(daynum)) {
+            sat_.push_back(sat);
+            calc_.push_back(file.GetCalc(i));
+        }
+    }
+    initialized_ = 0;
+    InitPropagation();
+    return true;
+}
+
+bool SatelliteMgr::Save(const char *path) const {
+    return CatalogFile::Write(path, sat_, calc_);
+}
+
+void SatelliteMgr::Stream(string text, string save_path) {
+    Stop();
+    StopLoader();
+    stream_string_ = move(text);
+    StartLoader(StringView(stream_string_), move(save_path));
+}
+
+void SatelliteMgr::Stream(unique_ptr<IFileReader> reader, string save_path) {
+    Stop();
+    StopLoader();
+    // Parsed from the storage of the reader, kept until the next load
+    stream_reader_ = move(reader);
+    StartLoader(stream_reader_->view(), move(save_path));
+}
+
+void SatelliteMgr::StartLoader(StringView text, string save_path) {
+    // The render thread reads the records of its snapshot while more
+    // are appended, so they must never move: reserve room for at most
+    // one element set per two lines of the uncompressed text, or per
+    // shortest OMM
+    size_t record = DetectFormat(text) == MAX_OMM_FORMATS ?
+            2 * TLE_LINE_LENGTH : MIN_OMM_SIZE;
+    size_t capacity = TextBlocks::GetSize(text) / record + 1;
+    sat_.clear();
+    sat_.reserve(capacity);
+    calc_.clear();
+    calc_.reserve(capacity);
+    initialized_ = 0;
+    InitPropagation();
+
+    stream_text_ = text;
+    save_path_ = move(save_path);
+    parsed_ = false;
+    loading_.store(true, memory_order_release);
+    loader_ = thread(&SatelliteMgr::LoadBatches, this);
+}
+
+void SatelliteMgr::Refresh(const char *data, size_t size,
+    vector<size_t>& changed) {
+    Stop();
+    // The part of a streaming load already in the catalog is
+    // refreshed like a whole catalog, the rest is new
+    StopLoader();
+    vector<CatalogChunk> chunks;
+    StringView text(data, size);
+    if (DetectFormat(text) != MAX_OMM_FORMATS) {
+        chunks.resize(1);
+        chunks[0].sat = ReadOmm(text, CurrentDaynum());
+    } else {
+        TextBlocks blocks(text, TLE_SET_LINES);
+        StringView block;
+        while (blocks.Next(block)) {
+            vector<CatalogChunk> parsed = ParseCatalog(block.data,
+                block.size, pool_, false);
+            // Only the records are used, the text of the block goes away
+            for (CatalogChunk &chunk : parsed) {
+                chunk.text = StringView();
+                chunks.push_back(move(chunk));
             }
         }
     }
-    sat_ = sat_list;
+
+    // Hash index of the new element sets by catalog number, the
+    // matched ones are taken out so the rest are the new satellites
+    size_t number = 0;
+    for (const CatalogChunk &chunk : chunks) {
+        number += chunk.sat.size();
+    }
+    unordered_map<int, const Satellite*> fresh(number);
+    for (const CatalogChunk &chunk : chunks) {
+        for (const Satellite &sat : chunk.sat) {
+            fresh.emplace(sat.GetCatNum(), &sat);
+        }
+    }
+
+    // Removals first, they only move satellites. Duplicates of a
+    // catalog number in the old catalog are removed as well.
+    changed.clear();
+    size_t old_number = sat_.size();
+    vector<size_t> replaced;
+    vector<Satellite> init;
+    for (size_t i = 0; i < sat_.size();) {
+        auto it = fresh.find(sat_[i].GetCatNum());
+        if (it == fresh.end()) {
+            RemoveSatellite(i);
+            if (i < sat_.size() && (changed.empty() || changed.back() != i)) {
+                changed.push_back(i);
+            }
+            continue;
+        }
+        if (sat_[i].SameElements(*it->second)) {
+            // Only the name or the numbers
+            sat_[i] = *it->second;
+        } else {
+            replaced.push_back(i);
+            init.push_back(*it->second);
+            if (changed.empty() || changed.back() != i) {
+                changed.push_back(i);
+            }
+        }
+        fresh.erase(it);
+        ++i;
+    }
+    // The satellite moved into index i may be removed there as the last
+    // one, then i is listed but no longer in the catalog. Only the last
+    // listed index can be, the catalog never shrinks below an earlier one.
+    size_t begin = sat_.size();
+    if (!changed.empty() && changed.back() == begin) {
+        changed.pop_back();
+    }
+    for (const CatalogChunk &chunk : chunks) {
+        for (const Satellite &sat : chunk.sat) {
+            auto it = fresh.find(sat.GetCatNum());
+            if (it != fresh.end() && it->second == &sat) {
+                init.push_back(sat);
+            }
+        }
+    }
+
+    // Only the changed and the new element sets are initialized
+    vector<CatalogChunk> sets = InitElementSets(init, pool_);
+    initialized_ += init.size();
+    size_t n = 0;
+    for (CatalogChunk &chunk : sets) {
+        for (size_t k = 0; k < chunk.sat.size(); ++k, ++n) {
+            if (n < replaced.size()) {
+                ReplaceSatellite(replaced[n], chunk.sat[k],
+                    move(chunk.calc[k]));
+            } else {
+                sat_.push_back(chunk.sat[k]);
+                calc_.push_back(move(chunk.calc[k]));
+            }
+        }
+    }
+    // New satellites in the place of removed ones
+    for (size_t i = begin; i < min(old_number, sat_.size()); ++i) {
+        changed.push_back(i);
+    }
+    if (begin == 0) {
+        InitPropagation();
+    } else if (sat_.size() > begin) {
+        InitPropagation(begin);
+    }
+    last_daynum_ = NAN;
+}
+
+void SatelliteMgr::Refresh(IFileReader& reader, vector<size_t>& changed) {
+    StringView text = reader.view();
+    Refresh(text.data, text.size, changed);
+}
+
+void SatelliteMgr::StopLoader() {
+    if (loader_.joinable()) {
+        stop_loader_.store(true, memory_order_relaxed);
+        loader_.join();
+        stop_loader_.store(false, memory_order_relaxed);
+    }
+    pending_.clear();
+    parsed_ = true;
+    loading_.store(false, memory_order_release);
+    save_path_.clear();
+    stream_text_ = StringView();
+    stream_string_ = string();
+    stream_reader_.reset();
+}
+
+void SatelliteMgr::LoadBatches() {
+    double daynum = CurrentDaynum();
+    // The records must not move, see StartLoader(). The room is for
+    // the whole text, the check only guards the reservation.
+    size_t room = sat_.capacity();
+    size_t batch_size = FIRST_BATCH_SIZE;
+    ElementSetReader reader(stream_text_);
+    CatalogChunk chunk;
+    bool more = true;
+    while (more && !stop_loader_.load(memory_order_relaxed)) {
+        more = reader.Next(daynum, chunk.sat);
+        if (chunk.sat.size() > room) {
+            chunk.sat.pop_back();
+            more = false;
+        }
+        if (chunk.sat.size() == batch_size || (!more && !chunk.sat.empty())) {
+            room -= chunk.sat.size();
+            InitChunk(chunk);
+            {
+                lock_guard<mutex> lock(stream_mutex_);
+                pending_.push_back(move(chunk));
+            }
+            chunk = CatalogChunk();
+            batch_size = min(2 * batch_size, MAX_BATCH_SIZE);
+        }
+    }
+    lock_guard<mutex> lock(stream_mutex_);
+    parsed_ = true;
+}
+
+bool SatelliteMgr::AddBatches() {
+    vector<CatalogChunk> batches;
+    bool parsed;
+    {
+        lock_guard<mutex> lock(stream_mutex_);
+        batches.swap(pending_);
+        parsed = parsed_;
+    }
+
+    // No reallocation, see Stream()
+    size_t begin = sat_.size();
+    for (CatalogChunk &batch : batches) {
+        sat_.insert(sat_.end(), batch.sat.begin(), batch.sat.end());
+        move(batch.calc.begin(), batch.calc.end(), back_inserter(calc_));
+    }
+    if (sat_.size() > begin) {
+        InitPropagation(begin);
+    }
+    return parsed;
+}
+
+void SatelliteMgr::InitPropagation(size_t begin) {
+    if (begin == 0) {
+        for (SGP4Batch &batch : batch_) {
+            batch.Clear();
+        }
+        for (vector<size_t> &deep : deep_) {
+            deep.clear();
+        }
+        last_daynum_ = NAN;
+        use_cache_ = cache_.GetMaxError() > 0;
+    }
+
+    // The catalog is partitioned by regime so every loop runs one kernel
+    slot_.resize(sat_.size());
+    for (size_t i = begin; i < sat_.size(); ++i) {
+        AddToRegime(i);
+    }
+    if (use_cache_) {
+        if (begin == 0) {
+            cache_.Init(calc_);
+        } else {
+            cache_.Extend(calc_);
+        }
+    }
+}
+
+void SatelliteMgr::AddToRegime(size_t index) {
+    REGIMES regime = calc_[index].GetRegime();
+    if (calc_[index].IsDeepSpace()) {
+        slot_[index] = deep_[regime].size();
+        deep_[regime].push_back(index);
+    } else {
+        slot_[index] = batch_[regime].GetNumber();
+        batch_[regime].Add(index, calc_[index]);
+    }
+}
+
+void SatelliteMgr::RemoveFromRegime(size_t index) {
+    // The last satellite of the list takes the slot
+    REGIMES regime = calc_[index].GetRegime();
+    size_t slot = slot_[index];
+    size_t moved;
+    if (calc_[index].IsDeepSpace()) {
+        moved = deep_[regime].back();
+        deep_[regime][slot] = moved;
+        deep_[regime].pop_back();
+    } else {
+        SGP4Batch &batch = batch_[regime];
+        moved = batch.GetIndex(batch.GetNumber() - 1);
+        batch.Remove(slot);
+    }
+    slot_[moved] = slot;
+}
+
+void SatelliteMgr::ReplaceSatellite(size_t index, const Satellite& sat,
+    SatelliteCalc calc) {
+    sat_[index] = sat;
+    REGIMES regime = calc.GetRegime();
+    if (regime != calc_[index].GetRegime()) {
+        RemoveFromRegime(index);
+        calc_[index] = move(calc);
+        AddToRegime(index);
+    } else {
+        calc_[index] = move(calc);
+        if (!calc_[index].IsDeepSpace()) {
+            batch_[regime].Set(slot_[index], index, calc_[index]);
+        }
+    }
+    if (use_cache_) {
+        cache_.Reset(index, calc_[index]);
+    }
+}
+
+void SatelliteMgr::RemoveSatellite(size_t index) {
+    RemoveFromRegime(index);
+    size_t last = sat_.size() - 1;
+    if (index != last) {
+        sat_[index] = sat_[last];
+        calc_[index] = move(calc_[last]);
+        slot_[index] = slot_[last];
+        // Its entry in the regime list follows it
+        REGIMES regime = calc_[index].GetRegime();
+        if (calc_[index].IsDeepSpace()) {
+            deep_[regime][slot_[index]] = index;
+        } else {
+            batch_[regime].SetIndex(slot_[index], index);
+        }
+    }
+    if (use_cache_) {
+        cache_.Remove(index);
+    }
+    sat_.pop_back();
+    calc_.pop_back();
+    slot_.pop_back();
 }
 
 void SatelliteMgr::UpdateAll() {
-    size_t len = sat_.size();
-    min_alt_ = max_alt_ = 0;
-    for (size_t i = 0; i < len; ++i) {
-        Satellite &sat = sat_[i];
-        // need to update before getting values
-        sat.UpdatePosition();
-        double alt = sat.GetAltitude();
-        min_alt_ = min(min_alt_, alt);
-        max_alt_ = max(max_alt_, alt);
+    UpdateAll(PropagationContext(clock_ ? clock_->Now() : CurrentDaynum()));
+}
+
+void SatelliteMgr::UpdateAll(const PropagationContext& context) {
+    ProfileZone zone(profiler_, ZONE_UPDATE_ALL);
+    // Batches of a streaming load parsed since the last update
+    bool loaded = IsLoading() && AddBatches();
+    last_daynum_ = context.daynum;
+    size_t workers = pool_ ? pool_->GetThreadCount() : 1;
+    range_.assign(workers, AltitudeRange { 0, 0 });
+    PositionSnapshot &snapshot = snapshot_.Back();
+    snapshot.daynum = context.daynum;
+    snapshot.position.resize(sat_.size());
+
+    // Converts the block to geodetic coordinates and stores it
+    auto store = [&](StateBlock &block, AltitudeRange &range) {
+        double x[BLOCK], y[BLOCK], z[BLOCK], lat[BLOCK], alt[BLOCK];
+        for (size_t k = 0; k < block.number; ++k) {
+            x[k] = block.pos[k].x * XKMPER;
+            y[k] = block.pos[k].y * XKMPER;
+            z[k] = block.pos[k].z * XKMPER;
+        }
+        GeodeticLatAlt(block.number, x, y, z, lat, alt);
+
+        for (size_t k = 0; k < block.number; ++k) {
+            size_t i = block.index[k];
+            calc_[i].SetState(context, block.pos[k], block.vel[k], lat[k],
+                alt[k]);
+            calc_[i].Update(snapshot.position[i]);
+            range.min_alt = min(range.min_alt, alt[k]);
+            range.max_alt = max(range.max_alt, alt[k]);
+        }
+        block.number = 0;
+    };
+
+    // All satellites interpolated from the ephemeris cache
+    auto cached = [&](size_t begin, size_t end, size_t worker) {
+        AltitudeRange &range = range_[worker];
+        StateBlock block;
+        for (size_t i = begin; i < end; ++i) {
+            size_t n = block.number++;
+            block.index[n] = i;
+            cache_.Get(i, calc_[i], calc_[i].TimeSinceEpoch(context),
+                block.pos[n], block.vel[n]);
+            if (block.number == BLOCK) {
+                store(block, range);
+            }
+        }
+        store(block, range);
+    };
+
+    // Regime of the propagation loops below
+    size_t regime;
+
+    // Near-earth satellites go through the vectorized SGP4
+    auto near_earth = [&](size_t begin, size_t end, size_t worker) {
+        SGP4Batch &batch = batch_[regime];
+        batch.Propagate(context, begin, end);
+        AltitudeRange &range = range_[worker];
+        StateBlock block;
+        for (size_t k = begin; k < end; ++k) {
+            size_t n = block.number++;
+            block.index[n] = batch.GetIndex(k);
+            batch.GetState(k, block.pos[n], block.vel[n]);
+            if (block.number == BLOCK) {
+                store(block, range);
+            }
+        }
+        store(block, range);
+    };
+
+    // Deep-space satellites are much slower, small chunks keep
+    // the threads balanced
+    auto deep_space = [&](size_t begin, size_t end, size_t worker) {
+        const vector<size_t> &deep = deep_[regime];
+        PropagateKernel kernel = KERNEL[regime];
+        AltitudeRange &range = range_[worker];
+        StateBlock block;
+        for (size_t k = begin; k < end; ++k) {
+            size_t i = deep[k];
+            size_t n = block.number++;
+            block.index[n] = i;
+            (calc_[i].*kernel)(calc_[i].TimeSinceEpoch(context), block.pos[n],
+                block.vel[n]);
+            if (block.number == BLOCK) {
+                store(block, range);
+            }
+        }
+        store(block, range);
+    };
+
+    if (use_cache_) {
+        if (pool_) {
+            pool_->ParallelFor(sat_.size(), 256, cached);
+        } else {
+            cached(0, sat_.size(), 0);
+        }
+    } else {
+        for (regime = NEAR_EARTH; regime < DEEP_SPACE; ++regime) {
+            size_t number = batch_[regime].GetNumber();
+            if (pool_) {
+                // Chunks of whole cache lines of the batch columns
+                // and whole vectors for any vdouble::WIDTH
+                pool_->ParallelFor(number, 8 * CACHE_LINE / sizeof(double),
+                    near_earth);
+            } else {
+                near_earth(0, number, 0);
+            }
+        }
+        for (regime = DEEP_SPACE; regime < MAX_REGIMES; ++regime) {
+            size_t number = deep_[regime].size();
+            if (pool_) {
+                pool_->ParallelFor(number, 4, deep_space);
+            } else {
+                deep_space(0, number, 0);
+            }
+        }
+    }
+
+    snapshot.min_alt = snapshot.max_alt = 0;
+    for (const AltitudeRange &range : range_) {
+        snapshot.min_alt = min(snapshot.min_alt, range.min_alt);
+        snapshot.max_alt = max(snapshot.max_alt, range.max_alt);
+    }
+    snapshot_.Publish();
+
+    if (loaded) {
+        // A failed save only makes the next start slower
+        if (!save_path_.empty()) {
+            Save(save_path_.c_str());
+            save_path_.clear();
+        }
+        loading_.store(false, memory_order_release);
+    }
+}
+
+void SatelliteMgr::Start() {
+    if (producer_.joinable()) {
+        return;
+    }
+    stop_ = false;
+    producer_ = thread(&SatelliteMgr::Produce, this);
+}
+
+void SatelliteMgr::Stop() {
+    if (!producer_.joinable()) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(producer_mutex_);
+        stop_ = true;
+    }
+    producer_cv_.notify_one();
+    producer_.join();
+}
+
+void SatelliteMgr::Produce() {
+    unique_lock<mutex> lock(producer_mutex_);
+    while (!stop_) {
+        auto next = chrono::steady_clock::now() + UPDATE_PERIOD;
+        lock.unlock();
+        // Nothing moves while the simulation clock is paused,
+        // but the batches of a streaming load still show up
+        if (!clock_ || clock_->Now() != last_daynum_ || IsLoading()) {
+            UpdateAll();
+        }
+        lock.lock();
+        producer_cv_.wait_until(lock, next, [this] {
+            return stop_;
+        });
     }
 }
@@ -1,32 +1,245 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Ephemeris.h"
+#include "FrameProfiler.h"
 #include "Satellite.h"
+#include "SatelliteCalc.h"
+#include "SatelliteBatch.h"
+#include "SimulationClock.h"
+#include "StringView.h"
+#include "ThreadPool.h"
+#include "TripleBuffer.h"
+
+// Positions of the whole catalog at one time
+struct PositionSnapshot {
+    double daynum = 0;
+    double min_alt = 0;
+    double max_alt = 0;
+    // Same order as the satellites
+    std::vector<SatellitePosition> position;
+};
 
+// Element sets of one part of the catalog text, with their propagators
+struct CatalogChunk {
+    StringView text;
+    std::vector<Satellite> sat;
+    std::vector<SatelliteCalc> calc;
+};
+
+/*
+ * Catalog of satellites and their propagation. Between Start() and Stop()
+ * a producer thread propagates the catalog and publishes snapshots of the
+ * positions, the render thread takes the latest one with AcquireSnapshot()
+ * without locking.
+ *
+ * Stream() loads the catalog in batches instead: a loader thread parses
+ * and initializes them, and every update appends the batches parsed
+ * since the previous one, so the snapshots grow until the load is done.
+ *
+ * Refresh() updates a loaded catalog to a new TLE text in place: the
+ * element sets are matched by catalog number and only the changed ones
+ * are initialized again.
+ */
 class SatelliteMgr {
+    // Altitude range of one worker, reduced after the parallel update.
+    // Padded to a cache line so the workers do not share lines.
+    struct AltitudeRange {
+        double min_alt, max_alt;
+        char pad[CACHE_LINE - 2 * sizeof(double)];
+    };
+
     std::vector<Satellite> sat_;
-    double min_alt_;
-    double max_alt_;
+    // Initialized propagators, one per satellite in the same order
+    std::vector<SatelliteCalc> calc_;
+    // Near-earth satellites propagated together, one batch per regime
+    SGP4Batch batch_[DEEP_SPACE] = {
+        SGP4Batch(NEAR_EARTH), SGP4Batch(NEAR_EARTH_SIMPLE)};
+    // Deep-space satellites by regime, propagated one by one
+    std::vector<size_t> deep_[MAX_REGIMES];
+    // Position of every satellite in its batch or deep-space list
+    std::vector<size_t> slot_;
+    // Interpolated orbits, used instead of the propagation above
+    EphemerisCache cache_;
+    bool use_cache_ = false;
+    ThreadPool *pool_ = nullptr;
+    SimulationClock *clock_ = nullptr;
+    FrameProfiler *profiler_ = nullptr;
+    // Time of the last update, NAN before the first one
+    double last_daynum_ = NAN;
+    // Propagators initialized by the last load, see GetInitialized()
+    size_t initialized_ = 0;
+    std::vector<AltitudeRange> range_;
+    TripleBuffer<PositionSnapshot> snapshot_;
+
+    std::thread producer_;
+    std::mutex producer_mutex_;
+    std::condition_variable producer_cv_;
+    bool stop_ = false;
+
+    // Text of the streaming load, parsed by the loader thread. A view of
+    // the string or of the reader, which own it.
+    StringView stream_text_;
+    std::string stream_string_;
+    std::unique_ptr<IFileReader> stream_reader_;
+    std::thread loader_;
+    std::atomic<bool> stop_loader_{false};
+    // Parsed batches not yet in the catalog, and whether the loader
+    // is done, guarded by stream_mutex_
+    std::mutex stream_mutex_;
+    std::vector<CatalogChunk> pending_;
+    bool parsed_ = true;
+    // Until a snapshot has the whole catalog of the streaming load
+    std::atomic<bool> loading_{false};
+    // Where the catalog is saved when the streaming load is done
+    std::string save_path_;
+
+    // Partitions the satellites from begin on by regime and adds them to
+    // the ephemeris cache, begin 0 drops the propagation of the old ones
+    void InitPropagation(size_t begin = 0);
+    void AddToRegime(size_t index);
+    void RemoveFromRegime(size_t index);
+    // Puts new elements of the satellite in place, also into its batch
+    // or deep-space list and the ephemeris cache
+    void ReplaceSatellite(size_t index, const Satellite& sat,
+        SatelliteCalc calc);
+    // Moves the last satellite to index and drops the last one
+    void RemoveSatellite(size_t index);
+    // Appends the parsed batches, true if the loader is done with
+    // all of them in the catalog
+    bool AddBatches();
+    void StartLoader(StringView text, std::string save_path);
+    void StopLoader();
+    void LoadBatches();
+    void Produce();
 public:
     SatelliteMgr() {
     }
 
+    ~SatelliteMgr() {
+        Stop();
+        StopLoader();
+    }
+
+    // Runs UpdateAll on the pool, nullptr updates on the calling thread
+    void SetThreadPool(ThreadPool *pool) {
+        pool_ = pool;
+    }
+
+    // Time of the updates, nullptr uses the wall clock
+    void SetClock(SimulationClock *clock) {
+        clock_ = clock;
+    }
+
+    // Times UpdateAll in ZONE_UPDATE_ALL, nullptr does not
+    void SetProfiler(FrameProfiler *profiler) {
+        profiler_ = profiler;
+    }
+
+    // Maximum position error of the ephemeris cache in km, 0 propagates
+    // every update. Takes effect with the next Init().
+    void SetMaxError(double max_error) {
+        cache_.SetMaxError(max_error);
+    }
+
+    // Stops the producer thread and loads a new catalog, parsed
+    // from the view of the reader
     void Init(IFileReader& reader);
+    // Same from TLE text in memory, parsed in place. Gzip compressed
+    // text is inflated and parsed block by block, see TextBlocks. OMM
+    // text in CSV, KVN or XML is detected and parsed by OmmParser.
+    void Init(const char *data, size_t size);
+    // Same from parsed element sets, in their order
+    void Init(std::vector<Satellite> sat);
+    // Same from element sets and their initialized propagators, in the
+    // same order, e.g. of CopyCatalog(). Nothing is initialized again.
+    void Init(std::vector<Satellite> sat, std::vector<SatelliteCalc> calc);
+    // Same from a catalog file written by Save(), without parsing or
+    // propagator initialization. False (and the catalog is kept) if
+    // the file is missing or invalid.
+    bool Load(const char *path);
+    // Writes the catalog for Load(), false on I/O errors.
+    // Not while the producer thread runs.
+    bool Save(const char *path) const;
+    // Copies the satellites and their propagators for Init().
+    // Not while the producer thread runs.
+    void CopyCatalog(std::vector<Satellite>& sat,
+        std::vector<SatelliteCalc>& calc) const {
+        sat = sat_;
+        calc = calc_;
+    }
+    // Stops the producer thread and starts a streaming load of the TLE
+    // text, plain or gzip compressed. The catalog is saved to save_path
+    // when the load is done, unless it is empty.
+    void Stream(std::string text, std::string save_path = std::string());
+    // Same with the text of the reader, which is kept until the next load
+    // so the loader thread parses its view without a copy
+    void Stream(std::unique_ptr<IFileReader> reader,
+        std::string save_path = std::string());
+    // Stops the producer thread and a streaming load, and updates the
+    // catalog to the TLE text: satellites with new elements keep their
+    // index, removed ones are replaced by the last satellite and new ones
+    // are appended. Duplicate catalog numbers keep the first element set.
+    // Sets changed to the indices below the old number of satellites
+    // whose satellite or elements changed, in ascending order. The text
+    // may be gzip compressed.
+    void Refresh(const char *data, size_t size, std::vector<size_t>& changed);
+    // Same with the text of the reader
+    void Refresh(IFileReader& reader, std::vector<size_t>& changed);
 
+    // Number of propagators initialized by the last Init() or Load() and
+    // the Refresh() calls since, the streamed ones are not counted
+    size_t GetInitialized() const {
+        return initialized_;
+    }
+
+    // True until a snapshot has the whole catalog of the streaming load
+    bool IsLoading() const {
+        return loading_.load(std::memory_order_acquire);
+    }
+
+    // Grows during a streaming load, other threads than the one of the
+    // updates take the number of positions of their snapshot instead
     size_t GetNumber() const {
         return sat_.size();
     }
 
+    // Upper bound of the number of satellites of a streaming load
+    size_t GetMaxNumber() const {
+        return sat_.capacity();
+    }
+
+    // Safe from the render thread during a streaming load for the
+    // satellites of the acquired snapshot: the records never move
     Satellite& GetSatellite(size_t index) {
         return sat_[index];
     }
 
+    // Propagates the catalog to the time of the clock and publishes
+    // the snapshot. Called by the producer thread while it runs,
+    // which skips the update if the time did not change and no
+    // batches of a streaming load are waiting.
     void UpdateAll();
+    // Same at the time of the context
+    void UpdateAll(const PropagationContext& context);
+
+    void Start();
+    void Stop();
 
-    double GetMinAltitude() {
-        return min_alt_;
+    // Latest complete snapshot, valid until the next call.
+    // Only one thread may take snapshots.
+    const PositionSnapshot& AcquireSnapshot() {
+        return snapshot_.Acquire();
     }
 
-    double GetMaxAltitude() {
-        return max_alt_;
+    // Snapshot returned by the last AcquireSnapshot()
+    const PositionSnapshot& GetSnapshot() const {
+        return snapshot_.Front();
     }
 };
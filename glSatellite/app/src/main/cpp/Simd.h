@@ -0,0 +1,301 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#define SIMD_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIMD_NEON
+#endif
+
+// ----------------------------------------------------------------------------
+// Packed double precision vector: 4 lanes with AVX2, 2 lanes with SSE2 and
+// NEON (AArch64 only, ARMv7 NEON has no double precision), otherwise 1 lane.
+// Only the operations needed by the propagation kernels are provided.
+// ----------------------------------------------------------------------------
+
+#if defined(SIMD_AVX2)
+
+struct vmask {
+    __m256d m;
+};
+
+struct vdouble {
+    static const size_t WIDTH = 4;
+    __m256d v;
+
+    vdouble() = default;
+    vdouble(__m256d x) : v(x) {
+    }
+    vdouble(double x) : v(_mm256_set1_pd(x)) {
+    }
+
+    static vdouble Load(const double *p) {
+        return _mm256_loadu_pd(p);
+    }
+    void Store(double *p) const {
+        _mm256_storeu_pd(p, v);
+    }
+};
+
+inline vdouble operator+(vdouble a, vdouble b) { return _mm256_add_pd(a.v, b.v); }
+inline vdouble operator-(vdouble a, vdouble b) { return _mm256_sub_pd(a.v, b.v); }
+inline vdouble operator*(vdouble a, vdouble b) { return _mm256_mul_pd(a.v, b.v); }
+inline vdouble operator/(vdouble a, vdouble b) { return _mm256_div_pd(a.v, b.v); }
+inline vdouble operator-(vdouble a) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }
+inline vdouble Sqrt(vdouble a) { return _mm256_sqrt_pd(a.v); }
+inline vdouble Floor(vdouble a) { return _mm256_floor_pd(a.v); }
+inline vdouble Abs(vdouble a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+
+inline vmask operator<(vdouble a, vdouble b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+inline vmask operator<=(vdouble a, vdouble b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ)}; }
+inline vmask operator>(vdouble a, vdouble b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)}; }
+inline vmask operator==(vdouble a, vdouble b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ)}; }
+inline vmask operator&(vmask a, vmask b) { return {_mm256_and_pd(a.m, b.m)}; }
+inline vmask operator|(vmask a, vmask b) { return {_mm256_or_pd(a.m, b.m)}; }
+// a & !b
+inline vmask AndNot(vmask a, vmask b) { return {_mm256_andnot_pd(b.m, a.m)}; }
+inline bool Any(vmask a) { return _mm256_movemask_pd(a.m) != 0; }
+inline vdouble Select(vmask m, vdouble a, vdouble b) { return _mm256_blendv_pd(b.v, a.v, m.m); }
+
+#elif defined(SIMD_SSE2)
+
+struct vmask {
+    __m128d m;
+};
+
+struct vdouble {
+    static const size_t WIDTH = 2;
+    __m128d v;
+
+    vdouble() = default;
+    vdouble(__m128d x) : v(x) {
+    }
+    vdouble(double x) : v(_mm_set1_pd(x)) {
+    }
+
+    static vdouble Load(const double *p) {
+        return _mm_loadu_pd(p);
+    }
+    void Store(double *p) const {
+        _mm_storeu_pd(p, v);
+    }
+};
+
+inline vdouble operator+(vdouble a, vdouble b) { return _mm_add_pd(a.v, b.v); }
+inline vdouble operator-(vdouble a, vdouble b) { return _mm_sub_pd(a.v, b.v); }
+inline vdouble operator*(vdouble a, vdouble b) { return _mm_mul_pd(a.v, b.v); }
+inline vdouble operator/(vdouble a, vdouble b) { return _mm_div_pd(a.v, b.v); }
+inline vdouble operator-(vdouble a) { return _mm_xor_pd(a.v, _mm_set1_pd(-0.0)); }
+inline vdouble Sqrt(vdouble a) { return _mm_sqrt_pd(a.v); }
+inline vdouble Abs(vdouble a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a.v); }
+
+inline vmask operator<(vdouble a, vdouble b) { return {_mm_cmplt_pd(a.v, b.v)}; }
+inline vmask operator<=(vdouble a, vdouble b) { return {_mm_cmple_pd(a.v, b.v)}; }
+inline vmask operator>(vdouble a, vdouble b) { return {_mm_cmpgt_pd(a.v, b.v)}; }
+inline vmask operator==(vdouble a, vdouble b) { return {_mm_cmpeq_pd(a.v, b.v)}; }
+inline vmask operator&(vmask a, vmask b) { return {_mm_and_pd(a.m, b.m)}; }
+inline vmask operator|(vmask a, vmask b) { return {_mm_or_pd(a.m, b.m)}; }
+// a & !b
+inline vmask AndNot(vmask a, vmask b) { return {_mm_andnot_pd(b.m, a.m)}; }
+inline bool Any(vmask a) { return _mm_movemask_pd(a.m) != 0; }
+inline vdouble Select(vmask m, vdouble a, vdouble b) {
+    return _mm_or_pd(_mm_and_pd(m.m, a.v), _mm_andnot_pd(m.m, b.v));
+}
+
+#if defined(__SSE4_1__)
+inline vdouble Floor(vdouble a) { return _mm_floor_pd(a.v); }
+#else
+inline vdouble Floor(vdouble a) {
+    // Round to integer with the 2^52 trick (exact for |a| < 2^52),
+    // then step down where rounding went up
+    const vdouble magic(4503599627370496.0);
+    vdouble sign = _mm_and_pd(a.v, _mm_set1_pd(-0.0));
+    vdouble m = _mm_or_pd(magic.v, sign.v);
+    vdouble r = (a + m) - m;
+    return r - Select(a < r, 1.0, 0.0);
+}
+#endif
+
+#elif defined(SIMD_NEON)
+
+struct vmask {
+    uint64x2_t m;
+};
+
+struct vdouble {
+    static const size_t WIDTH = 2;
+    float64x2_t v;
+
+    vdouble() = default;
+    vdouble(float64x2_t x) : v(x) {
+    }
+    vdouble(double x) : v(vdupq_n_f64(x)) {
+    }
+
+    static vdouble Load(const double *p) {
+        return vld1q_f64(p);
+    }
+    void Store(double *p) const {
+        vst1q_f64(p, v);
+    }
+};
+
+inline vdouble operator+(vdouble a, vdouble b) { return vaddq_f64(a.v, b.v); }
+inline vdouble operator-(vdouble a, vdouble b) { return vsubq_f64(a.v, b.v); }
+inline vdouble operator*(vdouble a, vdouble b) { return vmulq_f64(a.v, b.v); }
+inline vdouble operator/(vdouble a, vdouble b) { return vdivq_f64(a.v, b.v); }
+inline vdouble operator-(vdouble a) { return vnegq_f64(a.v); }
+inline vdouble Sqrt(vdouble a) { return vsqrtq_f64(a.v); }
+inline vdouble Floor(vdouble a) { return vrndmq_f64(a.v); }
+inline vdouble Abs(vdouble a) { return vabsq_f64(a.v); }
+
+inline vmask operator<(vdouble a, vdouble b) { return {vcltq_f64(a.v, b.v)}; }
+inline vmask operator<=(vdouble a, vdouble b) { return {vcleq_f64(a.v, b.v)}; }
+inline vmask operator>(vdouble a, vdouble b) { return {vcgtq_f64(a.v, b.v)}; }
+inline vmask operator==(vdouble a, vdouble b) { return {vceqq_f64(a.v, b.v)}; }
+inline vmask operator&(vmask a, vmask b) { return {vandq_u64(a.m, b.m)}; }
+inline vmask operator|(vmask a, vmask b) { return {vorrq_u64(a.m, b.m)}; }
+// a & !b
+inline vmask AndNot(vmask a, vmask b) { return {vbicq_u64(a.m, b.m)}; }
+inline bool Any(vmask a) {
+    return (vgetq_lane_u64(a.m, 0) | vgetq_lane_u64(a.m, 1)) != 0;
+}
+inline vdouble Select(vmask m, vdouble a, vdouble b) { return vbslq_f64(m.m, a.v, b.v); }
+
+#else
+
+struct vmask {
+    bool m;
+};
+
+struct vdouble {
+    static const size_t WIDTH = 1;
+    double v;
+
+    vdouble() = default;
+    vdouble(double x) : v(x) {
+    }
+
+    static vdouble Load(const double *p) {
+        return *p;
+    }
+    void Store(double *p) const {
+        *p = v;
+    }
+};
+
+inline vdouble operator+(vdouble a, vdouble b) { return a.v + b.v; }
+inline vdouble operator-(vdouble a, vdouble b) { return a.v - b.v; }
+inline vdouble operator*(vdouble a, vdouble b) { return a.v * b.v; }
+inline vdouble operator/(vdouble a, vdouble b) { return a.v / b.v; }
+inline vdouble operator-(vdouble a) { return -a.v; }
+inline vdouble Sqrt(vdouble a) { return sqrt(a.v); }
+inline vdouble Floor(vdouble a) { return floor(a.v); }
+inline vdouble Abs(vdouble a) { return fabs(a.v); }
+
+inline vmask operator<(vdouble a, vdouble b) { return {a.v < b.v}; }
+inline vmask operator<=(vdouble a, vdouble b) { return {a.v <= b.v}; }
+inline vmask operator>(vdouble a, vdouble b) { return {a.v > b.v}; }
+inline vmask operator==(vdouble a, vdouble b) { return {a.v == b.v}; }
+inline vmask operator&(vmask a, vmask b) { return {a.m && b.m}; }
+inline vmask operator|(vmask a, vmask b) { return {a.m || b.m}; }
+// a & !b
+inline vmask AndNot(vmask a, vmask b) { return {a.m && !b.m}; }
+inline bool Any(vmask a) { return a.m; }
+inline vdouble Select(vmask m, vdouble a, vdouble b) { return m.m ? a : b; }
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Math functions on packed vectors. The polynomials are taken from the
+// Cephes library, they are accurate to a few ulps for the argument ranges
+// used by SGP4 (|x| < 1E5 for the trigonometric functions).
+// ----------------------------------------------------------------------------
+
+namespace simd {
+
+inline vdouble Polevl(vdouble x, const double *coef, int n) {
+    vdouble r = coef[0];
+    for (int i = 1; i <= n; ++i) {
+        r = r * x + coef[i];
+    }
+    return r;
+}
+
+inline vdouble P1evl(vdouble x, const double *coef, int n) {
+    vdouble r = x + coef[0];
+    for (int i = 1; i < n; ++i) {
+        r = r * x + coef[i];
+    }
+    return r;
+}
+
+inline void SinCos(vdouble x, vdouble &s, vdouble &c) {
+    static const double SINCOF[] = {1.58962301576546568060E-10,
+        -2.50507477628578072866E-8, 2.75573136213857245213E-6,
+        -1.98412698295895385996E-4, 8.33333333332211858878E-3,
+        -1.66666666666666307295E-1};
+    static const double COSCOF[] = {-1.13585365213876817300E-11,
+        2.08757008419747316778E-9, -2.75573141792967388112E-7,
+        2.48015872888517045348E-5, -1.38888888888730564116E-3,
+        4.16666666666665929218E-2};
+    const double DP1 = 7.85398125648498535156E-1;
+    const double DP2 = 3.77489470793079817668E-8;
+    const double DP3 = 2.69515142907905952645E-15;
+    const double FOPI = 1.27323954473516268615; // 4/Pi
+
+    vdouble ax = Abs(x);
+    // Octant number rounded up to even, so z is in [-Pi/4, Pi/4]
+    vdouble y = Floor(ax * FOPI);
+    y = y + (y - 2.0 * Floor(y * 0.5));
+    vdouble z = ((ax - y * DP1) - y * DP2) - y * DP3;
+    vdouble zz = z * z;
+    vdouble ps = z + z * zz * Polevl(zz, SINCOF, 5);
+    vdouble pc = 1.0 - 0.5 * zz + zz * zz * Polevl(zz, COSCOF, 5);
+
+    // Quadrant 0..3
+    vdouble q = y * 0.5;
+    q = q - 4.0 * Floor(q * 0.25);
+    vmask swap = (q == 1.0) | (q == 3.0);
+    vdouble rs = Select(swap, pc, ps);
+    vdouble rc = Select(swap, ps, pc);
+    rs = Select(q > 1.5, -rs, rs);
+    rc = Select((q == 1.0) | (q == 2.0), -rc, rc);
+    s = Select(x < 0.0, -rs, rs);
+    c = rc;
+}
+
+inline vdouble Atan(vdouble x) {
+    static const double P[] = {-8.750608600031904122785E-1,
+        -1.615753718733365076637E1, -7.500855792314704667340E1,
+        -1.228866684490136173410E2, -6.485021904942025371773E1};
+    static const double Q[] = {2.485846490142306297962E1,
+        1.650270098316988542046E2, 4.328810604912902668951E2,
+        4.853903996359136964868E2, 1.945506571482613964425E2};
+    const double T3P8 = 2.41421356237309504880; // tan(3*Pi/8)
+    const double MOREBITS = 6.123233995736765886130E-17;
+
+    vdouble ax = Abs(x);
+    vmask big = ax > T3P8;
+    vmask mid = AndNot(ax > 0.66, big);
+    vdouble y = Select(big, M_PI_2, Select(mid, M_PI_4, 0.0));
+    vdouble t = Select(big, -1.0 / ax, Select(mid, (ax - 1.0) / (ax + 1.0), ax));
+    vdouble z = t * t;
+    z = z * Polevl(z, P, 4) / P1evl(z, Q, 5);
+    z = t * z + t;
+    z = z + Select(big, MOREBITS, Select(mid, 0.5 * MOREBITS, 0.0));
+    y = y + z;
+    return Select(x < 0.0, -y, y);
+}
+
+}  // namespace simd
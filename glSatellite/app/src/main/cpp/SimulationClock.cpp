@@ -0,0 +1,79 @@
+#include <algorithm>
+
+#include "Satellite.h"
+#include "SatelliteConst.h"
+#include "SimulationClock.h"
+
+using namespace std;
+
+constexpr double SimulationClock::MAX_RATE;
+
+SimulationClock::SimulationClock() :
+        base_daynum_(CurrentDaynum()),
+        base_time_(Clock::now()),
+        rate_(1),
+        paused_(false),
+        now_(base_daynum_) {
+}
+
+double SimulationClock::DaynumAt(Clock::time_point time) const {
+    if (paused_) {
+        return base_daynum_;
+    }
+    chrono::duration<double> elapsed = time - base_time_;
+    return base_daynum_ + rate_ * elapsed.count() / SECDAY;
+}
+
+void SimulationClock::Anchor(Clock::time_point time) {
+    base_daynum_ = DaynumAt(time);
+    base_time_ = time;
+}
+
+void SimulationClock::Tick() {
+    lock_guard<mutex> lock(mutex_);
+    now_.store(DaynumAt(Clock::now()), memory_order_release);
+}
+
+void SimulationClock::SetRate(double rate) {
+    lock_guard<mutex> lock(mutex_);
+    Anchor(Clock::now());
+    rate_ = min(max(rate, -MAX_RATE), MAX_RATE);
+}
+
+double SimulationClock::GetRate() const {
+    lock_guard<mutex> lock(mutex_);
+    return rate_;
+}
+
+void SimulationClock::Pause() {
+    lock_guard<mutex> lock(mutex_);
+    Anchor(Clock::now());
+    paused_ = true;
+}
+
+void SimulationClock::Resume() {
+    lock_guard<mutex> lock(mutex_);
+    Anchor(Clock::now());
+    paused_ = false;
+}
+
+bool SimulationClock::IsPaused() const {
+    lock_guard<mutex> lock(mutex_);
+    return paused_;
+}
+
+void SimulationClock::JumpTo(double daynum) {
+    lock_guard<mutex> lock(mutex_);
+    base_daynum_ = daynum;
+    base_time_ = Clock::now();
+    now_.store(daynum, memory_order_release);
+}
+
+void SimulationClock::Reset() {
+    lock_guard<mutex> lock(mutex_);
+    base_daynum_ = CurrentDaynum();
+    base_time_ = Clock::now();
+    rate_ = 1;
+    paused_ = false;
+    now_.store(base_daynum_, memory_order_release);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+/*
+ * Simulated time of the propagation, as days since 31Dec79 00:00:00 UTC
+ * like CurrentDaynum(). It starts at the wall clock time and runs at a
+ * rate of -MAX_RATE to MAX_RATE times the monotonic clock, it can be
+ * paused and moved to any time.
+ *
+ * The time advances only in Tick(), once per rendered frame, so every
+ * reader of Now() in between gets the same time. Jumps only change the
+ * time: the ephemeris cache and the deep-space checkpoints continue from
+ * whatever time comes next.
+ */
+class SimulationClock {
+    typedef std::chrono::steady_clock Clock;
+
+    // Guards the anchor, the controls come from other threads than Tick()
+    mutable std::mutex mutex_;
+    // Simulated time at the monotonic time base_time_
+    double base_daynum_;
+    Clock::time_point base_time_;
+    double rate_;
+    bool paused_;
+    // Time of the last Tick()
+    std::atomic<double> now_;
+
+    double DaynumAt(Clock::time_point time) const;
+    // Restarts the linear time from the current time
+    void Anchor(Clock::time_point time);
+public:
+    static constexpr double MAX_RATE = 10000;
+
+    SimulationClock();
+
+    // Advances the time to the monotonic clock
+    void Tick();
+
+    // Time of the last Tick(), safe to read from any thread
+    double Now() const {
+        return now_.load(std::memory_order_acquire);
+    }
+
+    // Clamped to [-MAX_RATE, MAX_RATE], negative rates run backwards
+    void SetRate(double rate);
+    double GetRate() const;
+
+    void Pause();
+    void Resume();
+    bool IsPaused() const;
+
+    // Moves to the given time, keeping the rate and the pause state
+    void JumpTo(double daynum);
+
+    // Back to the wall clock time at normal rate
+    void Reset();
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Read-only view of characters owned by someone else, the part of
+ * std::string_view the parsers need (the app is built as C++11).
+ */
+struct StringView {
+    const char *data;
+    size_t size;
+
+    StringView() :
+            data(nullptr),
+            size(0) {
+    }
+
+    StringView(const char *data, size_t size) :
+            data(data),
+            size(size) {
+    }
+
+    StringView(const std::string& str) :
+            data(str.data()),
+            size(str.size()) {
+    }
+
+    const char& operator[](size_t pos) const {
+        return data[pos];
+    }
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    std::string str() const {
+        return std::string(data, size);
+    }
+};
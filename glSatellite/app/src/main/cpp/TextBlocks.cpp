@@ -0,0 +1,159 @@
+#include <cstring>
+
+#include "TextBlocks.h"
+
+// Magic numbers at the start of the compressed formats
+static const unsigned char GZIP_MAGIC[] = {0x1F, 0x8B};
+static const unsigned char ZSTD_MAGIC[] = {0x28, 0xB5, 0x2F, 0xFD};
+// Inflated bytes per call of GetSize()
+static const size_t SIZE_BUFFER = 1 << 16;
+
+static bool StartsWith(StringView data, const unsigned char *magic,
+    size_t size) {
+    return data.size >= size && memcmp(data.data, magic, size) == 0;
+}
+
+TextBlocks::TextBlocks(StringView data, size_t group, size_t block_size) :
+        data_(data),
+        group_(group),
+        block_size_(block_size) {
+    memset(&stream_, 0, sizeof(stream_));
+    if (StartsWith(data, ZSTD_MAGIC, sizeof(ZSTD_MAGIC))) {
+        // No decoder in the NDK
+        error_ = true;
+        end_ = true;
+    } else if (IsGzip(data)) {
+        compressed_ = true;
+        stream_.next_in = (Bytef*)data.data;
+        stream_.avail_in = data.size;
+        // Only the gzip format, with its header and trailer
+        stream_open_ = inflateInit2(&stream_, 16 + MAX_WBITS) == Z_OK;
+        if (!stream_open_) {
+            error_ = true;
+            end_ = true;
+        }
+    }
+}
+
+TextBlocks::~TextBlocks() {
+    if (stream_open_) {
+        inflateEnd(&stream_);
+    }
+}
+
+bool TextBlocks::IsGzip(StringView data) {
+    return StartsWith(data, GZIP_MAGIC, sizeof(GZIP_MAGIC));
+}
+
+size_t TextBlocks::GetSize(StringView data) {
+    if (!IsGzip(data)) {
+        return data.size;
+    }
+    // The trailers only hold the size of their own member, and where a
+    // member ends is known after inflating it
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        return 0;
+    }
+    stream.next_in = (Bytef*)data.data;
+    stream.avail_in = data.size;
+    char scratch[SIZE_BUFFER];
+    size_t size = 0;
+    for (;;) {
+        stream.next_out = (Bytef*)scratch;
+        stream.avail_out = sizeof(scratch);
+        int result = inflate(&stream, Z_NO_FLUSH);
+        size += sizeof(scratch) - stream.avail_out;
+        if (result == Z_STREAM_END) {
+            // The members Inflate() reads, see there
+            StringView rest((const char*)stream.next_in, stream.avail_in);
+            if (!IsGzip(rest)) {
+                break;
+            }
+            inflateReset(&stream);
+        } else if (result != Z_OK) {
+            // Up to the damage, like the blocks
+            break;
+        }
+    }
+    inflateEnd(&stream);
+    return size;
+}
+
+void TextBlocks::Inflate() {
+    stream_.next_out = (Bytef*)buffer_.data() + filled_;
+    stream_.avail_out = buffer_.size() - filled_;
+    int result = inflate(&stream_, Z_NO_FLUSH);
+    filled_ = buffer_.size() - stream_.avail_out;
+    if (result == Z_STREAM_END) {
+        // Concatenated members of one file, anything else after the
+        // first member is ignored like gzip does
+        StringView rest((const char*)stream_.next_in, stream_.avail_in);
+        if (IsGzip(rest)) {
+            inflateReset(&stream_);
+        } else {
+            input_end_ = true;
+        }
+    } else if (result != Z_OK
+            && !(result == Z_BUF_ERROR && stream_.avail_in > 0)) {
+        // Damaged, or truncated when no input is left
+        error_ = true;
+        input_end_ = true;
+    }
+}
+
+bool TextBlocks::Next(StringView &block) {
+    if (end_) {
+        return false;
+    }
+    if (!compressed_) {
+        block = data_;
+        end_ = true;
+        return true;
+    }
+
+    // The lines after the last block move to the front
+    memmove(buffer_.data(), buffer_.data() + begin_, filled_ - begin_);
+    filled_ -= begin_;
+    scanned_ -= begin_;
+    begin_ = 0;
+    if (buffer_.size() < block_size_) {
+        buffer_.resize(block_size_);
+    }
+
+    // Up to the last group of lines that ends in a full buffer
+    size_t end = 0;
+    while (!input_end_) {
+        if (filled_ == buffer_.size()) {
+            if (end > 0) {
+                break;
+            }
+            // One group of lines longer than the buffer
+            buffer_.resize(2 * buffer_.size());
+        }
+        Inflate();
+        const char *data = buffer_.data();
+        const char *pos = data + scanned_;
+        const char *filled = data + filled_;
+        while ((pos = static_cast<const char*>(memchr(pos, '\n',
+            filled - pos)))) {
+            ++pos;
+            if (++lines_ % group_ == 0) {
+                end = pos - data;
+            }
+        }
+        scanned_ = filled_;
+    }
+    if (input_end_) {
+        // The rest, the last line may have no line break
+        end = filled_;
+        end_ = true;
+        if (end == 0) {
+            return false;
+        }
+    }
+    block = StringView(buffer_.data(), end);
+    begin_ = end;
+    return true;
+}
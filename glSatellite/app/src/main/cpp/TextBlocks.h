@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <zlib.h>
+
+#include "StringView.h"
+
+/*
+ * Blocks of a catalog text, plain or gzip compressed. Plain text is one
+ * block. Compressed text is inflated into one buffer a block at a time,
+ * and every block ends after a multiple of group lines from the start of
+ * the text: with the three lines of an element set the blocks hold whole
+ * sets and parse like the text in one piece. Only the compressed data
+ * and one block are in memory.
+ */
+class TextBlocks {
+    StringView data_;
+    size_t group_;
+    size_t block_size_;
+    bool compressed_ = false;
+    z_stream stream_;
+    bool stream_open_ = false;
+    // All input inflated, or it stopped on an error
+    bool input_end_ = false;
+    bool end_ = false;
+    bool error_ = false;
+    std::vector<char> buffer_;
+    // Inflated bytes in the buffer, the first begin_ of them are the
+    // last block, and the lines are counted up to scanned_
+    size_t begin_ = 0;
+    size_t filled_ = 0;
+    size_t scanned_ = 0;
+    size_t lines_ = 0;
+
+    // Inflates into the rest of the buffer
+    void Inflate();
+public:
+    // Uncompressed text in the blocks of a compressed one
+    static const size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    TextBlocks(StringView data, size_t group,
+        size_t block_size = DEFAULT_BLOCK_SIZE);
+    ~TextBlocks();
+
+    TextBlocks(const TextBlocks&) = delete;
+    TextBlocks& operator=(const TextBlocks&) = delete;
+
+    // True if the data starts like a gzip file
+    static bool IsGzip(StringView data);
+    // Size of the text. For gzip the inflated size of all members, or
+    // of the data up to the damage, which takes a pass over the data.
+    static size_t GetSize(StringView data);
+
+    // Next block, valid until the next call. False at the end of the
+    // text, or if the data cannot be read at all.
+    bool Next(StringView &block);
+
+    // True if compressed data was damaged or truncated, or it is of a
+    // format without a decoder (zstd). The blocks up to the damage are
+    // returned.
+    bool error() const {
+        return error_;
+    }
+};
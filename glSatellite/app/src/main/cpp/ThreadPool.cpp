@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <sched.h>
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+static uint64_t MakeRange(uint32_t begin, uint32_t end) {
+    return ((uint64_t)begin << 32) | end;
+}
+
+ThreadPool::ThreadPool(size_t threads, const vector<int> &affinity) {
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    num_threads_ = threads;
+    queue_.reset(new ChunkQueue[num_threads_]);
+    for (size_t i = 0; i < num_threads_; ++i) {
+        queue_[i].range = 0;
+    }
+    for (size_t i = 1; i < num_threads_; ++i) {
+        int cpu = i - 1 < affinity.size() ? affinity[i - 1] : -1;
+        threads_.emplace_back(&ThreadPool::WorkerLoop, this, i, cpu);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto &thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t worker, int cpu) {
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+
+    uint64_t generation = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] {
+                return stop_ || generation_ != generation;
+            });
+            if (stop_) {
+                return;
+            }
+            generation = generation_;
+        }
+
+        Run(worker);
+
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (--running_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const Task &task) {
+    if (count == 0) {
+        return;
+    }
+    grain = max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    if (num_threads_ == 1 || chunks == 1) {
+        task(0, count, 0);
+        return;
+    }
+
+    // Initial equal shares
+    for (size_t i = 0; i < num_threads_; ++i) {
+        uint32_t begin = chunks * i / num_threads_;
+        uint32_t end = chunks * (i + 1) / num_threads_;
+        queue_[i].range.store(MakeRange(begin, end), memory_order_relaxed);
+    }
+
+    {
+        lock_guard<mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        grain_ = grain;
+        running_ = num_threads_ - 1;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    Run(0);
+
+    unique_lock<mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] {
+        return running_ == 0;
+    });
+    task_ = nullptr;
+}
+
+void ThreadPool::Run(size_t worker) {
+    uint32_t chunk;
+    while (Pop(worker, chunk) || Steal(worker, chunk)) {
+        size_t begin = chunk * grain_;
+        size_t end = min(begin + grain_, count_);
+        (*task_)(begin, end, worker);
+    }
+}
+
+bool ThreadPool::Pop(size_t worker, uint32_t &chunk) {
+    auto &range = queue_[worker].range;
+    uint64_t old = range.load(memory_order_acquire);
+    for (;;) {
+        uint32_t begin = old >> 32;
+        uint32_t end = (uint32_t)old;
+        if (begin >= end) {
+            return false;
+        }
+        if (range.compare_exchange_weak(old, MakeRange(begin + 1, end),
+            memory_order_acq_rel)) {
+            chunk = begin;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::Steal(size_t worker, uint32_t &chunk) {
+    for (size_t i = 1; i < num_threads_; ++i) {
+        auto &range = queue_[(worker + i) % num_threads_].range;
+        uint64_t old = range.load(memory_order_acquire);
+        for (;;) {
+            uint32_t begin = old >> 32;
+            uint32_t end = (uint32_t)old;
+            if (begin >= end) {
+                break;
+            }
+            // Take the back half, keep the first of them to run now
+            uint32_t half = end - (end - begin + 1) / 2;
+            if (range.compare_exchange_weak(old, MakeRange(begin, half),
+                memory_order_acq_rel)) {
+                chunk = half;
+                // The own queue is empty, so nobody else changes it now
+                queue_[worker].range.store(MakeRange(half + 1, end),
+                    memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Size of the cache line used to align shared data
+const size_t CACHE_LINE = 64;
+
+/*
+ * Fixed set of worker threads running parallel loops. The loop is split
+ * into chunks, every participant (the calling thread is one of them) gets
+ * an equal share of the chunks and steals half of the remaining chunks of
+ * another participant when its own share is done.
+ */
+class ThreadPool {
+public:
+    // Runs the [begin, end) part of the loop on the given participant
+    typedef std::function<void(size_t begin, size_t end, size_t worker)> Task;
+
+private:
+    // Remaining chunks of a participant: begin in the high 32 bits,
+    // end in the low 32 bits. The owner pops from the front, thieves
+    // take from the back, both with CAS on the same word.
+    // Padded to a cache line so the queues do not share lines.
+    struct ChunkQueue {
+        std::atomic<uint64_t> range;
+        char pad[CACHE_LINE - sizeof(std::atomic<uint64_t>)];
+    };
+
+    size_t num_threads_;
+    std::unique_ptr<ChunkQueue[]> queue_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    size_t running_ = 0;
+    bool stop_ = false;
+
+    const Task *task_ = nullptr;
+    size_t count_ = 0;
+    size_t grain_ = 1;
+
+    void WorkerLoop(size_t worker, int cpu);
+    void Run(size_t worker);
+    bool Pop(size_t worker, uint32_t &chunk);
+    bool Steal(size_t worker, uint32_t &chunk);
+
+public:
+    // threads is the number of participants including the calling thread,
+    // 0 means one per core. affinity optionally pins the worker threads
+    // (participants 1..threads-1) to the listed CPUs, -1 leaves it unset.
+    explicit ThreadPool(size_t threads = 0,
+        const std::vector<int> &affinity = std::vector<int>());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadCount() const {
+        return num_threads_;
+    }
+
+    // Calls task for [0, count) in chunks of grain items and blocks until
+    // all chunks are done. Not reentrant: only one loop runs at a time.
+    void ParallelFor(size_t count, size_t grain, const Task &task);
+};
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "Simd.h"
+#include "TleParser.h"
+
+// Powers of ten that are exact doubles
+static const double POW10[] = {
+    1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11, 1E12,
+    1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22
+};
+
+TleParser::TleParser(const char *data, size_t size) :
+        pos_(data),
+        end_(data + size) {
+}
+
+StringView TleParser::NextLine() {
+    const char *begin = pos_;
+    const char *end = static_cast<const char*>(memchr(pos_, '\n',
+        end_ - pos_));
+    if (end) {
+        pos_ = end + 1;
+    } else {
+        end = pos_ = end_;
+    }
+    if (end > begin && end[-1] == '\r') {
+        --end;
+    }
+    return StringView(begin, end - begin);
+}
+
+bool TleParser::Next(TleLines &lines) {
+    if (eof()) {
+        return false;
+    }
+    lines.name = NextLine();
+    lines.line1 = NextLine();
+    lines.line2 = NextLine();
+    return true;
+}
+
+long ParseLong(const char *line, size_t begin, size_t end) {
+    long value = 0;
+    bool negative = false;
+    bool started = false;
+    for (size_t i = begin; i <= end; ++i) {
+        char c = line[i];
+        if (c == ' ') {
+            continue;
+        }
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            started = true;
+        } else if ((c == '-' || c == '+') && !started) {
+            negative = c == '-';
+            started = true;
+        } else {
+            break;
+        }
+    }
+    return negative ? -value : value;
+}
+
+double ParseDouble(const char *line, size_t begin, size_t end) {
+    // The field as an integer mantissa and a number of decimals. Both are
+    // exact doubles, so their quotient is correctly rounded like atof().
+    unsigned long long mantissa = 0;
+    size_t digits = 0;
+    size_t decimals = 0;
+    bool negative = false;
+    bool point = false;
+    bool started = false;
+    size_t i = begin;
+    for (; i <= end; ++i) {
+        char c = line[i];
+        unsigned digit = (unsigned char)c - '0';
+        if (digit < 10) {
+            mantissa = mantissa * 10 + digit;
+            digits += mantissa > 0;
+            decimals += point;
+        } else if (c == ' ') {
+            continue;
+        } else if (c == '.' && !point) {
+            point = true;
+        } else if ((c == '-' || c == '+') && !started) {
+            negative = c == '-';
+        } else {
+            break;
+        }
+        started = true;
+    }
+
+    const size_t MAX_DECIMALS = sizeof(POW10) / sizeof(POW10[0]) - 1;
+    if (i <= end || digits > 15 || decimals > MAX_DECIMALS) {
+        // Exponents, long mantissas and trailing characters are not in
+        // TLEs, leave them to atof()
+        char field[64];
+        size_t length = 0;
+        for (i = begin; i <= end && length < sizeof(field) - 1; ++i) {
+            if (line[i] != ' ') {
+                field[length++] = line[i];
+            }
+        }
+        field[length] = '\0';
+        return atof(field);
+    }
+
+    double value = (double)mantissa / POW10[decimals];
+    return negative ? -value : value;
+}
+
+double Pow10(int exponent) {
+    if (exponent >= 0 && exponent < (int)(sizeof(POW10) / sizeof(POW10[0]))) {
+        return POW10[exponent];
+    }
+    return pow(10.0, exponent);
+}
+
+/* Contribution of a character to the modulo 10 checksum. */
+static unsigned ChecksumValue(char c) {
+    unsigned digit = (unsigned char)c - '0';
+    return digit < 10 ? digit : c == '-';
+}
+
+static bool IsDigit(char c) {
+    unsigned digit = (unsigned char)c - '0';
+    return digit < 10;
+}
+
+bool KepCheckScalar(const StringView &line1, const StringView &line2) {
+    /* This function scans line 1 and line 2 of a NASA 2-Line element
+     set and returns a 1 if the element set appears to be valid or
+     a 0 if it does not.  If the data survives this torture test,
+     it's a pretty safe bet we're looking at a valid 2-line
+     element set and not just some random text that might pass
+     as orbital data based on a simple checksum calculation alone. */
+
+    int x;
+    unsigned sum1, sum2;
+
+    if (line1.size < TLE_LINE_LENGTH || line2.size < TLE_LINE_LENGTH) {
+        return false;
+    }
+
+    /* Compute checksum for each line */
+
+    for (x = 0, sum1 = 0, sum2 = 0; x <= 67; sum1 += ChecksumValue(line1[x]),
+        sum2 += ChecksumValue(line2[x]), ++x)
+        ;
+
+    /* Perform a "torture test" on the data */
+
+    x = (ChecksumValue(line1[68]) ^ (sum1 % 10))
+            | (ChecksumValue(line2[68]) ^ (sum2 % 10)) | (line1[0] ^ '1')
+            | (line1[1] ^ ' ') | (line1[7] ^ 'U') | (line1[8] ^ ' ')
+            | (line1[17] ^ ' ') | (line1[23] ^ '.') | (line1[32] ^ ' ')
+            | (line1[34] ^ '.') | (line1[43] ^ ' ') | (line1[52] ^ ' ')
+            | (line1[61] ^ ' ') | (line1[62] ^ '0') | (line1[63] ^ ' ')
+            | (line2[0] ^ '2') | (line2[1] ^ ' ') | (line2[7] ^ ' ')
+            | (line2[11] ^ '.') | (line2[16] ^ ' ') | (line2[20] ^ '.')
+            | (line2[25] ^ ' ') | (line2[33] ^ ' ') | (line2[37] ^ '.')
+            | (line2[42] ^ ' ') | (line2[46] ^ '.') | (line2[51] ^ ' ')
+            | (line2[54] ^ '.') | (line1[2] ^ line2[2]) | (line1[3] ^ line2[3])
+            | (line1[4] ^ line2[4]) | (line1[5] ^ line2[5])
+            | (line1[6] ^ line2[6]) | (IsDigit(line1[68]) ? 0 : 1)
+            | (IsDigit(line2[68]) ? 0 : 1) | (IsDigit(line1[18]) ? 0 : 1)
+            | (IsDigit(line1[19]) ? 0 : 1) | (IsDigit(line2[31]) ? 0 : 1)
+            | (IsDigit(line2[32]) ? 0 : 1);
+
+    return !x;
+}
+
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2) || defined(SIMD_NEON)
+
+// Fixed columns of the two lines for the SIMD check, the same as the
+// torture test of KepCheckScalar(): '?' is any character, '#' a digit
+// and anything else that character. Column 68 is the checksum.
+static const char LINE_FORMAT[2][TLE_LINE_LENGTH + 1] = {
+    "1 ?????U ???????? ##???.???????? ?.???????? ???????? ???????? 0 ????#",
+    "2 ????? ???.???? ???.???? ?????## ???.???? ???.???? ??.?????????????#"
+};
+
+// Columns of the catalog number, the same in both lines
+static const size_t CATNUM_BEGIN = 2;
+static const size_t CATNUM_END = 6;
+
+// The 69 columns of a line as five 16-byte vectors, the last one
+// overlaps the one before. A column belongs to the first vector
+// with it, the masks of the others leave it out.
+static const size_t CHUNKS = 5;
+static const size_t CHUNK_OFFSET[CHUNKS] = {0, 16, 32, 48, 53};
+
+// Byte masks of one line by vector: the fixed characters, the digits,
+// the columns of the checksum and the catalog number
+struct LineMasks {
+    uint8_t fixed[CHUNKS][16];
+    uint8_t expected[CHUNKS][16];
+    uint8_t digit[CHUNKS][16];
+    uint8_t sum[CHUNKS][16];
+    uint8_t catnum[16];
+};
+
+static LineMasks MakeMasks(const char *format) {
+    LineMasks masks;
+    memset(&masks, 0, sizeof(masks));
+    for (size_t i = 0; i < TLE_LINE_LENGTH; ++i) {
+        size_t k = std::min(i / 16, CHUNKS - 1);
+        size_t j = i - CHUNK_OFFSET[k];
+        if (format[i] == '#') {
+            masks.digit[k][j] = 0xFF;
+        } else if (format[i] != '?') {
+            masks.fixed[k][j] = 0xFF;
+            masks.expected[k][j] = format[i];
+        }
+        masks.sum[k][j] = i < TLE_LINE_LENGTH - 1 ? 0xFF : 0;
+    }
+    for (size_t i = CATNUM_BEGIN; i <= CATNUM_END; ++i) {
+        masks.catnum[i] = 0xFF;
+    }
+    return masks;
+}
+
+static const LineMasks LINE_MASKS[2] = {
+    MakeMasks(LINE_FORMAT[0]), MakeMasks(LINE_FORMAT[1])
+};
+
+#endif
+
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+
+static __m128i Load(const void *p) {
+    return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+
+/* Format errors of the line, non-zero bytes if any, and its checksum. */
+static __m128i CheckLine(const char *line, const LineMasks &masks,
+    unsigned &sum) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i errors = zero;
+    __m128i total = zero;
+    for (size_t k = 0; k < CHUNKS; ++k) {
+        __m128i c = Load(line + CHUNK_OFFSET[k]);
+        errors = _mm_or_si128(errors, _mm_and_si128(
+            _mm_xor_si128(c, Load(masks.expected[k])), Load(masks.fixed[k])));
+
+        // Digits are at most 9 after subtracting '0', unsigned
+        __m128i value = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        __m128i is_digit = _mm_cmpeq_epi8(
+            _mm_min_epu8(value, _mm_set1_epi8(9)), value);
+        errors = _mm_or_si128(errors,
+            _mm_andnot_si128(is_digit, Load(masks.digit[k])));
+
+        // A digit counts its value, a minus sign one
+        value = _mm_or_si128(_mm_and_si128(is_digit, value),
+            _mm_and_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('-')),
+                _mm_set1_epi8(1)));
+        total = _mm_add_epi64(total, _mm_sad_epu8(
+            _mm_and_si128(value, Load(masks.sum[k])), zero));
+    }
+    sum = _mm_cvtsi128_si32(total)
+            + _mm_cvtsi128_si32(_mm_unpackhi_epi64(total, total));
+    return errors;
+}
+
+bool KepCheck(const StringView &line1, const StringView &line2) {
+    if (line1.size < TLE_LINE_LENGTH || line2.size < TLE_LINE_LENGTH) {
+        return false;
+    }
+    unsigned sum1, sum2;
+    __m128i errors = _mm_or_si128(
+        CheckLine(line1.data, LINE_MASKS[0], sum1),
+        CheckLine(line2.data, LINE_MASKS[1], sum2));
+    errors = _mm_or_si128(errors, _mm_and_si128(
+        _mm_xor_si128(Load(line1.data), Load(line2.data)),
+        Load(LINE_MASKS[0].catnum)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128()))
+            == 0xFFFF
+            && ChecksumValue(line1[TLE_LINE_LENGTH - 1]) == sum1 % 10
+            && ChecksumValue(line2[TLE_LINE_LENGTH - 1]) == sum2 % 10;
+}
+
+#elif defined(SIMD_NEON)
+
+/* Format errors of the line, non-zero bytes if any, and its checksum. */
+static uint8x16_t CheckLine(const char *line, const LineMasks &masks,
+    unsigned &sum) {
+    uint8x16_t errors = vdupq_n_u8(0);
+    sum = 0;
+    for (size_t k = 0; k < CHUNKS; ++k) {
+        uint8x16_t c = vld1q_u8(
+            reinterpret_cast<const uint8_t*>(line + CHUNK_OFFSET[k]));
+        errors = vorrq_u8(errors, vandq_u8(
+            veorq_u8(c, vld1q_u8(masks.expected[k])),
+            vld1q_u8(masks.fixed[k])));
+
+        // Digits are at most 9 after subtracting '0', unsigned
+        uint8x16_t value = vsubq_u8(c, vdupq_n_u8('0'));
+        uint8x16_t is_digit = vcleq_u8(value, vdupq_n_u8(9));
+        errors = vorrq_u8(errors, vbicq_u8(vld1q_u8(masks.digit[k]),
+            is_digit));
+
+        // A digit counts its value, a minus sign one
+        value = vorrq_u8(vandq_u8(is_digit, value),
+            vandq_u8(vceqq_u8(c, vdupq_n_u8('-')), vdupq_n_u8(1)));
+        sum += vaddlvq_u8(vandq_u8(value, vld1q_u8(masks.sum[k])));
+    }
+    return errors;
+}
+
+bool KepCheck(const StringView &line1, const StringView &line2) {
+    if (line1.size < TLE_LINE_LENGTH || line2.size < TLE_LINE_LENGTH) {
+        return false;
+    }
+    unsigned sum1, sum2;
+    uint8x16_t errors = vorrq_u8(CheckLine(line1.data, LINE_MASKS[0], sum1),
+        CheckLine(line2.data, LINE_MASKS[1], sum2));
+    errors = vorrq_u8(errors, vandq_u8(
+        veorq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(line1.data)),
+            vld1q_u8(reinterpret_cast<const uint8_t*>(line2.data))),
+        vld1q_u8(LINE_MASKS[0].catnum)));
+    return vmaxvq_u8(errors) == 0
+            && ChecksumValue(line1[TLE_LINE_LENGTH - 1]) == sum1 % 10
+            && ChecksumValue(line2[TLE_LINE_LENGTH - 1]) == sum2 % 10;
+}
+
+#else
+
+bool KepCheck(const StringView &line1, const StringView &line2) {
+    return KepCheckScalar(line1, line2);
+}
+
+#endif
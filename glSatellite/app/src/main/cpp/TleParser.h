@@ -0,0 +1,56 @@
+#pragma once
+
+#include "StringView.h"
+
+// Length of a TLE line up to and including the checksum
+const size_t TLE_LINE_LENGTH = 69;
+// Lines of one element set, the name and the two element lines
+const size_t TLE_SET_LINES = 3;
+
+/* The three lines of one element set, pointing into the parsed buffer. */
+struct TleLines {
+    StringView name;
+    StringView line1;
+    StringView line2;
+};
+
+/*
+ * Walks the three-line element sets of a contiguous buffer. Nothing is
+ * copied: the lines are views into the buffer, and the fields are
+ * decoded from their fixed columns by ParseLong() and ParseDouble().
+ * Lines end with "\n" or "\r\n", the last line may have no line break.
+ */
+class TleParser {
+    const char *pos_;
+    const char *end_;
+
+    StringView NextLine();
+public:
+    TleParser(const char *data, size_t size);
+
+    bool eof() const {
+        return pos_ == end_;
+    }
+
+    // Next three lines, missing lines at the end of the buffer are empty.
+    // Returns false at the end of the buffer.
+    bool Next(TleLines &lines);
+};
+
+// Integer in the columns [begin, end] of a line, with the spaces removed
+// it is the same as atol() of the field
+long ParseLong(const char *line, size_t begin, size_t end);
+
+// Decimal number in the columns [begin, end] of a line, with the spaces
+// removed it is the same as atof() of the field
+double ParseDouble(const char *line, size_t begin, size_t end);
+
+// 10 to the power of exponent, the same as pow(10.0, exponent)
+double Pow10(int exponent);
+
+// True if the lines look like a valid element set: the modulo 10 checksum
+// of both lines, the characters of the fixed columns and the same catalog
+// number in both. Runs on SIMD vectors where Simd.h has them.
+bool KepCheck(const StringView &line1, const StringView &line2);
+// Same one character at a time
+bool KepCheckScalar(const StringView &line1, const StringView &line2);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+
+/*
+ * Lock-free hand-off of complete values from one writer thread to one
+ * reader thread. The writer fills Back() and publishes it, the reader
+ * gets the latest published value from Acquire(). The third buffer
+ * keeps the last published value, so neither side ever waits for the
+ * other and the reader never sees a partially written value.
+ */
+template<class T>
+class TripleBuffer {
+    // Set in ready_ while the reader has not taken the published buffer
+    static const unsigned FRESH = 4;
+
+    T buffer_[3];
+    // Last published buffer
+    std::atomic<unsigned> ready_;
+    // Owned by the reader and the writer respectively
+    unsigned front_;
+    unsigned back_;
+public:
+    TripleBuffer() :
+            ready_(1),
+            front_(0),
+            back_(2) {
+    }
+
+    // Writer side: buffer to fill, may hold an older value
+    T& Back() {
+        return buffer_[back_];
+    }
+
+    // Writer side: makes Back() the latest value and takes a free buffer
+    void Publish() {
+        back_ = ready_.exchange(back_ | FRESH, std::memory_order_acq_rel)
+                & ~FRESH;
+    }
+
+    // Reader side: swaps in the latest published value if there is one
+    const T& Acquire() {
+        if (ready_.load(std::memory_order_relaxed) & FRESH) {
+            front_ = ready_.exchange(front_, std::memory_order_acq_rel)
+                    & ~FRESH;
+        }
+        return buffer_[front_];
+    }
+
+    // Reader side: value returned by the last Acquire()
+    const T& Front() const {
+        return buffer_[front_];
+    }
+};
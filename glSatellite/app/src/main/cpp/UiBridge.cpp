@@ -0,0 +1,100 @@
+#include "UiBridge.h"
+
+using namespace std;
+
+void UiUpdate::Merge(UiUpdate&& newer) {
+    show_ui = show_ui || newer.show_ui;
+    if (newer.has_fps) {
+        has_fps = true;
+        fps = newer.fps;
+    }
+    if (newer.has_label) {
+        has_label = true;
+        label = move(newer.label);
+    }
+    if (newer.has_beam) {
+        has_beam = true;
+        beam_name = move(newer.beam_name);
+        beam_catnum = newer.beam_catnum;
+        beam_latitude = newer.beam_latitude;
+        beam_longitude = newer.beam_longitude;
+        beam_altitude = newer.beam_altitude;
+    }
+}
+
+UiBridge::UiBridge(unique_ptr<IUiBackend> backend) :
+        backend_(move(backend)) {
+    thread_ = thread(&UiBridge::Run, this);
+}
+
+UiBridge::~UiBridge() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void UiBridge::ShowBeam(const string& name, int catnum, float latitude,
+    float longitude, float altitude) {
+    frame_.has_beam = true;
+    frame_.beam_name = name;
+    frame_.beam_catnum = catnum;
+    frame_.beam_latitude = latitude;
+    frame_.beam_longitude = longitude;
+    frame_.beam_altitude = altitude;
+}
+
+void UiBridge::Flush() {
+    if (frame_.empty()) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        pending_.Merge(move(frame_));
+    }
+    frame_ = UiUpdate();
+    cv_.notify_one();
+}
+
+void UiBridge::Run() {
+    bool attached = backend_->Attach();
+    unique_lock<mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] {
+            return stop_ || !pending_.empty();
+        });
+        UiUpdate update = move(pending_);
+        pending_ = UiUpdate();
+        bool stop = stop_;
+        lock.unlock();
+
+        if (attached && !update.empty()) {
+            Apply(update);
+        }
+        if (stop) {
+            break;
+        }
+        lock.lock();
+    }
+    backend_->Detach();
+}
+
+void UiBridge::Apply(const UiUpdate& update) {
+    // A label is applied after the FPS, which would replace it
+    if (update.show_ui) {
+        backend_->ShowUI();
+    }
+    if (update.has_fps) {
+        backend_->UpdateFPS(update.fps);
+    }
+    if (update.has_label) {
+        backend_->UpdateLabel(update.label.c_str());
+    }
+    if (update.has_beam) {
+        backend_->ShowBeam(update.beam_name.c_str(), update.beam_catnum,
+            update.beam_latitude, update.beam_longitude,
+            update.beam_altitude);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*
+ * Java side of the UI. Called only on the bridge thread of UiBridge, so
+ * an implementation may keep per-thread state like a JNIEnv.
+ */
+class IUiBackend {
+public:
+    virtual ~IUiBackend() {
+    }
+
+    // First call on the bridge thread, e.g. attaches it to the VM and
+    // resolves the methods. False if the UI cannot be reached, only
+    // Detach() follows then.
+    virtual bool Attach() = 0;
+    // Last call on the bridge thread, also after a failed Attach(), which
+    // may have attached the thread before it failed
+    virtual void Detach() = 0;
+
+    virtual void ShowUI() = 0;
+    virtual void UpdateFPS(float fps) = 0;
+    virtual void UpdateLabel(const char *label) = 0;
+    virtual void ShowBeam(const char *name, int catnum, float latitude,
+        float longitude, float altitude) = 0;
+};
+
+// Changes of the UI since the last hand-off, newer values replace older
+struct UiUpdate {
+    bool show_ui = false;
+    bool has_fps = false;
+    float fps = 0;
+    bool has_label = false;
+    std::string label;
+    bool has_beam = false;
+    std::string beam_name;
+    int beam_catnum = 0;
+    float beam_latitude = 0, beam_longitude = 0, beam_altitude = 0;
+
+    bool empty() const {
+        return !show_ui && !has_fps && !has_label && !has_beam;
+    }
+
+    // Takes the changes of the newer update
+    void Merge(UiUpdate&& newer);
+};
+
+/*
+ * Updates of the UI from the render thread. They are collected during a
+ * frame and handed to a bridge thread by Flush(), once per frame, which
+ * makes the backend calls. The bridge thread stays attached to the VM
+ * while the bridge lives, and updates not applied yet are merged, so a
+ * slow UI only sees the latest state.
+ */
+class UiBridge {
+    std::unique_ptr<IUiBackend> backend_;
+    // Changes of the current frame, render thread only
+    UiUpdate frame_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // Handed over and not yet applied, guarded by mutex_
+    UiUpdate pending_;
+    bool stop_ = false;
+
+    void Run();
+    void Apply(const UiUpdate& update);
+public:
+    // Starts the bridge thread
+    explicit UiBridge(std::unique_ptr<IUiBackend> backend);
+    // Applies the updates handed over, and stops the bridge thread
+    ~UiBridge();
+
+    UiBridge(const UiBridge&) = delete;
+    UiBridge& operator=(const UiBridge&) = delete;
+
+    void ShowUI() {
+        frame_.show_ui = true;
+    }
+
+    void UpdateFPS(float fps) {
+        frame_.has_fps = true;
+        frame_.fps = fps;
+    }
+
+    void UpdateLabel(const std::string& label) {
+        frame_.has_label = true;
+        frame_.label = label;
+    }
+
+    void ShowBeam(const std::string& name, int catnum, float latitude,
+        float longitude, float altitude);
+
+    // Hands the changes of the frame to the bridge thread, if any
+    void Flush();
+};
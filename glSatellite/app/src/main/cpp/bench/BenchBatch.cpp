@@ -0,0 +1,146 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SatelliteBatch.h"
+#include "SatelliteConst.h"
+#include "Simd.h"
+
+using namespace std;
+
+/*
+ * Propagates near-earth satellites of both regimes with SGP4Batch and
+ * every lane again with NearEarthPropagator::Propagate<REGIME>. The
+ * batches have a partly filled last vector, and are also propagated in
+ * two ranges. Returns non-zero if a lane differs from the scalar path by
+ * more than the bounds SatelliteBatch.h promises.
+ */
+
+// Earth radii, and earth radii per minute
+const double MAX_POS_ERROR = 1E-9;
+const double MAX_VEL_ERROR = 1E-11;
+
+// Minutes from epoch, both sides
+static const double TIMES[] = {-1440, -97.3, 0, 0.5, 61, 720, 1440};
+
+// Gravitational parameter of the earth in km^3/s^2
+const double GM = 398600.8;
+
+/*
+ * Orbits with perigees from 150 to 600 km, those below 220 km use the
+ * NEAR_EARTH_SIMPLE kernel. The checksums are not checked.
+ */
+static vector<SatelliteCalc> MakeSatellites(size_t number) {
+    mt19937 gen(2);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    vector<SatelliteCalc> calc;
+    for (size_t i = 0; i < number; ++i) {
+        double perigee = 150 + 450 * unit(gen);
+        double eccn = 0.05 * unit(gen) * unit(gen);
+        double a = (XKMPER + perigee) / (1 - eccn);
+        double meanmo = sqrt(GM / (a * a * a)) * SECDAY / TWOPI;
+        char line1[128], line2[128];
+        snprintf(line1, sizeof(line1),
+            "1 %05dU 24001A   24001.50000000  .00000100  00000-0  %05d-%d 0  "
+            "9990", (int)i, 10000 + (int)(89999 * unit(gen)),
+            3 + (int)(3 * unit(gen)));
+        snprintf(line2, sizeof(line2),
+            "2 %05d %8.4f %8.4f %07d %8.4f %8.4f %11.8f%5d0", (int)i,
+            180 * unit(gen), 360 * unit(gen), (int)(eccn * 1E7),
+            360 * unit(gen), 360 * unit(gen), meanmo, 1000);
+        calc.emplace_back(Satellite(to_string(i), string(line1),
+            string(line2)));
+    }
+    return calc;
+}
+
+static double Distance(const vector_t &a, const vector_t &b) {
+    double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/*
+ * Largest differences of the batch's lanes from the scalar propagators
+ * at the time of the context, NAN lanes count as infinite.
+ */
+template<REGIMES REGIME>
+static void Compare(const SGP4Batch &batch,
+    const vector<NearEarthPropagator> &scalar,
+    const vector<SatelliteCalc> &calc, const PropagationContext &context,
+    double &pos_error, double &vel_error) {
+    for (size_t num = 0; num < batch.GetNumber(); ++num) {
+        size_t i = batch.GetIndex(num);
+        vector_t pos, vel, batch_pos, batch_vel;
+        scalar[i].Propagate<REGIME>(calc[i].TimeSinceEpoch(context), pos,
+            vel);
+        batch.GetState(num, batch_pos, batch_vel);
+        double dp = Distance(pos, batch_pos);
+        double dv = Distance(vel, batch_vel);
+        pos_error = max(pos_error, std::isnan(dp) ? INFINITY : dp);
+        vel_error = max(vel_error, std::isnan(dv) ? INFINITY : dv);
+    }
+}
+
+static bool Check(SGP4Batch &batch, const vector<NearEarthPropagator> &scalar,
+    const vector<SatelliteCalc> &calc, double epoch) {
+    double pos_error = 0, vel_error = 0;
+    size_t split = vdouble::WIDTH;
+    for (double tsince : TIMES) {
+        PropagationContext context(epoch + tsince / MINDAY);
+        for (int ranges = 1; ranges <= 2; ++ranges) {
+            if (ranges == 1) {
+                batch.Propagate(context);
+            } else {
+                // Separate ranges, like the thread pool runs them
+                batch.Propagate(context, 0, split);
+                batch.Propagate(context, split, batch.GetNumber());
+            }
+            if (batch.GetRegime() == NEAR_EARTH_SIMPLE) {
+                Compare<NEAR_EARTH_SIMPLE>(batch, scalar, calc, context,
+                    pos_error, vel_error);
+            } else {
+                Compare<NEAR_EARTH>(batch, scalar, calc, context, pos_error,
+                    vel_error);
+            }
+        }
+    }
+    size_t lanes = batch.GetNumber() % vdouble::WIDTH;
+    bool ok = pos_error <= MAX_POS_ERROR && vel_error <= MAX_VEL_ERROR;
+    printf("%-18s %5zu satellites, %zu in the last vector: position %.2e ER,"
+        " velocity %.2e ER/min  %s\n", batch.GetRegime() == NEAR_EARTH_SIMPLE
+            ? "NEAR_EARTH_SIMPLE" : "NEAR_EARTH", batch.GetNumber(),
+        lanes ? lanes : vdouble::WIDTH, pos_error, vel_error,
+        ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+    vector<SatelliteCalc> calc = MakeSatellites(number);
+    vector<NearEarthPropagator> scalar;
+    SGP4Batch batch[] = {SGP4Batch(NEAR_EARTH), SGP4Batch(NEAR_EARTH_SIMPLE)};
+    for (size_t i = 0; i < calc.size(); ++i) {
+        scalar.emplace_back(calc[i].GetElements());
+        batch[calc[i].GetRegime()].Add(i, calc[i]);
+    }
+    // A partly filled last vector in both batches
+    for (SGP4Batch &regime : batch) {
+        if (vdouble::WIDTH > 1 && regime.GetNumber() % vdouble::WIDTH == 0) {
+            regime.Remove(0);
+        }
+    }
+    // Daynum of the epoch of the TLEs
+    double epoch = -calc[0].TimeSinceEpoch(PropagationContext(0)) / MINDAY;
+
+    bool ok = true;
+    for (SGP4Batch &regime : batch) {
+        ok = regime.GetNumber() > vdouble::WIDTH
+                && regime.GetNumber() % vdouble::WIDTH != 0
+                && Check(regime, scalar, calc, epoch) && ok;
+    }
+    printf("%zu lanes per vector\n", vdouble::WIDTH);
+    return ok ? 0 : 1;
+}
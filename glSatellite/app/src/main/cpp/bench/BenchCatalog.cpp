@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "Catalog.h"
+#include "SatelliteConst.h"
+#include "SatelliteMgr.h"
+
+using namespace std;
+
+/*
+ * Round trip of the binary catalog file: the catalog loaded from the
+ * file must have the same satellites and propagate to bitwise the same
+ * positions as the catalog parsed from the text, also after the saved
+ * catalog was propagated. Damaged and truncated files must be rejected.
+ * Returns non-zero on any difference.
+ */
+
+// Times of the comparison in days from now, with jumps in both
+// directions for the resonance integrator
+static const double DAYS[] = {0, 3.5, -20, 0.01, 45, -1};
+
+static const char *PATH = "bench_catalog.cat";
+static const char *DAMAGED_PATH = "bench_catalog_damaged.cat";
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+static string ReadFile(const char *path) {
+    ifstream input(path, ios::binary);
+    stringstream data;
+    data << input.rdbuf();
+    return data.str();
+}
+
+static void WriteFile(const char *path, const string &data) {
+    ofstream output(path, ios::binary);
+    output << data;
+}
+
+/* Same satellites and positions at all the times. */
+static bool Compare(SatelliteMgr &a, SatelliteMgr &b) {
+    if (a.GetNumber() != b.GetNumber()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.GetNumber(); ++i) {
+        if (a.GetSatellite(i).GetCatNum() != b.GetSatellite(i).GetCatNum()
+                || a.GetSatellite(i).GetName()
+                        != b.GetSatellite(i).GetName()) {
+            return false;
+        }
+    }
+    double daynum = CurrentDaynum();
+    for (double days : DAYS) {
+        PropagationContext context(daynum + days);
+        a.UpdateAll(context);
+        b.UpdateAll(context);
+        const PositionSnapshot &sa = a.AcquireSnapshot();
+        const PositionSnapshot &sb = b.AcquireSnapshot();
+        if (memcmp(sa.position.data(), sb.position.data(),
+            sa.position.size() * sizeof(SatellitePosition)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 25000;
+    string text = MakeCatalog(number);
+
+    SatelliteMgr parsed, loaded;
+    parsed.SetMaxError(0);
+    loaded.SetMaxError(0);
+    double parse_time = Time([&] {
+        parsed.Init(text.data(), text.size());
+    });
+
+    // The saved propagators already ran, Load() starts them afresh
+    parsed.UpdateAll(PropagationContext(CurrentDaynum() + 10));
+    bool saved = parsed.Save(PATH);
+    bool ok = false;
+    double load_time = Time([&] {
+        ok = saved && loaded.Load(PATH);
+    });
+    ok = ok && Compare(parsed, loaded);
+    printf("%zu satellites, %.1f MB file\n", loaded.GetNumber(),
+        ReadFile(PATH).size() * 1E-6);
+    printf("text Init  %8.3f ms\n", parse_time);
+    printf("file Load  %8.3f ms  %5.2fx\n", load_time, parse_time / load_time);
+    printf("round trip %s\n", ok ? "ok" : "FAILED");
+
+    // One changed byte and a missing end, the loaded catalog is kept
+    string data = ReadFile(PATH);
+    string damaged = data;
+    damaged[damaged.size() / 2] ^= 0x10;
+    WriteFile(DAMAGED_PATH, damaged);
+    bool rejected = !loaded.Load(DAMAGED_PATH);
+    WriteFile(DAMAGED_PATH, data.substr(0, data.size() - 8));
+    rejected = rejected && !loaded.Load(DAMAGED_PATH)
+            && !loaded.Load("missing.cat")
+            && loaded.GetNumber() == parsed.GetNumber();
+    printf("damaged files %s\n", rejected ? "rejected" : "LOADED");
+
+    remove(PATH);
+    remove(DAMAGED_PATH);
+    return ok && rejected ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Satellite.h"
+#include "SatelliteConst.h"
+#include "SimulationClock.h"
+
+using namespace std;
+
+/*
+ * Drives SimulationClock like the render loop and the controls do: the
+ * rate must be clamped to MAX_RATE in both directions, the time must
+ * advance by the rate times the monotonic time between two Tick() calls,
+ * stand still while paused and continue without a gap after Resume(),
+ * JumpTo() must keep the rate and the pause state, and Reset() must go
+ * back to the wall clock. Returns non-zero on any difference.
+ */
+
+typedef chrono::steady_clock Clock;
+
+// Rounding of a daynum near the present in s, with a margin
+const double EPSILON = 1E-5;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+    return chrono::duration<double>(to - from).count();
+}
+
+static void Sleep(int ms) {
+    this_thread::sleep_for(chrono::milliseconds(ms));
+}
+
+/*
+ * Ticks twice with a pause in between, true if the simulated time went
+ * by rate times the monotonic time between the ticks.
+ */
+static bool Advances(SimulationClock &clock, double rate) {
+    Clock::time_point before_first = Clock::now();
+    clock.Tick();
+    Clock::time_point after_first = Clock::now();
+    double first = clock.Now();
+    Sleep(20);
+    Clock::time_point before_second = Clock::now();
+    clock.Tick();
+    Clock::time_point after_second = Clock::now();
+    // Simulated seconds per monotonic second
+    double elapsed = (clock.Now() - first) * SECDAY / rate;
+    return elapsed >= Seconds(after_first, before_second) - EPSILON
+            && elapsed <= Seconds(before_first, after_second) + EPSILON;
+}
+
+static bool CheckRate() {
+    SimulationClock clock;
+    bool ok = clock.GetRate() == 1 && !clock.IsPaused()
+            && Advances(clock, 1);
+    clock.SetRate(2 * SimulationClock::MAX_RATE);
+    ok = ok && clock.GetRate() == SimulationClock::MAX_RATE
+            && Advances(clock, SimulationClock::MAX_RATE);
+    clock.SetRate(-1E9);
+    ok = ok && clock.GetRate() == -SimulationClock::MAX_RATE
+            && Advances(clock, -SimulationClock::MAX_RATE);
+    clock.SetRate(-60);
+    ok = ok && clock.GetRate() == -60 && Advances(clock, -60);
+    printf("rate %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool CheckPause() {
+    const double rate = 1000;
+    SimulationClock clock;
+    clock.SetRate(rate);
+    clock.Tick();
+    double running = clock.Now();
+    clock.Pause();
+    clock.Tick();
+    double paused = clock.Now();
+    Sleep(50);
+    clock.Tick();
+    bool ok = clock.IsPaused() && clock.Now() == paused && paused >= running
+            && clock.GetRate() == rate;
+
+    // The pause is not made up for, the time goes on from where it stood
+    Clock::time_point resume = Clock::now();
+    clock.Resume();
+    clock.Tick();
+    double resumed = clock.Now();
+    double gap = (resumed - paused) * SECDAY / rate;
+    ok = ok && !clock.IsPaused() && gap >= 0
+            && gap <= Seconds(resume, Clock::now()) + EPSILON
+            && Advances(clock, rate);
+    printf("pause and resume %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool CheckJump() {
+    // 1 Jan 2000 12:00 UTC
+    const double target = 7305.5;
+    SimulationClock clock;
+    clock.SetRate(-5);
+    clock.Pause();
+    clock.JumpTo(target);
+    // Visible before the next Tick()
+    bool ok = clock.Now() == target;
+    Sleep(10);
+    clock.Tick();
+    ok = ok && clock.Now() == target && clock.IsPaused()
+            && clock.GetRate() == -5;
+    clock.Resume();
+    ok = ok && Advances(clock, -5) && clock.Now() < target;
+
+    clock.SetRate(100);
+    clock.JumpTo(target + 1);
+    ok = ok && clock.Now() == target + 1 && !clock.IsPaused()
+            && clock.GetRate() == 100 && Advances(clock, 100);
+    printf("jump %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool CheckReset() {
+    SimulationClock clock;
+    clock.SetRate(-300);
+    clock.JumpTo(0);
+    clock.Pause();
+    double before = CurrentDaynum();
+    clock.Reset();
+    double after = CurrentDaynum();
+    // Visible before the next Tick()
+    bool ok = clock.Now() >= before && clock.Now() <= after
+            && clock.GetRate() == 1 && !clock.IsPaused() && Advances(clock, 1);
+    printf("reset %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main() {
+    bool ok = CheckRate();
+    ok = CheckPause() && ok;
+    ok = CheckJump() && ok;
+    ok = CheckReset() && ok;
+    return ok ? 0 : 1;
+}
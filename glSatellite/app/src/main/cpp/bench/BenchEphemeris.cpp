@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "Catalog.h"
+#include "Ephemeris.h"
+#include "SatelliteConst.h"
+
+using namespace std;
+
+/*
+ * Checks the position error of EphemerisCache against direct propagation
+ * for frame-like time steps and random jumps, and compares their speed.
+ * Returns non-zero if the error exceeds the configured maximum. Errors
+ * below the jitter of SGP4/SDP4 itself (E6A * r, ~7 m for LEO) cannot
+ * be measured, so that part is not counted.
+ */
+
+static double Distance(const vector_t &a, const vector_t &b) {
+    return XKMPER * sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y)
+            + (a.z - b.z) * (a.z - b.z));
+}
+
+/* Largest position error in km over the time sequence. */
+static double MaxError(vector<SatelliteCalc> &calc, double max_error,
+    const vector<double> &times, double &worst_step) {
+    EphemerisCache cache(max_error);
+    cache.Init(calc);
+    vector<SatelliteCalc> direct = calc;
+
+    double worst = 0;
+    worst_step = 0;
+    for (double tsince : times) {
+        for (size_t i = 0; i < calc.size(); ++i) {
+            vector_t pos, vel, ref_pos, ref_vel;
+            cache.Get(i, calc[i], tsince, pos, vel);
+            direct[i].Propagate(tsince, ref_pos, ref_vel);
+            ref_pos.Magnitude();
+            // Kepler's equation is solved only to E6A, so the reference
+            // positions themselves jitter by up to E6A * r
+            double error = Distance(pos, ref_pos) - 2 * E6A * XKMPER * ref_pos.w;
+            if (error > worst) {
+                worst = error;
+                worst_step = cache.GetStep(i);
+            }
+        }
+    }
+    return worst;
+}
+
+/* Propagations or cache evaluations per second. */
+static double Rate(vector<SatelliteCalc> &calc, EphemerisCache *cache,
+    const vector<double> &times) {
+    auto start = chrono::steady_clock::now();
+    double sum = 0;
+    for (double tsince : times) {
+        for (size_t i = 0; i < calc.size(); ++i) {
+            vector_t pos, vel;
+            if (cache) {
+                cache->Get(i, calc[i], tsince, pos, vel);
+            } else {
+                calc[i].Propagate(tsince, pos, vel);
+            }
+            sum += pos.x;
+        }
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    // Keep the results alive
+    if (sum == 0.5) {
+        printf(" ");
+    }
+    return times.size() * calc.size() / elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000;
+
+    vector<SatelliteCalc> calc;
+    StringReader reader(MakeCatalog(number));
+    while (!reader.eof()) {
+        string name = reader.getline();
+        string line1 = reader.getline();
+        string line2 = reader.getline();
+        if (!reader.eof()) {
+            calc.emplace_back(Satellite(name, line1, line2));
+        }
+    }
+
+    // Frames at 60 Hz with the clock at 100x, then random jumps
+    // within three days around epoch
+    vector<double> times;
+    mt19937 gen(1);
+    uniform_real_distribution<double> jump(-3 * MINDAY, 3 * MINDAY);
+    for (double t = 0; t < 60; t += 100.0 / 60 / 60) {
+        times.push_back(t);
+    }
+    for (int i = 0; i < 200; ++i) {
+        times.push_back(jump(gen));
+    }
+
+    int result = 0;
+    const double errors[] = {0.01, 0.1, 1};
+    for (double max_error : errors) {
+        double step;
+        double error = MaxError(calc, max_error, times, step);
+        bool ok = error <= max_error;
+        printf("max error %6.3f km: measured %.6f km (step %.2f min) %s\n",
+            max_error, error, step, ok ? "ok" : "FAILED");
+        if (!ok) {
+            result = 1;
+        }
+    }
+
+    vector<double> frames(times.begin(), times.begin() + 2000);
+    EphemerisCache cache;
+    cache.Init(calc);
+    double direct = Rate(calc, nullptr, frames);
+    double cached = Rate(calc, &cache, frames);
+    printf("direct %.3g/s, cached %.3g/s, %.1fx\n", direct, cached,
+        cached / direct);
+    return result;
+}
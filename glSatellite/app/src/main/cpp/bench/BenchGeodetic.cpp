@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Geodetic.h"
+#include "SatelliteConst.h"
+
+using namespace std;
+
+/*
+ * Checks the closed-form geodetic conversion against the iterative method
+ * it replaced in SatelliteCalc.cpp, for points from the surface to beyond
+ * GEO, and compares their speed. Returns non-zero if they differ by more
+ * than MAX_ERROR.
+ */
+
+// Sub-millimetre agreement in km
+const double MAX_ERROR = 1E-7;
+
+/* The former CalculateLatLonAlt loop, latitude in [-Pi/2, Pi/2]. */
+static void Reference(double x, double y, double z, double &lat,
+    double &alt) {
+    double r = sqrt(x * x + y * y);
+    double e2 = FF * (2 - FF);
+    double phi, c;
+    lat = atan2(z, r);
+    do {
+        phi = lat;
+        c = 1 / sqrt(1 - e2 * sin(phi) * sin(phi));
+        lat = atan2(z + XKMPER * c * e2 * sin(phi), r);
+    } while (fabs(lat - phi) >= 1E-10);
+    alt = r / cos(lat) - XKMPER * c;
+}
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+    // Random directions, altitudes from 0 to 50000 km
+    mt19937 gen(1);
+    normal_distribution<double> dir;
+    uniform_real_distribution<double> height(0, 50000);
+    vector<double> x(number), y(number), z(number);
+    for (size_t i = 0; i < number; ++i) {
+        double dx = dir(gen), dy = dir(gen), dz = dir(gen);
+        double r = (XKMPER + height(gen)) / sqrt(dx * dx + dy * dy + dz * dz);
+        x[i] = r * dx;
+        y[i] = r * dy;
+        z[i] = r * dz;
+    }
+
+    vector<double> ref_lat(number), ref_alt(number);
+    vector<double> lat(number), alt(number);
+    vector<double> batch_lat(number), batch_alt(number);
+
+    double ref_time = Time([&] {
+        for (size_t i = 0; i < number; ++i) {
+            Reference(x[i], y[i], z[i], ref_lat[i], ref_alt[i]);
+        }
+    });
+    double time = Time([&] {
+        for (size_t i = 0; i < number; ++i) {
+            GeodeticLatAlt(x[i], y[i], z[i], lat[i], alt[i]);
+        }
+    });
+    double batch_time = Time([&] {
+        GeodeticLatAlt(number, x.data(), y.data(), z.data(), batch_lat.data(),
+            batch_alt.data());
+    });
+
+    // Latitude errors as distances along the meridian
+    double error = 0, batch_error = 0;
+    for (size_t i = 0; i < number; ++i) {
+        double r = XKMPER + ref_alt[i];
+        error = max(error, fabs(lat[i] - ref_lat[i]) * r);
+        error = max(error, fabs(alt[i] - ref_alt[i]));
+        batch_error = max(batch_error, fabs(batch_lat[i] - ref_lat[i]) * r);
+        batch_error = max(batch_error, fabs(batch_alt[i] - ref_alt[i]));
+    }
+
+    printf("%zu points\n", number);
+    printf("iterative %9.3f ms\n", ref_time);
+    printf("scalar    %9.3f ms  %5.2fx  max error %.3g mm\n", time,
+        ref_time / time, error * 1E6);
+    printf("batch     %9.3f ms  %5.2fx  max error %.3g mm\n", batch_time,
+        ref_time / batch_time, batch_error * 1E6);
+
+    bool ok = error <= MAX_ERROR && batch_error <= MAX_ERROR;
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
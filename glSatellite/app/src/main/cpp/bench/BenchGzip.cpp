@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+#include "Catalog.h"
+#include "SatelliteMgr.h"
+#include "TextBlocks.h"
+#include "ThreadPool.h"
+#include "TleParser.h"
+
+using namespace std;
+
+/*
+ * Loads gzip compressed TLE text: the blocks of TextBlocks must put
+ * together the text, each of whole element sets, also for files of
+ * several members, and damaged files must be reported. Init(), Stream()
+ * and Refresh() of the compressed text must load bitwise the same
+ * catalog as of the plain text. Returns non-zero on any difference, and
+ * compares the time of the loads.
+ */
+
+const size_t THREADS = 4;
+
+// Block sizes down to less than one line
+static const size_t BLOCK_SIZES[] = {1, 100, 4096, 65536,
+    TextBlocks::DEFAULT_BLOCK_SIZE};
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+/* The text as one gzip member. */
+static string Gzip(const string &text, int level = Z_DEFAULT_COMPRESSION) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, level, Z_DEFLATED, 16 + MAX_WBITS, 8,
+        Z_DEFAULT_STRATEGY);
+    string data(deflateBound(&stream, text.size()), '\0');
+    stream.next_in = (Bytef*)text.data();
+    stream.avail_in = text.size();
+    stream.next_out = (Bytef*)&data[0];
+    stream.avail_out = data.size();
+    deflate(&stream, Z_FINISH);
+    data.resize(stream.total_out);
+    deflateEnd(&stream);
+    return data;
+}
+
+/*
+ * Blocks of the data put together, empty if a block does not end after
+ * whole element sets. Sets error if TextBlocks reported one.
+ */
+static string Inflate(const string &data, size_t block_size, bool &error) {
+    TextBlocks blocks(StringView(data), TLE_SET_LINES, block_size);
+    string text;
+    StringView block;
+    size_t lines = 0;
+    bool grid = true;
+    bool last = false;
+    while (blocks.Next(block)) {
+        // Only the last block may end off the grid
+        grid = grid && !last;
+        lines += count(block.data, block.data + block.size, '\n');
+        last = lines % TLE_SET_LINES != 0;
+        text.append(block.data, block.size);
+    }
+    error = blocks.error();
+    return grid ? text : string();
+}
+
+/* Same satellites and positions at the time of the context. */
+static bool SameCatalog(SatelliteMgr &a, SatelliteMgr &b,
+    const PropagationContext &context) {
+    if (a.GetNumber() != b.GetNumber()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.GetNumber(); ++i) {
+        if (a.GetSatellite(i).GetCatNum() != b.GetSatellite(i).GetCatNum()
+                || a.GetSatellite(i).GetName()
+                        != b.GetSatellite(i).GetName()) {
+            return false;
+        }
+    }
+    a.UpdateAll(context);
+    b.UpdateAll(context);
+    const PositionSnapshot &sa = a.AcquireSnapshot();
+    const PositionSnapshot &sb = b.AcquireSnapshot();
+    return memcmp(sa.position.data(), sb.position.data(),
+        sa.position.size() * sizeof(SatellitePosition)) == 0;
+}
+
+/* Blocks of single and concatenated members, and damaged data. */
+static bool CheckBlocks(const string &text, const string &data) {
+    bool ok = TextBlocks::GetSize(StringView(data)) == text.size();
+    bool error;
+    for (size_t block_size : BLOCK_SIZES) {
+        ok = ok && Inflate(data, block_size, error) == text && !error;
+    }
+    // Members split off the grid, the blocks are not
+    size_t half = text.size() / 2;
+    string members = Gzip(text.substr(0, half)) + Gzip(text.substr(half));
+    ok = ok && Inflate(members, 4096, error) == text && !error
+            && TextBlocks::GetSize(StringView(members)) == text.size();
+    string plain = Inflate(text, 4096, error);
+    ok = ok && plain == text && !error;
+    printf("blocks %s\n", ok ? "ok" : "FAILED");
+
+    // The blocks before the damage are still returned
+    bool damaged = true;
+    Inflate(data.substr(0, data.size() - 10), 4096, error);
+    damaged = damaged && error;
+    string changed = data;
+    changed[changed.size() / 2] ^= 0x55;
+    Inflate(changed, 4096, error);
+    damaged = damaged && error;
+    Inflate("\x28\xB5\x2F\xFD" + data, 4096, error);
+    damaged = damaged && error;
+    printf("damaged data %s\n", damaged ? "reported" : "NOT REPORTED");
+    return ok && damaged;
+}
+
+/* Offset of the set after the first number of sets of the text. */
+static size_t SetOffset(const string &text, size_t number) {
+    size_t pos = 0;
+    for (size_t lines = 0; lines < number * TLE_SET_LINES; ++lines) {
+        pos = text.find('\n', pos);
+        if (pos == string::npos) {
+            return text.size();
+        }
+        ++pos;
+    }
+    return pos;
+}
+
+/* Stream() of the data loads bitwise the same catalog as Init(). */
+static bool Streams(SatelliteMgr &expected, const string &data,
+    const PropagationContext &context, double &time) {
+    SatelliteMgr streamed;
+    streamed.SetMaxError(0);
+    time = Time([&] {
+        streamed.Stream(unique_ptr<IFileReader>(new StringReader(data)));
+        while (streamed.IsLoading()) {
+            streamed.UpdateAll(context);
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+    return SameCatalog(expected, streamed, context);
+}
+
+/* Init(), Stream() and Refresh() of the plain and the compressed text. */
+static bool CheckCatalog(size_t number, const string &text,
+    const string &data) {
+    ThreadPool pool(THREADS);
+    SatelliteMgr plain, compressed;
+    plain.SetThreadPool(&pool);
+    compressed.SetThreadPool(&pool);
+    plain.SetMaxError(0);
+    compressed.SetMaxError(0);
+    PropagationContext context(CurrentDaynum());
+
+    double plain_time = 1E300, compressed_time = 1E300, inflate_time = 1E300;
+    for (int run = 0; run < 3; ++run) {
+        plain_time = min(plain_time, Time([&] {
+            plain.Init(text.data(), text.size());
+        }));
+        compressed_time = min(compressed_time, Time([&] {
+            compressed.Init(data.data(), data.size());
+        }));
+        inflate_time = min(inflate_time, Time([&] {
+            TextBlocks blocks(StringView(data), TLE_SET_LINES);
+            StringView block;
+            while (blocks.Next(block)) {
+            }
+        }));
+    }
+    bool init = SameCatalog(plain, compressed, context);
+    printf("%zu TLEs, %.2f MB text, %.2f MB gzip\n", plain.GetNumber(),
+        text.size() * 1E-6, data.size() * 1E-6);
+    printf("Init text  %8.3f ms\n", plain_time);
+    printf("Init gzip  %8.3f ms, of it inflate %.3f ms  %s\n",
+        compressed_time, inflate_time, init ? "ok" : "FAILED");
+
+    double stream_time;
+    bool stream = Streams(plain, data, context, stream_time);
+    printf("Stream gzip %7.3f ms  %s\n", stream_time,
+        stream ? "ok" : "FAILED");
+
+    // A short last member, its trailer holds the size of only that one
+    size_t split = SetOffset(text, number > 10 ? number - 10 : 0);
+    string members = Gzip(text.substr(0, split)) + Gzip(text.substr(split));
+    double members_time;
+    bool stream_members = Streams(plain, members, context, members_time);
+    printf("Stream gzip members %7.3f ms  %s\n", members_time,
+        stream_members ? "ok" : "FAILED");
+    stream = stream && stream_members;
+
+    // Other elements of the same catalog numbers
+    string update = MakeCatalog(number, 2);
+    string update_data = Gzip(update);
+    vector<size_t> changed;
+    plain.Init(update.data(), update.size());
+    compressed.Refresh(update_data.data(), update_data.size(), changed);
+    bool refresh = SameCatalog(plain, compressed, context);
+    printf("Refresh gzip  %s\n", refresh ? "ok" : "FAILED");
+    return init && stream && refresh;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 25000;
+    string text = MakeCatalog(number);
+    string data = Gzip(text);
+    bool ok = CheckBlocks(text, data) && CheckCatalog(number, text, data);
+    return ok ? 0 : 1;
+}
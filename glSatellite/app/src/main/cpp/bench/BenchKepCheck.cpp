@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Catalog.h"
+#include "Satellite.h"
+#include "TleParser.h"
+
+using namespace std;
+
+/*
+ * Checks KepCheck() and KepCheckScalar() against the former per-column
+ * torture test of SatelliteMgr, with its checksum table filled in, on a
+ * corpus of valid lines and of lines with every column replaced by other
+ * characters. Returns non-zero on any difference, and compares the time
+ * of the validation with the time of parsing the element sets.
+ */
+
+// Replacements of every column of the corpus: another digit, and
+// characters of the other column types
+static const char REPLACEMENTS[] = {'-', ' ', '.', '+', 'A', 'U', '\xC3'};
+
+struct Case {
+    const char *line1, *line2;
+    bool valid;
+};
+
+// Element set of the International Space Station and damaged copies
+static const Case CASES[] = {
+    {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+     "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537",
+     true},
+    // Checksum off by one
+    {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2928",
+     "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537",
+     false},
+    // A minus sign counts one
+    {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+     "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.7212539156353-",
+     false},
+    // Other catalog number in line 2, with its checksum
+    {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+     "2 25545  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563538",
+     false},
+    // Lines swapped
+    {"2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537",
+     "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+     false},
+    // Short line
+    {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  292",
+     "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537",
+     false},
+    // Digits moved between columns keep the checksum
+    {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+     "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563573",
+     false},
+};
+
+static unsigned char val[256];
+
+static void InitVal() {
+    for (int c = '0'; c <= '9'; ++c) {
+        val[c] = c - '0';
+    }
+    val['-'] = 1;
+}
+
+/* The former check, indexed by unsigned characters. */
+static bool LegacyKepCheck(const StringView &line1, const StringView &line2) {
+    if (line1.size < TLE_LINE_LENGTH || line2.size < TLE_LINE_LENGTH) {
+        return false;
+    }
+    const unsigned char *l1 = (const unsigned char*)line1.data;
+    const unsigned char *l2 = (const unsigned char*)line2.data;
+    int x;
+    unsigned sum1, sum2;
+    for (x = 0, sum1 = 0, sum2 = 0; x <= 67; sum1 += val[l1[x]], sum2 +=
+        val[l2[x]], ++x)
+        ;
+    x = (val[l1[68]] ^ (sum1 % 10)) | (val[l2[68]] ^ (sum2 % 10))
+            | (l1[0] ^ '1') | (l1[1] ^ ' ') | (l1[7] ^ 'U') | (l1[8] ^ ' ')
+            | (l1[17] ^ ' ') | (l1[23] ^ '.') | (l1[32] ^ ' ')
+            | (l1[34] ^ '.') | (l1[43] ^ ' ') | (l1[52] ^ ' ')
+            | (l1[61] ^ ' ') | (l1[62] ^ '0') | (l1[63] ^ ' ')
+            | (l2[0] ^ '2') | (l2[1] ^ ' ') | (l2[7] ^ ' ') | (l2[11] ^ '.')
+            | (l2[16] ^ ' ') | (l2[20] ^ '.') | (l2[25] ^ ' ')
+            | (l2[33] ^ ' ') | (l2[37] ^ '.') | (l2[42] ^ ' ')
+            | (l2[46] ^ '.') | (l2[51] ^ ' ') | (l2[54] ^ '.')
+            | (l1[2] ^ l2[2]) | (l1[3] ^ l2[3]) | (l1[4] ^ l2[4])
+            | (l1[5] ^ l2[5]) | (l1[6] ^ l2[6]) | (isdigit(l1[68]) ? 0 : 1)
+            | (isdigit(l2[68]) ? 0 : 1) | (isdigit(l1[18]) ? 0 : 1)
+            | (isdigit(l1[19]) ? 0 : 1) | (isdigit(l2[31]) ? 0 : 1)
+            | (isdigit(l2[32]) ? 0 : 1);
+    return !x;
+}
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+/* All three checks agree, and with valid. Prints the lines if not. */
+static bool Check(const string &line1, const string &line2, bool valid) {
+    StringView view1(line1), view2(line2);
+    bool simd = KepCheck(view1, view2);
+    bool scalar = KepCheckScalar(view1, view2);
+    if (simd == valid && scalar == valid) {
+        return true;
+    }
+    printf("%s\n%s\nexpected %d, SIMD %d, scalar %d\n", line1.c_str(),
+        line2.c_str(), valid, simd, scalar);
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 25000;
+    size_t corpus_number = argc > 2 ? strtoul(argv[2], nullptr, 10) : 500;
+    InitVal();
+
+    size_t errors = 0;
+    for (const Case &c : CASES) {
+        string line1 = c.line1, line2 = c.line2;
+        errors += !Check(line1, line2, c.valid)
+                + !Check(line1, line2,
+                    LegacyKepCheck(StringView(line1), StringView(line2)));
+    }
+
+    // Every column of both lines replaced in turn
+    string corpus = MakeCatalog(corpus_number);
+    TleParser parser(corpus.data(), corpus.size());
+    TleLines lines;
+    size_t cases = 0;
+    while (parser.Next(lines) && errors < 10) {
+        string line[2] = {lines.line1.str(), lines.line2.str()};
+        errors += !Check(line[0], line[1], true);
+        ++cases;
+        for (size_t l = 0; l < 2; ++l) {
+            for (size_t i = 0; i < TLE_LINE_LENGTH; ++i) {
+                string damaged[2] = {line[0], line[1]};
+                char &c = damaged[l][i];
+                vector<char> replacements(begin(REPLACEMENTS),
+                    end(REPLACEMENTS));
+                replacements.push_back(isdigit((unsigned char)c) ?
+                    '0' + (c - '0' + 1) % 10 : '7');
+                for (char replacement : replacements) {
+                    if (replacement == line[l][i]) {
+                        continue;
+                    }
+                    c = replacement;
+                    errors += !Check(damaged[0], damaged[1],
+                        LegacyKepCheck(StringView(damaged[0]),
+                            StringView(damaged[1])));
+                    ++cases;
+                }
+            }
+        }
+    }
+    printf("%zu corpus cases, %zu errors %s\n", cases, errors,
+        errors ? "FAILED" : "ok");
+
+    // Validation against parsing of a large catalog, best of five
+    string text = MakeCatalog(number);
+    vector<TleLines> sets;
+    TleParser catalog(text.data(), text.size());
+    while (catalog.Next(lines)) {
+        sets.push_back(lines);
+    }
+    double simd_time = 1E300, scalar_time = 1E300, legacy_time = 1E300;
+    double parse_time = 1E300;
+    size_t valid = 0;
+    for (int run = 0; run < 5; ++run) {
+        valid = 0;
+        simd_time = min(simd_time, Time([&] {
+            for (const TleLines &set : sets) {
+                valid += KepCheck(set.line1, set.line2);
+            }
+        }));
+        scalar_time = min(scalar_time, Time([&] {
+            for (const TleLines &set : sets) {
+                valid += KepCheckScalar(set.line1, set.line2);
+            }
+        }));
+        legacy_time = min(legacy_time, Time([&] {
+            for (const TleLines &set : sets) {
+                valid += LegacyKepCheck(set.line1, set.line2);
+            }
+        }));
+        vector<Satellite> sat;
+        sat.reserve(sets.size());
+        parse_time = min(parse_time, Time([&] {
+            for (const TleLines &set : sets) {
+                sat.emplace_back(set.name, set.line1.data, set.line2.data);
+            }
+        }));
+    }
+    if (valid != 3 * sets.size()) {
+        printf("valid catalog rejected\n");
+        ++errors;
+    }
+    printf("%zu element sets\n", sets.size());
+    printf("parse            %8.3f ms\n", parse_time);
+    printf("KepCheck         %8.3f ms\n", simd_time);
+    printf("KepCheckScalar   %8.3f ms\n", scalar_time);
+    printf("former KepCheck  %8.3f ms\n", legacy_time);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BeamGeometry.h"
+#include "Catalog.h"
+#include "CatalogLoader.h"
+#include "SatelliteMgr.h"
+#include "SimulationClock.h"
+#include "TleParser.h"
+
+using namespace std;
+
+/*
+ * Loads catalogs with CatalogLoader while a render loop keeps running on
+ * the main thread: the loaded catalog and its beam vertices must be
+ * bitwise the same as loaded and built on the calling thread, the catalog
+ * must be saved, a newer request must win over a waiting one, a refresh
+ * must update the catalog, list the changed indices and initialize only
+ * the changed element sets like SatelliteMgr::Refresh() on the calling
+ * thread, and a reader that is not open must load nothing. Returns non-zero on any
+ * difference, and compares the longest frame of the render loop with
+ * the time of the same load on the render thread.
+ */
+
+static const char *PATH = "bench_loader.cat";
+
+// Time of a frame at 60 Hz in ms
+const double VSYNC = 1000. / 60;
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+// Reader of a missing file
+class ClosedReader: public IFileReader {
+public:
+    bool is_open() override {
+        return false;
+    }
+
+    StringView view() override {
+        return StringView();
+    }
+};
+
+/* Catalogs handed over by the loader, like the message queue does. */
+class Mailbox {
+    mutex mutex_;
+    condition_variable cv_;
+    vector<unique_ptr<LoadedCatalog>> catalogs_;
+public:
+    void Post(unique_ptr<LoadedCatalog> catalog) {
+        lock_guard<mutex> lock(mutex_);
+        catalogs_.push_back(move(catalog));
+        cv_.notify_one();
+    }
+
+    // Next catalog, nullptr if there is none
+    unique_ptr<LoadedCatalog> Take() {
+        lock_guard<mutex> lock(mutex_);
+        if (catalogs_.empty()) {
+            return nullptr;
+        }
+        unique_ptr<LoadedCatalog> catalog = move(catalogs_.front());
+        catalogs_.erase(catalogs_.begin());
+        return catalog;
+    }
+
+    // Same, waiting up to the timeout for one
+    unique_ptr<LoadedCatalog> Wait(chrono::milliseconds timeout) {
+        unique_lock<mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [this] {
+            return !catalogs_.empty();
+        });
+        lock.unlock();
+        return Take();
+    }
+};
+
+/* Planes of a beam, any values tell apart the vertices. */
+static BeamPlanes MakePlanes() {
+    BeamPlanes planes;
+    size_t vertices = (1 + BEAM_MAX_PLANES) * PTS_PER_BEAM;
+    for (size_t i = 0; i < vertices; ++i) {
+        planes.geometry.push_back(i);
+        planes.geometry.push_back(-1.f * i);
+        planes.geometry.push_back(0.5f * i);
+        planes.tex.push_back(i % 2);
+        planes.tex.push_back(i / 2 % 2);
+    }
+    return planes;
+}
+
+static CatalogLoader::Open OpenText(const string &text) {
+    return [text] {
+        return unique_ptr<IFileReader>(new StringReader(text));
+    };
+}
+
+/* Same catalog, positions and beams as loaded on this thread. */
+static bool SameAsDirect(const LoadedCatalog &catalog, const string &text,
+    const BeamPlanes &planes, SimulationClock &clock) {
+    SatelliteMgr direct;
+    direct.SetClock(&clock);
+    direct.Init(text.data(), text.size());
+    direct.UpdateAll();
+    const PositionSnapshot &snapshot = direct.AcquireSnapshot();
+    size_t tuple_size = GetBeamTupleSize(direct.GetNumber());
+    vector<Beam> beams;
+    BeamArrays arrays;
+    BuildBeams(snapshot, planes, tuple_size, beams, arrays);
+
+    SatelliteMgr &mgr = *catalog.mgr;
+    const PositionSnapshot &loaded = mgr.GetSnapshot();
+    bool same = mgr.GetNumber() == direct.GetNumber()
+            && loaded.position.size() == snapshot.position.size()
+            && memcmp(loaded.position.data(), snapshot.position.data(),
+                snapshot.position.size() * sizeof(SatellitePosition)) == 0
+            && catalog.tuple_size == tuple_size
+            && catalog.beams.size() == beams.size()
+            && catalog.arrays.geometry == arrays.geometry
+            && catalog.arrays.tex == arrays.tex
+            && catalog.arrays.color == arrays.color;
+    for (size_t i = 0; same && i < beams.size(); ++i) {
+        same = catalog.beams[i].first == beams[i].first
+                && catalog.beams[i].planes == beams[i].planes
+                && mgr.GetSatellite(i).GetCatNum()
+                        == direct.GetSatellite(i).GetCatNum();
+    }
+    return same;
+}
+
+/* Element sets of the text, three lines each. */
+static vector<string> SplitSets(const string &text) {
+    vector<string> sets;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = pos;
+        for (size_t line = 0; line < TLE_SET_LINES && end < text.size();
+                ++line) {
+            end = text.find('\n', end);
+            end = end == string::npos ? text.size() : end + 1;
+        }
+        sets.push_back(text.substr(pos, end - pos));
+        pos = end;
+    }
+    return sets;
+}
+
+/*
+ * The text with every 50th satellite removed, every 10th with the
+ * elements of another seed, and 1 % new satellites.
+ */
+static string MakeUpdate(const string &text) {
+    vector<string> old_sets = SplitSets(text);
+    size_t number = old_sets.size();
+    vector<string> new_sets = SplitSets(MakeCatalog(number + number / 100,
+        2));
+    string update;
+    for (size_t i = 0; i < new_sets.size(); ++i) {
+        if (i >= number || i % 10 == 1) {
+            update += new_sets[i];
+        } else if (i % 50 != 25) {
+            update += old_sets[i];
+        }
+    }
+    return update;
+}
+
+/*
+ * Refreshes a copy of the direct catalog to the text on the loader and
+ * the direct one on this thread, true if both have the same satellites,
+ * positions and changed indices and initialized the same propagators,
+ * fewer than the catalog has.
+ */
+static bool SameRefresh(CatalogLoader &loader, Mailbox &mailbox,
+    SatelliteMgr &direct, const string &text, size_t generation) {
+    vector<Satellite> base;
+    vector<SatelliteCalc> calc;
+    direct.CopyCatalog(base, calc);
+    loader.Refresh(OpenText(text), move(base), move(calc), generation);
+    vector<size_t> changed;
+    size_t initialized = direct.GetInitialized();
+    direct.Refresh(text.data(), text.size(), changed);
+    initialized = direct.GetInitialized() - initialized;
+    direct.UpdateAll();
+    unique_ptr<LoadedCatalog> catalog = mailbox.Wait(
+        chrono::milliseconds(10000));
+    if (!catalog) {
+        return false;
+    }
+
+    SatelliteMgr &mgr = *catalog->mgr;
+    const PositionSnapshot &loaded = mgr.AcquireSnapshot();
+    const PositionSnapshot &snapshot = direct.AcquireSnapshot();
+    bool same = catalog->refreshed && catalog->generation == generation
+            && catalog->changed == changed && !changed.empty()
+            && catalog->beams.empty() && mgr.GetNumber() == direct.GetNumber()
+            && mgr.GetInitialized() == initialized
+            && initialized < mgr.GetNumber() / 5
+            && loaded.position.size() == snapshot.position.size()
+            && memcmp(loaded.position.data(), snapshot.position.data(),
+                snapshot.position.size() * sizeof(SatellitePosition)) == 0;
+    for (size_t i = 0; same && i < mgr.GetNumber(); ++i) {
+        same = mgr.GetSatellite(i).GetCatNum()
+                == direct.GetSatellite(i).GetCatNum();
+    }
+    loader.Dispose(move(catalog->mgr));
+    return same;
+}
+
+/*
+ * Loads the text while frames run on this thread, which swaps the catalog
+ * in when it arrives. Returns the catalog, sets the longest frame.
+ */
+static unique_ptr<LoadedCatalog> LoadWhileRendering(CatalogLoader &loader,
+    Mailbox &mailbox, const string &text, double &max_frame) {
+    loader.Load(OpenText(text), PATH);
+    unique_ptr<SatelliteMgr> rendered(new SatelliteMgr);
+    unique_ptr<LoadedCatalog> catalog;
+    max_frame = 0;
+    while (!catalog) {
+        max_frame = max(max_frame, Time([&] {
+            catalog = mailbox.Take();
+            if (catalog) {
+                // What the render thread does besides the upload
+                rendered->Stop();
+                loader.Dispose(move(rendered));
+                catalog->mgr->AcquireSnapshot();
+            }
+        }));
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return catalog;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 25000;
+    string text = MakeCatalog(number);
+    string update = MakeCatalog(number / 2, 2);
+    BeamPlanes planes = MakePlanes();
+    SimulationClock clock;
+    clock.Pause();
+    clock.Tick();
+
+    Mailbox mailbox;
+    CatalogLoader loader([&mailbox](unique_ptr<LoadedCatalog> catalog) {
+        mailbox.Post(move(catalog));
+    });
+    loader.SetBeamPlanes(planes);
+    loader.SetClock(&clock);
+
+    double max_frame;
+    unique_ptr<LoadedCatalog> catalog = LoadWhileRendering(loader, mailbox,
+        text, max_frame);
+    bool same = SameAsDirect(*catalog, text, planes, clock);
+    SatelliteMgr cached;
+    bool saved = catalog->saved && cached.Load(PATH)
+            && cached.GetNumber() == catalog->mgr->GetNumber();
+    remove(PATH);
+
+    double direct_time = Time([&] {
+        SatelliteMgr direct;
+        direct.SetClock(&clock);
+        direct.Init(text.data(), text.size());
+        direct.Save(PATH);
+        direct.UpdateAll();
+        vector<Beam> beams;
+        BeamArrays arrays;
+        BuildBeams(direct.AcquireSnapshot(), planes,
+            GetBeamTupleSize(direct.GetNumber()), beams, arrays);
+    });
+    remove(PATH);
+    printf("%zu TLEs, %zu beam vertices\n", catalog->mgr->GetNumber(),
+        catalog->arrays.GetVertices());
+    printf("load on the render thread  %8.3f ms\n", direct_time);
+    printf("longest frame while loading %7.3f ms  %s\n", max_frame,
+        max_frame < VSYNC ? "within vsync" : "over vsync");
+    printf("catalog and beams %s, cache %s\n", same ? "ok" : "FAILED",
+        saved ? "ok" : "FAILED");
+
+    // The first request may start, the waiting ones are replaced
+    loader.Load(OpenText(text));
+    loader.Load(OpenText(text));
+    loader.Load(OpenText(update));
+    size_t delivered = 0;
+    unique_ptr<LoadedCatalog> last;
+    while (unique_ptr<LoadedCatalog> next = mailbox.Wait(
+        chrono::milliseconds(10000))) {
+        ++delivered;
+        last = move(next);
+        if (last->mgr->GetNumber() == number / 2) {
+            break;
+        }
+    }
+    bool latest = last && delivered <= 2
+            && SameAsDirect(*last, update, planes, clock);
+    printf("latest request %s, %zu catalogs\n", latest ? "ok" : "FAILED",
+        delivered);
+
+    // Changed, removed and new satellites, and back
+    SatelliteMgr direct;
+    direct.SetClock(&clock);
+    direct.Init(text.data(), text.size());
+    bool refresh = SameRefresh(loader, mailbox, direct, MakeUpdate(text), 1)
+            && SameRefresh(loader, mailbox, direct, text, 2);
+    printf("refresh %s\n", refresh ? "ok" : "FAILED");
+
+    loader.Load([] {
+        return unique_ptr<IFileReader>(new ClosedReader);
+    });
+    loader.Dispose(move(last->mgr));
+    bool closed = !mailbox.Wait(chrono::milliseconds(200));
+    printf("missing file %s\n", closed ? "ok" : "FAILED");
+    loader.Stop();
+    return same && saved && latest && refresh && closed ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+#include <poll.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "CatalogLoader.h"
+#include "Message.h"
+#include "MessageRing.h"
+
+using namespace std;
+
+/*
+ * Messages of several producer threads to one consumer thread that waits
+ * in poll() like ALooper does, through MessageRing and through a pipe
+ * with one write() and one read() per message like the former
+ * MessageQueue. Every message must arrive once and in the order of its
+ * producer, a full ring must keep the value, and a message pushed while
+ * draining must wake the consumer again. MessageBatch must only hand
+ * over the latest message of every coalesced command of a batch, also
+ * of a burst from another thread, and every loaded catalog. Returns non-zero on any difference, and compares
+ * the message rates.
+ */
+
+static_assert(!std::is_copy_constructible<Message>::value,
+    "the payloads of a message have one owner");
+
+const size_t CAPACITY = 1024;
+static const size_t PRODUCERS[] = {1, 2, 4};
+
+// Same layout as the former message of the app, with a raw payload
+struct PipeMessage {
+    int cmd;
+    void *payload;
+};
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+/* Sequence of the messages of every producer, true while in order. */
+class Checker {
+    vector<size_t> next_;
+    bool ok_ = true;
+public:
+    explicit Checker(size_t producers) :
+            next_(producers, 0) {
+    }
+
+    void Check(const PipeMessage &msg) {
+        size_t sequence = reinterpret_cast<size_t>(msg.payload);
+        ok_ = ok_ && (size_t)msg.cmd < next_.size()
+                && sequence == next_[msg.cmd]++;
+    }
+
+    bool ok(size_t messages) const {
+        for (size_t next : next_) {
+            if (next != messages) {
+                return false;
+            }
+        }
+        return ok_;
+    }
+};
+
+// The former queue
+class PipeQueue {
+    int pipe_[2];
+public:
+    PipeQueue() {
+        if (pipe(pipe_)) {
+            pipe_[0] = pipe_[1] = -1;
+        }
+    }
+
+    ~PipeQueue() {
+        close(pipe_[0]);
+        close(pipe_[1]);
+    }
+
+    int GetFd() const {
+        return pipe_[0];
+    }
+
+    bool Push(const PipeMessage &msg) {
+        return write(pipe_[1], &msg, sizeof(msg)) == sizeof(msg);
+    }
+
+    // One message per wakeup, like the looper callback did
+    template<class F>
+    size_t Drain(F handle) {
+        PipeMessage msg;
+        if (read(pipe_[0], &msg, sizeof(msg)) != sizeof(msg)) {
+            return 0;
+        }
+        handle(msg);
+        return 1;
+    }
+};
+
+static bool Push(PipeQueue &queue, PipeMessage msg) {
+    return queue.Push(msg);
+}
+
+static bool Push(MessageRing<PipeMessage> &ring, PipeMessage msg) {
+    // Waits for the consumer while the ring is full
+    while (!ring.Push(move(msg))) {
+        this_thread::yield();
+    }
+    return true;
+}
+
+/*
+ * Messages per second from the producers to a consumer waiting in poll(),
+ * sets the number of wakeups of the consumer and ok if every message
+ * arrived in order.
+ */
+template<class Q>
+static double Run(Q &queue, size_t producers, size_t messages,
+    size_t &wakeups, bool &ok) {
+    Checker checker(producers);
+    wakeups = 0;
+    double time = Time([&] {
+        vector<thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, p, messages] {
+                for (size_t i = 0; i < messages; ++i) {
+                    PipeMessage msg = {(int)p, reinterpret_cast<void*>(i)};
+                    Push(queue, msg);
+                }
+            });
+        }
+        size_t total = producers * messages;
+        size_t received = 0;
+        pollfd fd = {queue.GetFd(), POLLIN, 0};
+        while (received < total) {
+            if (poll(&fd, 1, -1) <= 0) {
+                continue;
+            }
+            ++wakeups;
+            received += queue.Drain([&checker](PipeMessage msg) {
+                checker.Check(msg);
+            });
+        }
+        for (thread &t : threads) {
+            t.join();
+        }
+    });
+    ok = checker.ok(messages);
+    return producers * messages / time * 1E3;
+}
+
+static bool Readable(int fd) {
+    pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 0) == 1;
+}
+
+/* Full ring, empty transitions and pushes of the handler. */
+static bool CheckRing() {
+    MessageRing<PipeMessage> ring(3);
+    bool ok = ring.GetFd() >= 0 && ring.GetCapacity() == 4
+            && !Readable(ring.GetFd());
+    for (size_t i = 0; i < 4; ++i) {
+        PipeMessage msg = {0, reinterpret_cast<void*>(i)};
+        ok = ok && ring.Push(move(msg));
+    }
+    PipeMessage full = {1, reinterpret_cast<void*>(42)};
+    ok = ok && !ring.Push(move(full)) && full.cmd == 1
+            && Readable(ring.GetFd());
+
+    // The message of the handler waits for the next call
+    Checker checker(1);
+    size_t drained = ring.Drain([&](PipeMessage msg) {
+        checker.Check(msg);
+        if (msg.payload == reinterpret_cast<void*>(3)) {
+            PipeMessage next = {0, reinterpret_cast<void*>(4)};
+            ring.Push(move(next));
+        }
+    });
+    ok = ok && drained == 4 && Readable(ring.GetFd());
+    drained = ring.Drain([&](PipeMessage msg) {
+        checker.Check(msg);
+    });
+    ok = ok && drained == 1 && checker.ok(5) && !Readable(ring.GetFd());
+    printf("ring %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ * Latest message of every coalesced command of a batch and every loaded
+ * catalog, in their order.
+ */
+static bool CheckCoalescing(size_t messages) {
+    MessageRing<Message> ring(CAPACITY);
+    MessageBatch batch;
+    ring.Push(Message::UseTle("first.txt"));
+    ring.Push(Message::ShowBeam(1, 25544));
+    ring.Push(Message::CatalogReady(unique_ptr<LoadedCatalog>(
+        new LoadedCatalog)));
+    ring.Push(Message::UseTle("second.txt"));
+    ring.Push(Message::CatalogReady(unique_ptr<LoadedCatalog>(
+        new LoadedCatalog)));
+    ring.Push(Message::ShowBeam(2, 20580));
+    vector<Message> handled;
+    size_t number = batch.Read(ring, [&handled](Message msg) {
+        handled.push_back(move(msg));
+    });
+    bool ok = number == 4 && handled.size() == 4
+            && handled[0].cmd == CATALOG_READY && handled[0].catalog
+            && handled[1].cmd == USE_TLE && handled[1].path == "second.txt"
+            && handled[2].cmd == CATALOG_READY && handled[2].catalog
+            && handled[3].cmd == SHOW_BEAM && handled[3].index == 2
+            && handled[3].catnum == 20580;
+
+    // A burst of selections while the consumer is busy
+    size_t reads = 0, loads = 0;
+    string last;
+    thread producer([&ring, messages] {
+        for (size_t i = 0; i < messages; ++i) {
+            Message msg = Message::UseTle(to_string(i));
+            while (!ring.Push(move(msg))) {
+                this_thread::yield();
+            }
+        }
+    });
+    pollfd fd = {ring.GetFd(), POLLIN, 0};
+    while (last != to_string(messages - 1)) {
+        if (poll(&fd, 1, -1) <= 0) {
+            continue;
+        }
+        ++reads;
+        loads += batch.Read(ring, [&last](Message msg) {
+            last = move(msg.path);
+        });
+    }
+    producer.join();
+    ok = ok && loads <= reads && loads < messages;
+    printf("coalescing %s, %zu selections loaded %zu times\n",
+        ok ? "ok" : "FAILED", messages, loads);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    size_t messages = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    bool ok = CheckRing();
+    ok = CheckCoalescing(messages) && ok;
+    printf("%zu messages per producer\n", messages);
+    printf("%-10s %-6s %14s %10s\n", "producers", "queue", "messages/s",
+        "wakeups");
+    for (size_t producers : PRODUCERS) {
+        size_t pipe_wakeups, ring_wakeups;
+        bool pipe_ok, ring_ok;
+        PipeQueue pipe;
+        double pipe_rate = Run(pipe, producers, messages, pipe_wakeups,
+            pipe_ok);
+        MessageRing<PipeMessage> ring(CAPACITY);
+        double ring_rate = Run(ring, producers, messages, ring_wakeups,
+            ring_ok);
+        printf("%-10zu %-6s %14.0f %10zu  %s\n", producers, "pipe",
+            pipe_rate, pipe_wakeups, pipe_ok ? "ok" : "FAILED");
+        printf("%-10zu %-6s %14.0f %10zu  %s\n", producers, "ring",
+            ring_rate, ring_wakeups, ring_ok ? "ok" : "FAILED");
+        ok = ok && pipe_ok && ring_ok;
+    }
+    return ok ? 0 : 1;
+}
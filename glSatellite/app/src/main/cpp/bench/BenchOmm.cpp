@@ -0,0 +1,403 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Catalog.h"
+#include "OmmParser.h"
+#include "Satellite.h"
+#include "SatelliteMgr.h"
+#include "TleParser.h"
+
+using namespace std;
+
+/*
+ * Converts a TLE catalog to OMM in CSV, KVN and XML and loads all four:
+ * every format must give the same satellites, propagating to the same
+ * positions within the rounding of the epoch. Hand-made messages check
+ * quoting, entities, units, epochs and catalog numbers beyond five
+ * digits. Returns non-zero on any difference, and compares the parsing
+ * throughput of the formats on the same element sets.
+ */
+
+// Times of the comparison in days from now
+static const double DAYS[] = {0, 3.5, -20, 0.01};
+// Position difference in degrees and km
+static const float TOLERANCE = 1E-3;
+
+static const char CSV_HEADER[] = "OBJECT_NAME,OBJECT_ID,EPOCH,MEAN_MOTION,"
+        "ECCENTRICITY,INCLINATION,RA_OF_ASC_NODE,ARG_OF_PERICENTER,"
+        "MEAN_ANOMALY,EPHEMERIS_TYPE,CLASSIFICATION_TYPE,NORAD_CAT_ID,"
+        "ELEMENT_SET_NO,REV_AT_EPOCH,BSTAR,MEAN_MOTION_DOT,"
+        "MEAN_MOTION_DDOT\r\n";
+
+// Values of one element set as an OMM has them
+struct Omm {
+    string name, id, epoch, meanmo, eccn, incl, raan, argper, meanan,
+            catnum, setnum, orbitnum, bstar, drag, nddot;
+};
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+static string Columns(const StringView &line, size_t begin, size_t end) {
+    string value = line.str().substr(begin, end - begin + 1);
+    value.erase(0, value.find_first_not_of(' '));
+    value.erase(value.find_last_not_of(' ') + 1);
+    return value;
+}
+
+/* Decimal of a TLE field with an implied point and exponent. */
+static string ExponentField(const StringView &line, size_t begin) {
+    string mantissa = Columns(line, begin, begin + 5);
+    string sign;
+    if (!mantissa.empty() && (mantissa[0] == '-' || mantissa[0] == '+')) {
+        sign = mantissa[0] == '-' ? "-" : "";
+        mantissa.erase(0, 1);
+    }
+    int exponent = line[begin + 7] - '0';
+    return sign + "0." + string(exponent, '0') + mantissa;
+}
+
+static Omm ToOmm(const TleLines &lines) {
+    Omm omm;
+    const StringView &l1 = lines.line1, &l2 = lines.line2;
+    omm.name = Columns(lines.name, 0, lines.name.size - 1);
+    int year = atoi(Columns(l1, 18, 19).c_str());
+    year += year < 57 ? 2000 : 1900;
+    string designator = Columns(l1, 9, 16);
+    omm.id = to_string(designator[0] < '5' ? 2000 : 1900).substr(0, 2)
+            + designator.substr(0, 2) + "-" + designator.substr(2);
+
+    // Day of the year to the date and the time in microseconds
+    double refepoch = atof(Columns(l1, 20, 31).c_str());
+    int yday = (int)refepoch;
+    long long us = llround((refepoch - yday) * 86400E6);
+    int seconds = us / 1000000;
+    struct tm date = {};
+    date.tm_year = year - 1900;
+    date.tm_mday = yday;
+    timegm(&date);
+    char epoch[64];
+    snprintf(epoch, sizeof(epoch), "%04d-%02d-%02dT%02d:%02d:%02d.%06d",
+        year, date.tm_mon + 1, date.tm_mday, seconds / 3600,
+        seconds / 60 % 60, seconds % 60, (int)(us % 1000000));
+    omm.epoch = epoch;
+
+    omm.meanmo = Columns(l2, 52, 62);
+    omm.eccn = "0." + Columns(l2, 26, 32);
+    omm.incl = Columns(l2, 8, 15);
+    omm.raan = Columns(l2, 17, 24);
+    omm.argper = Columns(l2, 34, 41);
+    omm.meanan = Columns(l2, 43, 50);
+    omm.catnum = to_string(atoi(Columns(l1, 2, 6).c_str()));
+    omm.setnum = Columns(l1, 64, 67);
+    omm.orbitnum = Columns(l2, 63, 67);
+    omm.bstar = ExponentField(l1, 53);
+    omm.drag = Columns(l1, 33, 42);
+    omm.nddot = ExponentField(l1, 44);
+    return omm;
+}
+
+static vector<Omm> ToOmm(const string &text) {
+    vector<Omm> omm;
+    TleParser parser(text.data(), text.size());
+    TleLines lines;
+    while (parser.Next(lines)) {
+        if (KepCheck(lines.line1, lines.line2)) {
+            omm.push_back(ToOmm(lines));
+        }
+    }
+    return omm;
+}
+
+static string Csv(const vector<Omm> &omm) {
+    string text = CSV_HEADER;
+    for (const Omm &o : omm) {
+        text += o.name + "," + o.id + "," + o.epoch + "," + o.meanmo + ","
+                + o.eccn + "," + o.incl + "," + o.raan + "," + o.argper
+                + "," + o.meanan + ",0,U," + o.catnum + "," + o.setnum + ","
+                + o.orbitnum + "," + o.bstar + "," + o.drag + "," + o.nddot
+                + "\r\n";
+    }
+    return text;
+}
+
+static string Kvn(const vector<Omm> &omm) {
+    string text;
+    for (const Omm &o : omm) {
+        text += "CCSDS_OMM_VERS = 2.0\n"
+                "COMMENT Synthetic catalog\n"
+                "CREATION_DATE = 2024-01-01T00:00:00\n"
+                "ORIGINATOR = BENCH\n\n"
+                "OBJECT_NAME = " + o.name + "\n"
+                "OBJECT_ID = " + o.id + "\n"
+                "CENTER_NAME = EARTH\n"
+                "REF_FRAME = TEME\n"
+                "TIME_SYSTEM = UTC\n"
+                "MEAN_ELEMENT_THEORY = SGP4\n\n"
+                "EPOCH = " + o.epoch + "\n"
+                "MEAN_MOTION = " + o.meanmo + " [rev/day]\n"
+                "ECCENTRICITY = " + o.eccn + "\n"
+                "INCLINATION = " + o.incl + " [deg]\n"
+                "RA_OF_ASC_NODE = " + o.raan + " [deg]\n"
+                "ARG_OF_PERICENTER = " + o.argper + " [deg]\n"
+                "MEAN_ANOMALY = " + o.meanan + " [deg]\n\n"
+                "EPHEMERIS_TYPE = 0\n"
+                "CLASSIFICATION_TYPE = U\n"
+                "NORAD_CAT_ID = " + o.catnum + "\n"
+                "ELEMENT_SET_NO = " + o.setnum + "\n"
+                "REV_AT_EPOCH = " + o.orbitnum + "\n"
+                "BSTAR = " + o.bstar + " [1/ER]\n"
+                "MEAN_MOTION_DOT = " + o.drag + " [rev/day**2]\n"
+                "MEAN_MOTION_DDOT = " + o.nddot + " [rev/day**3]\n\n";
+    }
+    return text;
+}
+
+static string Element(const char *name, const string &value) {
+    return string("<") + name + ">" + value + "</" + name + ">";
+}
+
+static string Xml(const vector<Omm> &omm) {
+    string text = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<ndm "
+            "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n";
+    for (const Omm &o : omm) {
+        text += "<omm id=\"CCSDS_OMM_VERS\" version=\"2.0\">\n<header>"
+                + Element("CREATION_DATE", "2024-01-01T00:00:00")
+                + Element("ORIGINATOR", "BENCH") + "</header>\n<body>"
+                "<segment>\n<metadata>" + Element("OBJECT_NAME", o.name)
+                + Element("OBJECT_ID", o.id)
+                + Element("CENTER_NAME", "EARTH")
+                + Element("REF_FRAME", "TEME")
+                + Element("TIME_SYSTEM", "UTC")
+                + Element("MEAN_ELEMENT_THEORY", "SGP4") + "</metadata>\n"
+                "<data>\n<meanElements>" + Element("EPOCH", o.epoch)
+                + Element("MEAN_MOTION", o.meanmo)
+                + Element("ECCENTRICITY", o.eccn)
+                + Element("INCLINATION", o.incl)
+                + Element("RA_OF_ASC_NODE", o.raan)
+                + Element("ARG_OF_PERICENTER", o.argper)
+                + Element("MEAN_ANOMALY", o.meanan) + "</meanElements>\n"
+                "<tleParameters>" + Element("EPHEMERIS_TYPE", "0")
+                + Element("CLASSIFICATION_TYPE", "U")
+                + Element("NORAD_CAT_ID", o.catnum)
+                + Element("ELEMENT_SET_NO", o.setnum)
+                + Element("REV_AT_EPOCH", o.orbitnum)
+                + Element("BSTAR", o.bstar)
+                + Element("MEAN_MOTION_DOT", o.drag)
+                + Element("MEAN_MOTION_DDOT", o.nddot)
+                + "</tleParameters>\n</data>\n</segment>\n</body>\n</omm>\n";
+    }
+    return text + "</ndm>\n";
+}
+
+/* Same satellites, positions within the tolerance. */
+static bool Compare(SatelliteMgr &a, SatelliteMgr &b) {
+    if (a.GetNumber() != b.GetNumber() || a.GetNumber() == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < a.GetNumber(); ++i) {
+        if (a.GetSatellite(i).GetCatNum() != b.GetSatellite(i).GetCatNum()
+                || a.GetSatellite(i).GetName()
+                        != b.GetSatellite(i).GetName()) {
+            return false;
+        }
+    }
+    double daynum = CurrentDaynum();
+    for (double days : DAYS) {
+        PropagationContext context(daynum + days);
+        a.UpdateAll(context);
+        b.UpdateAll(context);
+        const PositionSnapshot &sa = a.AcquireSnapshot();
+        const PositionSnapshot &sb = b.AcquireSnapshot();
+        for (size_t i = 0; i < sa.position.size(); ++i) {
+            const SatellitePosition &pa = sa.position[i];
+            const SatellitePosition &pb = sb.position[i];
+            if (fabs(pa.latitude - pb.latitude) > TOLERANCE
+                    || fabs(pa.longitude - pb.longitude) > TOLERANCE
+                    || fabs(pa.altitude - pb.altitude) > TOLERANCE) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* The OMMs of the text, false if the format is not detected. */
+static bool Parse(const string &text, OMM_FORMATS format,
+    vector<OmmFields> &fields) {
+    if (OmmParser::DetectFormat(StringView(text)) != format) {
+        return false;
+    }
+    OmmParser parser(text.data(), text.size(), format);
+    OmmFields omm;
+    while (parser.Next(omm)) {
+        fields.push_back(omm);
+    }
+    return true;
+}
+
+static bool Is(const StringView &value, const char *str) {
+    return value.str() == str;
+}
+
+/* Hand-made messages of the corner cases. */
+static bool CheckCases() {
+    vector<OmmFields> csv, kvn, xml;
+    string csv_text = string(CSV_HEADER)
+            + "\"ONE, TWO\",2024-001A,2024-015T12:00:00,15.5,.001,51.6,10,"
+              "20,30,0,U,270000,999,1,.0001,.00001,0\r\n"
+              "\r\n"
+              "SHORT,2024-002A,2024-01-15T12:00:00Z,15.5\r\n";
+    string kvn_text =
+            "OBJECT_NAME = FIRST\n"
+            "EPOCH = 2024-03-01T00:00:00\n"
+            "MEAN_MOTION = 15.5 [rev/day]\r\n"
+            "OBJECT_NAME = SECOND\n"
+            "EPOCH = 2023-03-01T06:00:00.5\n";
+    string xml_text =
+            "<?xml version=\"1.0\"?><!-- <omm> in a comment -->"
+            "<ndm><omm a='>'><OBJECT_NAME>A &amp; B &lt;C&gt;</OBJECT_NAME>"
+            "<USER_DEFINED parameter=\"X\"/><NORAD_CAT_ID>\n 42 \n"
+            "</NORAD_CAT_ID></omm><omm><OBJECT_NAME><![CDATA[D & E]]>"
+            "</OBJECT_NAME></omm></ndm>";
+
+    int year[3];
+    double day[3];
+    bool ok = Parse(csv_text, OMM_CSV, csv) && csv.size() == 2
+            && Is(csv[0][OMM_OBJECT_NAME], "ONE, TWO")
+            && Is(csv[0][OMM_OBJECT_ID], "2024-001A")
+            && Is(csv[0][OMM_MEAN_MOTION_DDOT], "0") && OmmCheck(csv[0])
+            && Satellite(csv[0]).GetCatNum() == 270000
+            && Is(csv[1][OMM_MEAN_MOTION], "15.5")
+            && csv[1][OMM_ECCENTRICITY].empty() && !OmmCheck(csv[1])
+            && ParseOmmEpoch(csv[0][OMM_EPOCH], year[0], day[0])
+            && ParseOmmEpoch(csv[1][OMM_EPOCH], year[1], day[1])
+            && year[0] == 2024 && day[0] == 15.5 && year[1] == 2024
+            && day[1] == 15.5;
+    printf("CSV cases %s\n", ok ? "ok" : "FAILED");
+
+    bool kvn_ok = Parse(kvn_text, OMM_KVN, kvn) && kvn.size() == 2
+            && Is(kvn[0][OMM_OBJECT_NAME], "FIRST")
+            && Is(kvn[0][OMM_MEAN_MOTION], "15.5")
+            && Is(kvn[1][OMM_OBJECT_NAME], "SECOND")
+            && kvn[1][OMM_MEAN_MOTION].empty()
+            && ParseOmmEpoch(kvn[0][OMM_EPOCH], year[0], day[0])
+            && ParseOmmEpoch(kvn[1][OMM_EPOCH], year[1], day[1])
+            && day[0] == 61 && fabs(day[1] - (60.25 + 0.5 / 86400)) < 1E-12
+            && !ParseOmmEpoch(StringView(string("2024-13-01")), year[2],
+                day[2]);
+    printf("KVN cases %s\n", kvn_ok ? "ok" : "FAILED");
+
+    // Decoded names are valid until the next OMM
+    OmmParser parser(xml_text.data(), xml_text.size(), OMM_XML);
+    OmmFields fields;
+    bool xml_ok = Parse(xml_text, OMM_XML, xml) && xml.size() == 2
+            && parser.Next(fields)
+            && Is(fields[OMM_OBJECT_NAME], "A & B <C>")
+            && Is(fields[OMM_NORAD_CAT_ID], "42") && parser.Next(fields)
+            && Is(fields[OMM_OBJECT_NAME], "D & E") && !parser.Next(fields);
+    printf("XML cases %s\n", xml_ok ? "ok" : "FAILED");
+
+    string tle = MakeCatalog(3);
+    bool tle_ok = OmmParser::DetectFormat(StringView(tle)) == MAX_OMM_FORMATS;
+    return ok && kvn_ok && xml_ok && tle_ok;
+}
+
+/*
+ * Element sets per second of parsing, checking and decoding the text,
+ * best of five. Returns the time.
+ */
+static double ParseRate(const char *label, const string &text,
+    size_t number, double tle_time) {
+    double time = 1E300;
+    size_t parsed = 0;
+    for (int run = 0; run < 5; ++run) {
+        vector<Satellite> sat;
+        sat.reserve(number);
+        time = min(time, Time([&] {
+            OMM_FORMATS format = OmmParser::DetectFormat(StringView(text));
+            if (format == MAX_OMM_FORMATS) {
+                TleParser parser(text.data(), text.size());
+                TleLines lines;
+                while (parser.Next(lines)) {
+                    if (KepCheck(lines.line1, lines.line2)) {
+                        sat.emplace_back(lines.name, lines.line1.data,
+                            lines.line2.data);
+                    }
+                }
+                return;
+            }
+            OmmParser parser(text.data(), text.size(), format);
+            OmmFields fields;
+            while (parser.Next(fields)) {
+                if (OmmCheck(fields)) {
+                    sat.emplace_back(fields);
+                }
+            }
+        }));
+        parsed = sat.size();
+    }
+    printf("%-4s %6.2f MB %8.3f ms %7.1f MB/s %6.2f M sets/s %6.2fx TLE"
+        "%s\n", label, text.size() * 1E-6, time, text.size() * 1E-3 / time,
+        parsed * 1E-3 / time, time / (tle_time > 0 ? tle_time : time),
+        parsed == number ? "" : "  MISSING SETS");
+    return time;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 25000;
+    string tle = MakeCatalog(number);
+    vector<Omm> omm = ToOmm(tle);
+    const char *labels[] = {"CSV", "KVN", "XML"};
+    string texts[] = {Csv(omm), Kvn(omm), Xml(omm)};
+
+    bool ok = CheckCases();
+
+    SatelliteMgr reference;
+    reference.SetMaxError(0);
+    reference.Init(tle.data(), tle.size());
+    for (size_t k = 0; k < MAX_OMM_FORMATS; ++k) {
+        SatelliteMgr mgr;
+        mgr.SetMaxError(0);
+        mgr.Init(texts[k].data(), texts[k].size());
+        bool same = Compare(reference, mgr);
+        printf("Init %s %s\n", labels[k], same ? "ok" : "FAILED");
+        ok = ok && same;
+    }
+
+    // Streaming load of the largest format
+    SatelliteMgr streamed;
+    streamed.SetMaxError(0);
+    streamed.Stream(unique_ptr<IFileReader>(new StringReader(texts[OMM_XML])));
+    PropagationContext context(CurrentDaynum());
+    while (streamed.IsLoading()) {
+        streamed.UpdateAll(context);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    bool stream = Compare(reference, streamed);
+    printf("Stream XML %s\n", stream ? "ok" : "FAILED");
+    ok = ok && stream;
+
+    // Same element sets in every format
+    printf("%zu element sets\n", omm.size());
+    double tle_time = ParseRate("TLE", tle, omm.size(), 0);
+    for (size_t k = 0; k < MAX_OMM_FORMATS; ++k) {
+        ParseRate(labels[k], texts[k], omm.size(), tle_time);
+    }
+    return ok ? 0 : 1;
+}
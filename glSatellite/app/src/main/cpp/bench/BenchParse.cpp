@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Catalog.h"
+#include "Satellite.h"
+#include "SatelliteMgr.h"
+#include "ThreadPool.h"
+#include "TleParser.h"
+
+using namespace std;
+
+/*
+ * Compares the in-place TLE parser with the former per-line and per-field
+ * string path of Satellite and SatelliteMgr::Init. Every numeric field of
+ * the catalog, and a few hand-made fields, must decode to exactly the
+ * value atoi()/atof() give, the lines of IFileReader::getline() must be
+ * those of std::getline(), and the parallel SatelliteMgr::Init and the
+ * streaming SatelliteMgr::Stream must load the same catalog as the serial
+ * Init, otherwise it returns non-zero.
+ */
+
+// Threads of the parallel Init, also on machines with fewer cores
+const size_t INIT_THREADS = 4;
+
+// Fields as the former Satellite constructor decoded them
+struct LegacyTle {
+    string name;
+    int catnum;
+    string designator;
+    int year;
+    double refepoch, nddot, bstar, incl, raan, eccn, argper, meanan, meanmo,
+            drag;
+    long setnum, orbitnum;
+};
+
+// Columns of the numeric fields
+struct Field {
+    int line;
+    size_t start, end;
+};
+
+static const Field FIELDS[] = {
+    {1, 2, 6}, {1, 18, 19}, {1, 20, 31}, {1, 33, 42}, {1, 44, 49},
+    {1, 53, 58}, {1, 64, 67}, {2, 8, 15}, {2, 17, 24}, {2, 26, 32},
+    {2, 34, 41}, {2, 43, 50}, {2, 52, 62}, {2, 63, 67}
+};
+
+// Fields beyond the catalog: signs, blanks and the atof() fallback
+static const char *EDGE_CASES[] = {
+    "      ", " -.00073094", "+.5", "-0", "0.", "  1 2 3 ", "12345678901234567",
+    "1.5e3", "2.5-3", "-+1", "..5", "0.00000000000000000000001"
+};
+
+static bool IsSpace(char c) {
+    return isspace((unsigned char)c);
+}
+
+static string SubString(const string &value, size_t start, size_t end) {
+    string str = value.substr(start, end - start + 1);
+    str.erase(remove_if(str.begin(), str.end(), IsSpace), str.end());
+    return str;
+}
+
+static LegacyTle Legacy(const string &name, const string &line1,
+    const string &line2) {
+    LegacyTle tle;
+    tle.name = name;
+    tle.name.erase(find_if(tle.name.rbegin(), tle.name.rend(),
+        [](char c) { return !IsSpace(c); }).base(), tle.name.end());
+    tle.catnum = atoi(SubString(line1, 2, 6).c_str());
+    tle.designator = SubString(line1, 9, 16);
+    tle.year = atoi(SubString(line1, 18, 19).c_str());
+    tle.refepoch = atof(SubString(line1, 20, 31).c_str());
+    tle.nddot = atof(SubString(line1, 44, 49).c_str());
+    tle.bstar = atof(SubString(line1, 53, 58).c_str());
+    tle.setnum = atol(SubString(line1, 64, 67).c_str());
+    tle.incl = atof(SubString(line2, 8, 15).c_str());
+    tle.raan = atof(SubString(line2, 17, 24).c_str());
+    tle.eccn = atof(SubString(line2, 26, 32).c_str());
+    tle.argper = atof(SubString(line2, 34, 41).c_str());
+    tle.meanan = atof(SubString(line2, 43, 50).c_str());
+    tle.meanmo = atof(SubString(line2, 52, 62).c_str());
+    tle.drag = atof(SubString(line1, 33, 42).c_str());
+    tle.orbitnum = atof(SubString(line2, 63, 67).c_str());
+    return tle;
+}
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+/* Number of fields of the text that decode differently. */
+static size_t CheckFields(const string &text) {
+    size_t errors = 0;
+    TleParser parser(text.data(), text.size());
+    TleLines lines;
+    while (parser.Next(lines)) {
+        if (lines.line1.size < TLE_LINE_LENGTH) {
+            continue;
+        }
+        for (const Field &field : FIELDS) {
+            string line = (field.line == 1 ? lines.line1 : lines.line2).str();
+            string str = SubString(line, field.start, field.end);
+            if (ParseDouble(line.c_str(), field.start, field.end)
+                    != atof(str.c_str())
+                    || ParseLong(line.c_str(), field.start, field.end)
+                            != atol(str.c_str())) {
+                printf("field mismatch: \"%s\"\n", str.c_str());
+                ++errors;
+            }
+        }
+    }
+
+    for (const char *field : EDGE_CASES) {
+        string str = SubString(field, 0, strlen(field) - 1);
+        if (ParseDouble(field, 0, strlen(field) - 1) != atof(str.c_str())
+                || ParseLong(field, 0, strlen(field) - 1)
+                        != atol(str.c_str())) {
+            printf("field mismatch: \"%s\"\n", field);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+/* Removes one line and breaks one checksum every period lines. */
+static string Damage(const string &text, size_t period) {
+    string result;
+    size_t line = 0;
+    for (size_t pos = 0; pos < text.size(); ++line) {
+        size_t eol = min(text.find('\n', pos), text.size() - 1);
+        if (line % period == period / 2) {
+            string damaged = text.substr(pos, eol - pos + 1);
+            damaged[0] = damaged[0] == '1' ? '2' : '1';
+            result += damaged;
+        } else if (line % period != 0) {
+            result.append(text, pos, eol - pos + 1);
+        }
+        pos = eol + 1;
+    }
+    return result;
+}
+
+/* Loads the text with and without the pool, false if they differ. */
+static bool CheckInit(const string &text) {
+    SatelliteMgr serial, parallel;
+    ThreadPool pool(INIT_THREADS);
+    serial.SetMaxError(0);
+    parallel.SetMaxError(0);
+    parallel.SetThreadPool(&pool);
+
+    double serial_time = Time([&] {
+        serial.Init(text.data(), text.size());
+    });
+    double parallel_time = Time([&] {
+        parallel.Init(text.data(), text.size());
+    });
+
+    bool ok = serial.GetNumber() == parallel.GetNumber();
+    for (size_t i = 0; ok && i < serial.GetNumber(); ++i) {
+        Satellite &a = serial.GetSatellite(i);
+        Satellite &b = parallel.GetSatellite(i);
+        ok = a.GetCatNum() == b.GetCatNum() && a.GetName() == b.GetName();
+    }
+    printf("Init %zu TLEs  serial %.3f ms, %zu threads %.3f ms  %s\n",
+        serial.GetNumber(), serial_time, INIT_THREADS, parallel_time,
+        ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* Lines of getline() of the reader as std::getline() reads them. */
+static bool CheckReader(const string &text) {
+    StringReader reader(text);
+    istringstream stream(text);
+    string line;
+    while (!reader.eof()) {
+        getline(stream, line);
+        if (reader.getline() != line || reader.eof() != stream.eof()) {
+            return false;
+        }
+    }
+    return stream.eof();
+}
+
+/* Same satellites and positions at the time of the context. */
+static bool SameCatalog(SatelliteMgr &a, SatelliteMgr &b,
+    const PropagationContext &context) {
+    if (a.GetNumber() != b.GetNumber()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.GetNumber(); ++i) {
+        if (a.GetSatellite(i).GetCatNum() != b.GetSatellite(i).GetCatNum()
+                || a.GetSatellite(i).GetName()
+                        != b.GetSatellite(i).GetName()) {
+            return false;
+        }
+    }
+    a.UpdateAll(context);
+    b.UpdateAll(context);
+    const PositionSnapshot &sa = a.AcquireSnapshot();
+    const PositionSnapshot &sb = b.AcquireSnapshot();
+    return memcmp(sa.position.data(), sb.position.data(),
+        sa.position.size() * sizeof(SatellitePosition)) == 0;
+}
+
+/*
+ * Streams the text, from a string or from the view of a reader, and
+ * updates until the load is done, false if the catalog differs from the
+ * serial Init or the saved one.
+ */
+static bool CheckStream(const string &text, bool from_reader) {
+    const char *path = "bench_parse_stream.cat";
+    SatelliteMgr serial, streamed, saved;
+    serial.SetMaxError(0);
+    streamed.SetMaxError(0);
+    saved.SetMaxError(0);
+    serial.Init(text.data(), text.size());
+
+    // Updates as the producer thread makes them, with a shorter wait
+    size_t updates = 0;
+    double first_time = -1;
+    PropagationContext context(CurrentDaynum());
+    double time = Time([&] {
+        auto start = chrono::steady_clock::now();
+        if (from_reader) {
+            streamed.Stream(unique_ptr<IFileReader>(new StringReader(text)),
+                path);
+        } else {
+            streamed.Stream(text, path);
+        }
+        while (streamed.IsLoading()) {
+            streamed.UpdateAll(context);
+            ++updates;
+            const PositionSnapshot &snapshot = streamed.AcquireSnapshot();
+            if (first_time < 0 && !snapshot.position.empty()) {
+                chrono::duration<double, milli> elapsed =
+                        chrono::steady_clock::now() - start;
+                first_time = elapsed.count();
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+
+    bool ok = SameCatalog(serial, streamed, context) && saved.Load(path)
+            && SameCatalog(serial, saved, context);
+    remove(path);
+    printf("Stream %zu TLEs from %s  first satellites %.3f ms, all %.3f ms "
+        "in %zu updates  %s\n", streamed.GetNumber(),
+        from_reader ? "reader" : "string", first_time, time, updates,
+        ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 25000;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+    string text = MakeCatalog(number);
+
+    size_t errors = CheckFields(text);
+
+    // Best of the runs for both paths
+    double legacy_time = 1E300, time = 1E300;
+    size_t legacy_number = 0, parsed_number = 0;
+    for (int run = 0; run < runs; ++run) {
+        vector<LegacyTle> legacy;
+        legacy_time = min(legacy_time, Time([&] {
+            StringReader reader(text);
+            while (!reader.eof()) {
+                string name = reader.getline();
+                string line1 = reader.getline();
+                string line2 = reader.getline();
+                if (!reader.eof() && line1.size() >= TLE_LINE_LENGTH
+                        && line2.size() >= TLE_LINE_LENGTH) {
+                    legacy.push_back(Legacy(name, line1, line2));
+                }
+            }
+        }));
+        legacy_number = legacy.size();
+
+        vector<Satellite> sat;
+        sat.reserve(text.size() / (2 * TLE_LINE_LENGTH) + 1);
+        time = min(time, Time([&] {
+            TleParser parser(text.data(), text.size());
+            TleLines lines;
+            while (parser.Next(lines)) {
+                if (lines.line1.size >= TLE_LINE_LENGTH
+                        && lines.line2.size >= TLE_LINE_LENGTH) {
+                    sat.emplace_back(lines.name, lines.line1.data,
+                        lines.line2.data);
+                }
+            }
+        }));
+        parsed_number = sat.size();
+    }
+
+    if (parsed_number != legacy_number) {
+        printf("record mismatch: %zu parsed, %zu expected\n", parsed_number,
+            legacy_number);
+        ++errors;
+    }
+
+    printf("%zu TLEs, %.1f MB\n", parsed_number, text.size() * 1E-6);
+    printf("strings   %8.3f ms\n", legacy_time);
+    printf("in place  %8.3f ms  %5.2fx\n", time, legacy_time / time);
+    printf("%zu field errors %s\n", errors, errors ? "FAILED" : "ok");
+
+    // Without the last newline, and the empty text
+    bool lines = CheckReader(text) && CheckReader(Damage(text, 7))
+            && CheckReader(text.substr(0, text.size() - 1))
+            && CheckReader("") && CheckReader("\n\n");
+    printf("reader lines %s\n", lines ? "ok" : "FAILED");
+
+    // Damaged lines move the element sets off the three-line grid
+    bool ok = lines && CheckInit(text) && CheckInit(Damage(text, 10000))
+            && CheckStream(text, false) && CheckStream(text, true);
+    return errors || !ok ? 1 : 0;
+}
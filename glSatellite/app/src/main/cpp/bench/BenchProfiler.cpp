@@ -0,0 +1,147 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Catalog.h"
+#include "FrameProfiler.h"
+#include "SatelliteMgr.h"
+#include "SimulationClock.h"
+
+using namespace std;
+
+/*
+ * Records durations in FrameProfiler: the statistics of known durations
+ * must be exact, only the last samples of a zone may count, samples of
+ * concurrent threads must neither get lost nor mixed up, and an instance
+ * of SatelliteMgr must time its updates. Returns non-zero on any
+ * difference, and reports the cost of a zone with and without profiler.
+ */
+
+const size_t WRITERS = 4;
+const size_t ZONES = 1000000;
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+static bool Near(double value, double expected) {
+    return fabs(value - expected) < 1E-9;
+}
+
+/* 1 to 1000 us in a shuffled order. */
+static bool CheckStats() {
+    FrameProfiler profiler;
+    for (size_t i = 0; i < 1000; ++i) {
+        size_t us = i * 7 % 1000 + 1;
+        profiler.Record(ZONE_GLOBE, chrono::microseconds(us));
+    }
+    ZoneStats stats = profiler.GetStats(ZONE_GLOBE);
+    ZoneStats empty = profiler.GetStats(ZONE_SWAP);
+    bool ok = stats.count == 1000 && stats.samples == 1000
+            && Near(stats.min, 0.001) && Near(stats.avg, 0.5005)
+            && Near(stats.p50, 0.5) && Near(stats.p95, 0.95)
+            && Near(stats.p99, 0.99) && Near(stats.max, 1)
+            && empty.count == 0 && empty.samples == 0 && empty.max == 0;
+    printf("statistics %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* Samples overwritten by newer ones, negative durations count as 0. */
+static bool CheckRing() {
+    FrameProfiler profiler;
+    size_t samples = FrameProfiler::SAMPLES;
+    for (size_t i = 0; i < 2 * samples; ++i) {
+        profiler.Record(ZONE_SWAP, chrono::milliseconds(100));
+    }
+    for (size_t i = 0; i < samples; ++i) {
+        profiler.Record(ZONE_SWAP, chrono::milliseconds(1));
+    }
+    profiler.Record(ZONE_PICKING, chrono::nanoseconds(-5));
+    profiler.Record(ZONE_PICKING, chrono::seconds(10));
+    ZoneStats stats = profiler.GetStats(ZONE_SWAP);
+    ZoneStats clamped = profiler.GetStats(ZONE_PICKING);
+    bool ok = stats.count == 3 * samples && stats.samples == samples
+            && Near(stats.min, 1) && Near(stats.max, 1)
+            && clamped.min == 0 && Near(clamped.max, UINT32_MAX * 1E-6);
+    printf("ring %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* Writers with a duration each, the window only has their durations. */
+static bool CheckWriters(size_t samples) {
+    FrameProfiler profiler;
+    vector<thread> threads;
+    for (size_t w = 0; w < WRITERS; ++w) {
+        threads.emplace_back([&profiler, w, samples] {
+            for (size_t i = 0; i < samples; ++i) {
+                profiler.Record(ZONE_BEAMS, chrono::microseconds(w + 1));
+            }
+        });
+    }
+    for (thread &t : threads) {
+        t.join();
+    }
+    ZoneStats stats = profiler.GetStats(ZONE_BEAMS);
+    bool ok = stats.count == WRITERS * samples
+            && stats.samples == FrameProfiler::SAMPLES
+            && stats.min >= 0.001 && stats.max <= WRITERS * 0.001;
+    printf("%zu writers %s\n", WRITERS, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* Updates of a manager with a profiler. */
+static bool CheckUpdates(size_t number) {
+    string text = MakeCatalog(number);
+    SimulationClock clock;
+    FrameProfiler profiler;
+    SatelliteMgr mgr;
+    mgr.SetClock(&clock);
+    mgr.Init(text.data(), text.size());
+    mgr.SetProfiler(&profiler);
+    const size_t updates = 20;
+    for (size_t i = 0; i < updates; ++i) {
+        clock.Tick();
+        mgr.UpdateAll();
+    }
+    ZoneStats stats = profiler.GetStats(ZONE_UPDATE_ALL);
+    string dump = profiler.Dump();
+    bool ok = stats.count == updates && stats.min > 0
+            && dump.find("propagation") != string::npos
+            && dump.find("swap") == string::npos;
+    printf("%s", dump.c_str());
+    printf("%zu TLEs, updates %s\n", number, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5000;
+    bool ok = CheckStats();
+    ok = CheckRing() && ok;
+    ok = CheckWriters(100000) && ok;
+    ok = CheckUpdates(number) && ok;
+
+    FrameProfiler profiler;
+    double timed = Time([&profiler] {
+        for (size_t i = 0; i < ZONES; ++i) {
+            ProfileZone zone(&profiler, ZONE_FRAME);
+        }
+    });
+    double untimed = Time([] {
+        for (size_t i = 0; i < ZONES; ++i) {
+            ProfileZone zone(nullptr, ZONE_FRAME);
+        }
+    });
+    ok = ok && profiler.GetStats(ZONE_FRAME).count == ZONES;
+    printf("zone with profiler %6.1f ns, without %6.1f ns\n",
+        timed * 1E6 / ZONES, untimed * 1E6 / ZONES);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Catalog.h"
+#include "SatelliteMgr.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/*
+ * Refreshes a catalog with a new TLE text where some satellites are gone,
+ * some have new elements and some are new, and compares it with the new
+ * text loaded by Init(): every satellite must propagate to bitwise the
+ * same position, or within the cache error with the ephemeris cache, and
+ * the indices reported as changed must cover every satellite that moved.
+ * Returns non-zero on any difference.
+ */
+
+const size_t THREADS = 4;
+
+// Every REMOVED_PERIOD-th satellite is removed, every CHANGED_PERIOD-th
+// gets new elements, and NEW_PER_MILLE new ones are appended
+const size_t REMOVED_PERIOD = 50;
+const size_t CHANGED_PERIOD = 10;
+const size_t NEW_PER_MILLE = 30;
+
+// Times of the comparison in days from now
+static const double DAYS[] = {0, 3.5, -20, 0.01};
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+/* Element sets of the text, three lines each. */
+static vector<string> SplitSets(const string &text) {
+    vector<string> sets;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = pos;
+        for (int line = 0; line < 3 && end < text.size(); ++line) {
+            end = text.find('\n', end);
+            end = end == string::npos ? text.size() : end + 1;
+        }
+        sets.push_back(text.substr(pos, end - pos));
+        pos = end;
+    }
+    return sets;
+}
+
+/*
+ * New catalog from the old one: the changed elements and the new
+ * satellites come from a catalog of another seed, whose catalog numbers
+ * are the same. The last set repeats the catalog number of the first one
+ * with other elements, Refresh() keeps the first one. The reference text
+ * for Init() does not have it.
+ */
+static void MakeUpdate(const string &text, string &update,
+    string &reference) {
+    vector<string> old_sets = SplitSets(text);
+    size_t number = old_sets.size();
+    size_t added = number * NEW_PER_MILLE / 1000 + 1;
+    vector<string> new_sets = SplitSets(MakeCatalog(number + added, 2));
+    for (size_t i = 0; i < number; ++i) {
+        if (i % REMOVED_PERIOD == REMOVED_PERIOD / 2) {
+            continue;
+        }
+        reference += i % CHANGED_PERIOD == 1 ? new_sets[i] : old_sets[i];
+    }
+    for (size_t i = number; i < number + added; ++i) {
+        reference += new_sets[i];
+    }
+    update = reference + new_sets[0];
+}
+
+/* Same positions by catalog number, within tolerance in km and degrees. */
+static bool Compare(SatelliteMgr &a, SatelliteMgr &b, float tolerance) {
+    if (a.GetNumber() != b.GetNumber()) {
+        return false;
+    }
+    unordered_map<int, size_t> index;
+    for (size_t i = 0; i < b.GetNumber(); ++i) {
+        index[b.GetSatellite(i).GetCatNum()] = i;
+    }
+    if (index.size() != b.GetNumber()) {
+        return false;
+    }
+    vector<size_t> other(a.GetNumber());
+    for (size_t i = 0; i < a.GetNumber(); ++i) {
+        auto it = index.find(a.GetSatellite(i).GetCatNum());
+        if (it == index.end()
+                || a.GetSatellite(i).GetName()
+                        != b.GetSatellite(it->second).GetName()) {
+            return false;
+        }
+        other[i] = it->second;
+    }
+
+    double daynum = CurrentDaynum();
+    for (double days : DAYS) {
+        PropagationContext context(daynum + days);
+        a.UpdateAll(context);
+        b.UpdateAll(context);
+        const PositionSnapshot &sa = a.AcquireSnapshot();
+        const PositionSnapshot &sb = b.AcquireSnapshot();
+        for (size_t i = 0; i < sa.position.size(); ++i) {
+            const SatellitePosition &pa = sa.position[i];
+            const SatellitePosition &pb = sb.position[other[i]];
+            if (tolerance == 0 ?
+                    memcmp(&pa, &pb, sizeof(SatellitePosition)) != 0 :
+                    fabs(pa.latitude - pb.latitude) > tolerance
+                            || fabs(pa.longitude - pb.longitude) > tolerance
+                            || fabs(pa.altitude - pb.altitude) > tolerance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Satellites below the old number that are not in changed keep their
+ * index, and changed is ascending.
+ */
+static bool CheckChanged(const vector<int> &old_catnum, SatelliteMgr &mgr,
+    const vector<size_t> &changed) {
+    size_t number = min(old_catnum.size(), mgr.GetNumber());
+    vector<bool> listed(number);
+    for (size_t k = 0; k < changed.size(); ++k) {
+        if (changed[k] >= number || (k > 0 && changed[k] <= changed[k - 1])) {
+            return false;
+        }
+        listed[changed[k]] = true;
+    }
+    for (size_t i = 0; i < number; ++i) {
+        if (!listed[i] && mgr.GetSatellite(i).GetCatNum() != old_catnum[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Refreshes the catalog and compares it with a fresh Init(). */
+static bool CheckRefresh(size_t number, double max_error) {
+    string text = MakeCatalog(number);
+    string update, reference;
+    MakeUpdate(text, update, reference);
+
+    ThreadPool pool(THREADS);
+    SatelliteMgr refreshed, loaded;
+    refreshed.SetThreadPool(&pool);
+    loaded.SetThreadPool(&pool);
+    refreshed.SetMaxError(max_error);
+    loaded.SetMaxError(max_error);
+    refreshed.Init(text.data(), text.size());
+    // Propagated before, the refresh must not keep old states
+    refreshed.UpdateAll(PropagationContext(CurrentDaynum() + 1));
+
+    vector<int> old_catnum;
+    for (size_t i = 0; i < refreshed.GetNumber(); ++i) {
+        old_catnum.push_back(refreshed.GetSatellite(i).GetCatNum());
+    }
+    vector<size_t> changed;
+    double refresh_time = Time([&] {
+        refreshed.Refresh(update.data(), update.size(), changed);
+    });
+    double init_time = Time([&] {
+        loaded.Init(reference.data(), reference.size());
+    });
+
+    bool ok = CheckChanged(old_catnum, refreshed, changed)
+            && Compare(refreshed, loaded, max_error > 0 ? 1E-3 : 0);
+    printf("max error %g km: %zu -> %zu satellites, %zu changed indices\n",
+        max_error, old_catnum.size(), refreshed.GetNumber(), changed.size());
+    printf("  Refresh %8.3f ms, Init %8.3f ms  %s\n", refresh_time, init_time,
+        ok ? "ok" : "FAILED");
+
+    // Unchanged text: nothing to initialize or report
+    refreshed.Refresh(update.data(), update.size(), changed);
+    bool same = changed.empty() && Compare(refreshed, loaded,
+        max_error > 0 ? 1E-3 : 0);
+    printf("  same text again %s\n", same ? "ok" : "FAILED");
+
+    // Everything removed and added again
+    refreshed.Refresh("", 0, changed);
+    bool empty = refreshed.GetNumber() == 0 && changed.empty();
+    refreshed.Refresh(reference.data(), reference.size(), changed);
+    empty = empty && changed.empty() && Compare(refreshed, loaded,
+        max_error > 0 ? 1E-3 : 0);
+    printf("  empty and back %s\n", empty ? "ok" : "FAILED");
+
+    // All but the first satellite removed: each removal moves the last
+    // satellite into index 1, the last one moved there is removed as the
+    // last satellite and index 1 is not in the catalog anymore
+    string first = SplitSets(reference)[0];
+    refreshed.Refresh(first.data(), first.size(), changed);
+    bool shrunk = refreshed.GetNumber() == 1 && changed.empty();
+    printf("  all but one removed %s\n", shrunk ? "ok" : "FAILED");
+    return ok && same && empty && shrunk;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 25000;
+    bool ok = CheckRefresh(number, 0)
+            && CheckRefresh(number, EphemerisCache::DEFAULT_MAX_ERROR);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Catalog.h"
+#include "SatelliteCalc.h"
+
+using namespace std;
+
+/*
+ * Propagates resonant deep-space satellites to times out of order with
+ * one SatelliteCalc each, which resumes the resonance integrator from its
+ * checkpoints, and to every time with a freshly constructed SatelliteCalc,
+ * which integrates from epoch. The jumps go forwards and backwards, across
+ * the checkpoint and step boundaries and to both sides of epoch. Returns
+ * non-zero if a position or velocity is not bitwise the same.
+ */
+
+// Satellites per resonant regime
+const size_t SATELLITES = 3;
+
+// Integrator step and checkpoint distance in minutes, see
+// DeepSpacePropagator
+const double STEP = 720;
+const double CHECKPOINT = 8 * STEP;
+
+// Jumps to the boundaries, then random times up to a month from epoch
+static vector<double> MakeTimes(size_t number) {
+    vector<double> times = {
+        0, 100, CHECKPOINT + 240, CHECKPOINT - 1, CHECKPOINT + 1, 40000,
+        2 * CHECKPOINT - 0.1, 2 * CHECKPOINT + 0.1, STEP - 0.1, STEP + 0.1,
+        300, -300, -CHECKPOINT - 1, -CHECKPOINT + 1, -30000,
+        -2 * CHECKPOINT - 0.5, 25000, -1, 1, -STEP - 0.1, 3 * CHECKPOINT,
+        3 * CHECKPOINT - 0.01, 60000, 4 * CHECKPOINT, -4 * CHECKPOINT,
+        -4 * CHECKPOINT + STEP};
+    mt19937 gen(3);
+    uniform_real_distribution<double> month(-43200, 43200);
+    while (times.size() < number) {
+        times.push_back(month(gen));
+    }
+    return times;
+}
+
+static bool Same(const vector_t &a, const vector_t &b) {
+    return memcmp(&a.x, &b.x, 3 * sizeof(double)) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 226;
+    vector<double> times = MakeTimes(number);
+
+    // The first resonant satellites of the synthetic catalog
+    vector<Satellite> sats;
+    size_t found[MAX_REGIMES] = {};
+    StringReader reader(MakeCatalog(2000));
+    while (!reader.eof()) {
+        string name = reader.getline();
+        string line1 = reader.getline();
+        string line2 = reader.getline();
+        if (reader.eof()) {
+            break;
+        }
+        Satellite sat(name, line1, line2);
+        REGIMES regime = SatelliteCalc(sat).GetRegime();
+        if ((regime == DEEP_SPACE_SYNCHRONOUS || regime == DEEP_SPACE_HALF_DAY)
+                && found[regime] < SATELLITES) {
+            ++found[regime];
+            sats.push_back(sat);
+        }
+    }
+
+    bool ok = found[DEEP_SPACE_SYNCHRONOUS] == SATELLITES
+            && found[DEEP_SPACE_HALF_DAY] == SATELLITES;
+    for (const Satellite &sat : sats) {
+        SatelliteCalc resumed(sat);
+        size_t different = 0;
+        for (double tsince : times) {
+            vector_t pos, vel, fresh_pos, fresh_vel;
+            resumed.Propagate(tsince, pos, vel);
+            SatelliteCalc fresh(sat);
+            fresh.Propagate(tsince, fresh_pos, fresh_vel);
+            if (!Same(pos, fresh_pos) || !Same(vel, fresh_vel)) {
+                ++different;
+            }
+        }
+        printf("%-16s %-24s %zu of %zu times different  %s\n",
+            sat.GetName().c_str(),
+            resumed.GetRegime() == DEEP_SPACE_HALF_DAY ? "12 hour resonance"
+                : "24 hour resonance", different, times.size(),
+            different == 0 ? "ok" : "FAILED");
+        ok = ok && different == 0;
+    }
+    return ok ? 0 : 1;
+}
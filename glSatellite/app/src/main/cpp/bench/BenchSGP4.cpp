@@ -0,0 +1,232 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Catalog.h"
+#include "SatelliteBatch.h"
+#include "SatelliteConst.h"
+#include "SatelliteMgr.h"
+
+using namespace std;
+
+/*
+ * Verification and speed of the propagation hot path off-device:
+ *  - the test cases of Spacetrack Report #3 and the SGP4 verification
+ *    ephemeris of satellite 00005 from Vallado et al., "Revisiting
+ *    Spacetrack Report #3" (tcppver.out), maximum position and velocity
+ *    errors against the published states,
+ *  - propagations per second for SGP4 (scalar and batch) and SDP4,
+ *  - parse and initialization throughput of SatelliteMgr::Init.
+ * Returns non-zero if a verification error exceeds its bound.
+ *
+ * Both references use XKMPER = 6378.135 km, this code the WGS 84 radius,
+ * the results are scaled to the reference radius before comparing.
+ */
+
+// Earth radius of the references in km
+const double REFERENCE_XKMPER = 6378.135;
+
+struct State {
+    // Minutes from epoch
+    double tsince;
+    // Published position in km and velocity in km/s
+    double pos[3];
+    double vel[3];
+};
+
+struct Verification {
+    const char *name;
+    const char *line1;
+    const char *line2;
+    const State *states;
+    size_t number;
+    // Bounds of the position error in km and of the velocity error in
+    // km/s, no velocities are published if 0
+    double max_pos_error;
+    double max_vel_error;
+};
+
+// Spacetrack Report #3, positions only, printed to single precision
+static const State STR3_SGP4[] = {
+    {0, {2328.97048951, -5995.22076416, 1719.97067261}},
+    {360, {2456.10705566, -6071.93853760, 1222.89727783}},
+    {720, {2567.56195068, -6112.50384522, 713.96397400}},
+    {1080, {2663.09078980, -6115.48229980, 196.39640427}},
+    {1440, {2742.55133057, -6079.67144775, -326.38095856}}};
+
+static const State STR3_SDP4[] = {
+    {0, {7473.37066650, 428.95261765, 5828.74786377}},
+    {360, {-3305.22537232, 32410.86328125, -24697.17675781}},
+    {720, {14271.28759766, 24110.46411133, -4725.76837158}},
+    {1080, {-9990.05883789, 22717.35522461, -23616.89062501}},
+    {1440, {9787.86975097, 33753.34667969, -15030.81176758}}};
+
+// tcppver.out, satellite 00005 over its whole published range
+static const State VER_00005[] = {
+    {0, {7022.46529266, -1400.08296755, 0.03995155},
+        {1.893841015, 6.405893759, 4.534807250}},
+    {360, {-7154.03120202, -3783.17682504, -3536.19412294},
+        {4.741887409, -4.151817765, -2.093935425}},
+    {720, {-7134.59340119, 6531.68641334, 3260.27186483},
+        {-4.113793027, -2.911922039, -2.557327851}},
+    {1080, {5568.53901181, 4492.06992591, 3863.87641983},
+        {-4.209106476, 5.159719888, 2.744852980}},
+    {1440, {-938.55923943, -6268.18748831, -4294.02924751},
+        {7.536105209, -0.427127707, 0.989878080}},
+    {1800, {-9680.56121728, 2802.47771354, 124.10688038},
+        {-0.905874102, -4.659467970, -3.227347517}},
+    {2160, {190.19796988, 7746.96653614, 5110.00675412},
+        {-6.112325142, 1.527008184, -0.139152358}},
+    {2520, {5579.55640116, -3995.61396789, -1518.82108966},
+        {4.767927483, 5.123185301, 4.276837355}},
+    {2880, {-8650.73082219, -1914.93811525, -3007.03603443},
+        {3.067165127, -4.828384068, -2.515322836}},
+    {3240, {-5429.79204164, 7574.36493792, 3747.39305236},
+        {-4.999442110, -1.800561422, -2.229392830}},
+    {3600, {6759.04583722, 2001.58198220, 2783.55192533},
+        {-2.180993947, 6.402085603, 3.644723952}},
+    {3960, {-3791.44531559, -5712.95617894, -4533.48630714},
+        {6.668817493, -2.516382327, -0.082384354}},
+    {4320, {-9060.47373569, 4658.70952502, 813.68673153},
+        {-2.232832783, -4.110453490, -3.157345433}}};
+
+#define STATES(states) states, sizeof(states) / sizeof(states[0])
+
+/*
+ * The bounds are the rounding of the references plus the few metres by
+ * which this Spacetrack Report #3 implementation differs from the revised
+ * code of the verification ephemeris.
+ */
+static const Verification VERIFICATION[] = {
+    {"SGP4",
+        "1 88888U          80275.98708465  .00073094  13844-3  66816-4 0     8",
+        "2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518   105",
+        STATES(STR3_SGP4), 0.015, 0},
+    {"SDP4",
+        "1 11801U          80230.29629788  .01431103  00000-0  14311-1 0     8",
+        "2 11801  46.7916 230.4354 7318036  47.4722  10.4117  2.28537848     6",
+        STATES(STR3_SDP4), 0.015, 0},
+    {"00005",
+        "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+        "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667",
+        STATES(VER_00005), 0.01, 1E-5}};
+
+static double Distance(const double *a, const double *b) {
+    double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/* Checks one test case, returns false if it exceeds the bounds. */
+static bool Verify(const Verification &test) {
+    SatelliteCalc calc(Satellite(test.name, test.line1, test.line2));
+    double pos_error = 0, vel_error = 0;
+    for (size_t k = 0; k < test.number; ++k) {
+        const State &ref = test.states[k];
+        vector_t pos, vel;
+        calc.Propagate(ref.tsince, pos, vel);
+        // Earth radii to km, and earth radii per minute to km/s
+        double p[3] = {pos.x * REFERENCE_XKMPER, pos.y * REFERENCE_XKMPER,
+            pos.z * REFERENCE_XKMPER};
+        double v[3] = {vel.x * REFERENCE_XKMPER / 60,
+            vel.y * REFERENCE_XKMPER / 60, vel.z * REFERENCE_XKMPER / 60};
+        pos_error = max(pos_error, Distance(p, ref.pos));
+        if (test.max_vel_error > 0) {
+            vel_error = max(vel_error, Distance(v, ref.vel));
+        }
+    }
+    bool ok = pos_error <= test.max_pos_error
+            && vel_error <= test.max_vel_error;
+    printf("%-5s %s: max error %.6f km, %.9f km/s over %g min %s\n",
+        test.name, calc.IsDeepSpace() ? "(deep space)" : "(near earth)",
+        pos_error, vel_error, test.states[test.number - 1].tsince,
+        ok ? "ok" : "FAILED");
+    return ok;
+}
+
+template<class F>
+static double Seconds(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/* Propagations per second of the scalar path over the time steps. */
+static double Rate(vector<SatelliteCalc> &calc, int steps) {
+    double sum = 0;
+    double time = Seconds([&] {
+        for (int k = 0; k < steps; ++k) {
+            for (SatelliteCalc &sat : calc) {
+                vector_t pos, vel;
+                sat.Propagate(k, pos, vel);
+                sum += pos.x;
+            }
+        }
+    });
+    // Keep the results alive
+    if (sum == 0.5) {
+        printf(" ");
+    }
+    return steps * calc.size() / time;
+}
+
+/* Propagations per second of SGP4Batch over the time steps. */
+static double BatchRate(vector<SatelliteCalc> &calc, int steps) {
+    SGP4Batch batch[] = {SGP4Batch(NEAR_EARTH), SGP4Batch(NEAR_EARTH_SIMPLE)};
+    for (size_t i = 0; i < calc.size(); ++i) {
+        batch[calc[i].GetRegime()].Add(i, calc[i]);
+    }
+    double daynum = CurrentDaynum();
+    double time = Seconds([&] {
+        for (int k = 0; k < steps; ++k) {
+            PropagationContext context(daynum + k / MINDAY);
+            for (SGP4Batch &regime : batch) {
+                regime.Propagate(context);
+            }
+        }
+    });
+    return steps * calc.size() / time;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+    int steps = argc > 2 ? atoi(argv[2]) : 20;
+
+    int result = 0;
+    for (const Verification &test : VERIFICATION) {
+        if (!Verify(test)) {
+            result = 1;
+        }
+    }
+
+    string text = MakeCatalog(number);
+    vector<SatelliteCalc> near_earth, deep_space;
+    StringReader reader(text);
+    while (!reader.eof()) {
+        string name = reader.getline();
+        string line1 = reader.getline();
+        string line2 = reader.getline();
+        if (!reader.eof()) {
+            SatelliteCalc calc(Satellite(name, line1, line2));
+            (calc.IsDeepSpace() ? deep_space : near_earth).push_back(calc);
+        }
+    }
+
+    printf("%zu SGP4, %zu SDP4 satellites, %d steps\n", near_earth.size(),
+        deep_space.size(), steps);
+    printf("SGP4        %.3g propagations/s\n", Rate(near_earth, steps));
+    printf("SGP4 batch  %.3g propagations/s\n", BatchRate(near_earth, steps));
+    printf("SDP4        %.3g propagations/s\n", Rate(deep_space, steps));
+
+    // Parsing and propagator setup, without the ephemeris cache
+    SatelliteMgr mgr;
+    mgr.SetMaxError(0);
+    StringReader init_reader(text);
+    double time = Seconds([&] {
+        mgr.Init(init_reader);
+    });
+    printf("Init        %.3g TLE/s, %.1f MB/s\n", mgr.GetNumber() / time,
+        text.size() / time * 1E-6);
+    return result;
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "Catalog.h"
+#include "SatelliteConst.h"
+#include "SatelliteMgr.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/*
+ * Speed of SatelliteMgr::UpdateAll with SGP4/SDP4 on every update, the
+ * ephemeris cache is off, on the calling thread and on pools of 1 to the
+ * maximum number of threads. Every pool must publish bitwise the same
+ * snapshot as the calling thread. Returns non-zero on any difference.
+ */
+
+/* Snapshot of an update at the daynum. */
+static PositionSnapshot Update(SatelliteMgr &mgr, double daynum) {
+    mgr.UpdateAll(PropagationContext(daynum));
+    return mgr.AcquireSnapshot();
+}
+
+static bool Same(const PositionSnapshot &a, const PositionSnapshot &b) {
+    return a.daynum == b.daynum && a.min_alt == b.min_alt
+            && a.max_alt == b.max_alt && a.position.size() == b.position.size()
+            && memcmp(a.position.data(), b.position.data(),
+                a.position.size() * sizeof(SatellitePosition)) == 0;
+}
+
+/* Average time of one update in milliseconds, one minute apart. */
+static double TimeUpdate(SatelliteMgr &mgr, double daynum, int iterations) {
+    // Warm up caches and the pool's threads
+    mgr.UpdateAll(PropagationContext(daynum));
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        mgr.UpdateAll(PropagationContext(daynum + (i + 1) / MINDAY));
+    }
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char *argv[]) {
+    size_t number = argc > 1 ? strtoul(argv[1], nullptr, 10) : 50000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    size_t cores = argc > 3 ? strtoul(argv[3], nullptr, 10)
+            : max(1u, thread::hardware_concurrency());
+
+    SatelliteMgr mgr;
+    // SGP4/SDP4 on every update instead of the ephemeris cache
+    mgr.SetMaxError(0);
+    StringReader reader(MakeCatalog(number));
+    mgr.Init(reader);
+    printf("%zu satellites, %d iterations, up to %zu threads\n", mgr.GetNumber(),
+        iterations, cores);
+
+    double daynum = CurrentDaynum();
+    // Half a day later, the deep-space integrators run a step
+    double check = daynum + 0.5;
+    double serial = TimeUpdate(mgr, daynum, iterations);
+    PositionSnapshot expected = Update(mgr, check);
+    printf("%-12s %9.3f ms\n", "no pool", serial);
+
+    bool ok = true;
+    for (size_t threads = 1; threads <= cores; ++threads) {
+        ThreadPool pool(threads);
+        mgr.SetThreadPool(&pool);
+        double time = TimeUpdate(mgr, daynum, iterations);
+        bool same = Same(Update(mgr, check), expected);
+        mgr.SetThreadPool(nullptr);
+        printf("%2zu %-9s %9.3f ms  %5.2fx  %s\n", threads,
+            threads == 1 ? "thread" : "threads", time, serial / time,
+            same ? "same" : "DIFFERENT");
+        ok = ok && same;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "UiBridge.h"
+
+using namespace std;
+
+/*
+ * Drives UiBridge like the render loop with a backend without a JVM that
+ * records its calls: every call must come from the one bridge thread
+ * between Attach() and Detach(), the latest values must arrive, in the
+ * order that keeps an error label over the FPS, frames without changes
+ * must not wake the bridge thread, and a backend that cannot attach
+ * must get no calls but Detach(), which releases what Attach() got
+ * before it failed. Returns non-zero on any difference, and reports
+ * the cost of the updates and Flush() on the render thread.
+ */
+
+const size_t FRAMES = 100000;
+
+template<class F>
+static double Time(F func) {
+    auto start = chrono::steady_clock::now();
+    func();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now()
+            - start;
+    return elapsed.count();
+}
+
+/* Calls of a backend, kept after the bridge destroyed it. */
+class CallLog {
+    mutex mutex_;
+    thread::id bridge_;
+    bool attached_ = false;
+    bool same_thread_ = true;
+    vector<string> calls_;
+public:
+    void Attach(bool attached) {
+        lock_guard<mutex> lock(mutex_);
+        bridge_ = this_thread::get_id();
+        attached_ = attached;
+        calls_.push_back("attach");
+    }
+
+    void Detach() {
+        Record("detach");
+        lock_guard<mutex> lock(mutex_);
+        attached_ = false;
+    }
+
+    void Record(const string &call) {
+        lock_guard<mutex> lock(mutex_);
+        same_thread_ = same_thread_ && attached_
+                && this_thread::get_id() == bridge_;
+        calls_.push_back(call);
+    }
+
+    // Calls so far, and whether all came from the attached bridge thread
+    vector<string> GetCalls(bool &same_thread) {
+        lock_guard<mutex> lock(mutex_);
+        same_thread = same_thread_ && bridge_ != this_thread::get_id();
+        return calls_;
+    }
+};
+
+// Backend without a JVM
+class RecordingBackend: public IUiBackend {
+    CallLog *log_;
+    bool attach_;
+public:
+    explicit RecordingBackend(CallLog *log, bool attach = true) :
+            log_(log),
+            attach_(attach) {
+    }
+
+    bool Attach() override {
+        log_->Attach(attach_);
+        return attach_;
+    }
+
+    void Detach() override {
+        log_->Detach();
+    }
+
+    void ShowUI() override {
+        log_->Record("ui");
+    }
+
+    void UpdateFPS(float fps) override {
+        log_->Record("fps " + to_string((int)fps));
+    }
+
+    void UpdateLabel(const char *label) override {
+        log_->Record(string("label ") + label);
+    }
+
+    void ShowBeam(const char *name, int catnum, float latitude,
+        float longitude, float altitude) override {
+        log_->Record(string("beam ") + name + " " + to_string(catnum));
+    }
+};
+
+/* The calls of one frame with every kind of update. */
+static bool CheckOrder() {
+    CallLog log;
+    {
+        UiBridge bridge(unique_ptr<IUiBackend>(new RecordingBackend(&log)));
+        bridge.UpdateLabel("Failed to compile shader");
+        bridge.ShowBeam("ISS (ZARYA)", 25544, 51.f, 10.f, 420.f);
+        bridge.UpdateFPS(30);
+        bridge.ShowUI();
+        bridge.UpdateFPS(60);
+        bridge.Flush();
+        // Nothing changed
+        bridge.Flush();
+    }
+    bool same_thread;
+    vector<string> calls = log.GetCalls(same_thread);
+    vector<string> expected = {"attach", "ui", "fps 60",
+        "label Failed to compile shader", "beam ISS (ZARYA) 25544", "detach"};
+    bool ok = calls == expected && same_thread;
+    printf("order %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* Frames of the render loop, the FPS changes every 60th frame. */
+static bool CheckFrames() {
+    CallLog log;
+    double time;
+    {
+        UiBridge bridge(unique_ptr<IUiBackend>(new RecordingBackend(&log)));
+        time = Time([&] {
+            for (size_t frame = 0; frame < FRAMES; ++frame) {
+                if (frame % 60 == 0) {
+                    bridge.UpdateFPS(frame / 60 % 100);
+                }
+                bridge.Flush();
+            }
+        });
+    }
+    bool same_thread;
+    vector<string> calls = log.GetCalls(same_thread);
+    // One call per batch between attach and detach
+    size_t updates = (FRAMES + 59) / 60;
+    size_t batches = calls.size() - 2;
+    string last = "fps " + to_string((updates - 1) % 100);
+    bool ok = same_thread && calls.size() >= 3 && batches <= updates
+            && calls[calls.size() - 2] == last;
+    printf("%zu frames, %zu FPS updates in %zu batches, %.1f ns per frame  "
+        "%s\n", FRAMES, updates, batches, time * 1E6 / FRAMES,
+        ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* No calls but Detach() if the backend cannot attach. */
+static bool CheckDetached() {
+    CallLog log;
+    {
+        UiBridge bridge(unique_ptr<IUiBackend>(
+            new RecordingBackend(&log, false)));
+        bridge.ShowUI();
+        bridge.UpdateLabel("error");
+        bridge.Flush();
+    }
+    bool same_thread;
+    vector<string> calls = log.GetCalls(same_thread);
+    bool ok = calls == vector<string>{"attach", "detach"};
+    printf("no VM %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main() {
+    bool ok = CheckOrder();
+    ok = CheckFrames() && ok;
+    ok = CheckDetached() && ok;
+    return ok ? 0 : 1;
+}
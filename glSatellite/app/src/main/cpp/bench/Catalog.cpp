@@ -0,0 +1,80 @@
+#include <cctype>
+#include <cstdio>
+#include <ctime>
+#include <random>
+
+#include "Catalog.h"
+
+using namespace std;
+
+/* Append the modulo 10 checksum of the first 68 columns. */
+static void AddChecksum(char *line) {
+    unsigned sum = 0;
+    for (int i = 0; i < 68; ++i) {
+        if (isdigit(line[i])) {
+            sum += line[i] - '0';
+        } else if (line[i] == '-') {
+            ++sum;
+        }
+    }
+    line[68] = '0' + sum % 10;
+    line[69] = '\0';
+}
+
+string MakeCatalog(size_t number, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_real_distribution<double> angle(0.0, 360.0);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    time_t now = time(nullptr);
+    struct tm utc;
+    gmtime_r(&now, &utc);
+    double doy = utc.tm_yday + 1
+            + (utc.tm_hour * 3600 + utc.tm_min * 60 + utc.tm_sec) / 86400.0;
+
+    string text;
+    text.reserve(number * 160);
+    for (size_t i = 0; i < number; ++i) {
+        double incl, eccn, meanmo;
+        double type = unit(gen);
+        if (type < 0.85) {
+            // LEO
+            incl = 30.0 + 70.0 * unit(gen);
+            eccn = 0.02 * unit(gen);
+            meanmo = 13.0 + 2.5 * unit(gen);
+        } else if (type < 0.92) {
+            // GPS, GLONASS, Galileo like
+            incl = 55.0 + 10.0 * unit(gen);
+            eccn = 0.01 * unit(gen);
+            meanmo = 1.7 + 0.4 * unit(gen);
+        } else if (type < 0.98) {
+            // Geostationary, SDP4 is singular at zero inclination
+            incl = 0.01 + 5.0 * unit(gen);
+            eccn = 0.001 * unit(gen);
+            meanmo = 1.0027;
+        } else {
+            // Molniya
+            incl = 63.4;
+            eccn = 0.7 + 0.05 * unit(gen);
+            meanmo = 2.0056;
+        }
+
+        int catnum = i % 100000;
+        char name[32], line1[80], line2[80];
+        snprintf(name, sizeof(name), "SYNTHETIC %zu", i);
+        snprintf(line1, sizeof(line1),
+            "1 %05dU 20001A   %02d%012.8f  .00000100  00000-0  10000-4 0  999",
+            catnum, utc.tm_year % 100, doy);
+        snprintf(line2, sizeof(line2),
+            "2 %05d %8.4f %8.4f %07d %8.4f %8.4f %11.8f%5d", catnum, incl,
+            angle(gen), (int)(eccn * 1E7), angle(gen), angle(gen), meanmo,
+            1000);
+        AddChecksum(line1);
+        AddChecksum(line2);
+
+        text.append(name).append("\n");
+        text.append(line1).append("\n");
+        text.append(line2).append("\n");
+    }
+    return text;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "IFileReader.h"
+
+// Reads TLE text from memory, like AppFileReader does for assets
+class StringReader: public IFileReader {
+    std::string text_;
+public:
+    explicit StringReader(std::string text) :
+            text_(std::move(text)) {
+    }
+
+    bool is_open() override {
+        return true;
+    }
+
+    StringView view() override {
+        return StringView(text_);
+    }
+};
+
+/*
+ * Synthetic catalog of valid TLEs with the epoch at the current time.
+ * The mix of orbits roughly follows the public catalog: mostly LEO,
+ * the rest MEO navigation, GEO and Molniya orbits which use SDP4.
+ */
+std::string MakeCatalog(size_t number, unsigned seed = 1);
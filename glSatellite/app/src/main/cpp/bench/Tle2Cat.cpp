@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "SatelliteMgr.h"
+
+using namespace std;
+
+/*
+ * Converts a TLE or OMM text file, plain or gzip compressed, to the binary
+ * catalog file of CatalogFile.
+ * Like SatelliteMgr::Init(), it leaves out invalid element sets and the
+ * satellites already decayed. The file is only valid for a build of the
+ * same version and architecture as this tool.
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s input.txt output.cat\n", argv[0]);
+        return 2;
+    }
+
+    ifstream input(argv[1], ios::binary);
+    if (!input) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    stringstream text;
+    text << input.rdbuf();
+    string data = text.str();
+
+    SatelliteMgr mgr;
+    mgr.SetMaxError(0);
+    mgr.Init(data.data(), data.size());
+    if (!mgr.Save(argv[2])) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 1;
+    }
+    printf("%zu satellites written to %s\n", mgr.GetNumber(), argv[2]);
+    return 0;
+}
@@ -149,6 +149,14 @@ class JNIHelper {
    */
   bool ReadFile(const char* file_name, std::vector<uint8_t>* buffer_ref);
 
+  /*
+   * Retrieves the activity the helper was initialized with, for direct
+   * access to its asset manager and data paths
+   *
+   * return: pointer to the activity, nullptr before Init()
+   */
+  ANativeActivity* GetActivity() const { return activity_; }
+
   /*
    * Load and create OpenGL texture from given file name.
    * The method invokes BitmapFactory in Java so it can read jpeg/png formatted
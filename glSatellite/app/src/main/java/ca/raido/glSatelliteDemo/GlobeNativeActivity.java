@@ -160,6 +160,9 @@ public class GlobeNativeActivity extends NativeActivity {
             case R.id.settings:
                 runSettings(null);
                 break;
+            case R.id.dump_profile:
+                dumpProfile();
+                break;
             default:
                 // pass
         }
@@ -172,6 +175,9 @@ public class GlobeNativeActivity extends NativeActivity {
 
     native void useTle(String path);
 
+    // Logs the timing of the frame stages
+    native void dumpProfile();
+
     private int getStatusBarHeight() {
         int result = 0;
         final int resourceId = getResources().getIdentifier("status_bar_height",